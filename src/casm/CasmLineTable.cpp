@@ -0,0 +1,128 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a debug line table for CASM (binary) algorithm files.
+
+#include "casm/CasmLineTable.h"
+
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+#include "sexp/Ast.h"
+
+namespace wasm {
+
+using namespace filt;
+
+namespace decode {
+
+namespace {
+
+constexpr charstring Magic = "casm-lines 1";
+
+// Collects the nodes of the algorithm in Symtab, in preorder. Shared nodes
+// are only collected the first time they are visited.
+void collectNodes(const SymbolTable& Symtab, std::vector<Node*>& Nodes) {
+  const Node* Root = Symtab.getAlgorithm();
+  if (Root == nullptr)
+    return;
+  std::unordered_set<const Node*> Visited;
+  std::vector<Node*> Stack;
+  Stack.push_back(const_cast<Node*>(Root));
+  while (!Stack.empty()) {
+    Node* Nd = Stack.back();
+    Stack.pop_back();
+    if (Nd == nullptr || Visited.count(Nd))
+      continue;
+    Visited.insert(Nd);
+    Nodes.push_back(Nd);
+    for (int i = Nd->getNumKids(); i > 0; --i)
+      Stack.push_back(Nd->getKid(i - 1));
+  }
+}
+
+bool readLine(FILE* In, std::string& Line) {
+  Line.clear();
+  int Ch;
+  while ((Ch = fgetc(In)) != EOF && Ch != '\n')
+    Line.push_back(char(Ch));
+  return Ch != EOF || !Line.empty();
+}
+
+}  // end of anonymous namespace
+
+std::string CasmLineTable::getFilenameFor(charstring Filename) {
+  return std::string(Filename) + ".lines";
+}
+
+bool CasmLineTable::write(const SymbolTable& Symtab, charstring Filename) {
+  std::vector<Node*> Nodes;
+  collectNodes(Symtab, Nodes);
+  FILE* Out = fopen(Filename, "w");
+  if (Out == nullptr)
+    return false;
+  fprintf(Out, "%s\nsource %s\nnodes %" PRIuMAX "\n", Magic,
+          Symtab.getSourceFilename().c_str(), uintmax_t(Nodes.size()));
+  for (const Node* Nd : Nodes)
+    fprintf(Out, "%" PRIu32 " %s\n", Nd->getSourceLine(), Nd->getNodeName());
+  bool Success = !ferror(Out);
+  if (fclose(Out) != 0)
+    Success = false;
+  return Success;
+}
+
+bool CasmLineTable::read(SymbolTable& Symtab, charstring Filename) {
+  FILE* In = fopen(Filename, "r");
+  if (In == nullptr)
+    return false;
+  std::vector<Node*> Nodes;
+  collectNodes(Symtab, Nodes);
+  std::vector<uint32_t> Lines;
+  Lines.reserve(Nodes.size());
+  std::string Line;
+  std::string Source;
+  bool Success = readLine(In, Line) && Line == Magic && readLine(In, Line) &&
+                 Line.compare(0, 7, "source ") == 0;
+  if (Success) {
+    Source = Line.substr(7);
+    uintmax_t NumNodes = 0;
+    Success = readLine(In, Line) &&
+              sscanf(Line.c_str(), "nodes %" SCNuMAX, &NumNodes) == 1 &&
+              NumNodes == Nodes.size();
+  }
+  for (size_t i = 0; Success && i < Nodes.size(); ++i) {
+    char* NameStart = nullptr;
+    Success = readLine(In, Line);
+    if (!Success)
+      break;
+    unsigned long Value = strtoul(Line.c_str(), &NameStart, 10);
+    Success = NameStart != nullptr && *NameStart == ' ' &&
+              strcmp(NameStart + 1, Nodes[i]->getNodeName()) == 0;
+    Lines.push_back(uint32_t(Value));
+  }
+  fclose(In);
+  if (!Success)
+    return false;
+  Symtab.setSourceFilename(Source);
+  for (size_t i = 0; i < Nodes.size(); ++i)
+    Nodes[i]->setSourceLine(Lines[i]);
+  return true;
+}
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
@@ -0,0 +1,65 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Declares a debug line table for CASM (binary) algorithm files.
+//
+// A CASM file does not contain source locations. Rather, the line table is
+// written next to it (as FILE.lines), and holds the source line of each node
+// of the algorithm, in the (preorder) order the nodes are visited. Since a
+// CASM file preserves the structure of the algorithm, the reader visits the
+// nodes of the inflated algorithm in the same order. The node type of each
+// entry is also recorded, so that stale tables are rejected rather than
+// misattributing lines.
+
+#ifndef DECOMPRESSOR_SRC_CASM_CASMLINETABLE_H_
+#define DECOMPRESSOR_SRC_CASM_CASMLINETABLE_H_
+
+#include "utils/Defs.h"
+
+#include <string>
+
+namespace wasm {
+
+namespace filt {
+class SymbolTable;
+}  // end of namespace filt
+
+namespace decode {
+
+class CasmLineTable {
+  CasmLineTable() = delete;
+  CasmLineTable(const CasmLineTable&) = delete;
+  CasmLineTable& operator=(const CasmLineTable&) = delete;
+
+ public:
+  // Returns the name of the line table for CASM file Filename.
+  static std::string getFilenameFor(charstring Filename);
+
+  // Writes the source lines of the algorithm in Symtab to Filename.
+  // Returns true if successful.
+  static bool write(const filt::SymbolTable& Symtab, charstring Filename);
+
+  // Reads the line table in Filename, and assigns the source lines to the
+  // algorithm in Symtab. Returns false (leaving Symtab unchanged) if unable
+  // to read Filename, or the table doesn't match the algorithm.
+  static bool read(filt::SymbolTable& Symtab, charstring Filename);
+};
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_CASM_CASMLINETABLE_H_
@@ -18,6 +18,9 @@
 
 #include "casm/CasmReader.h"
 
+#include <unistd.h>
+
+#include "casm/CasmLineTable.h"
 #include "casm/InflateAst.h"
 #include "interp/ByteReader.h"
 #include "interp/Interpreter.h"
@@ -40,6 +43,7 @@ CasmReader::CasmReader()
       TraceRead(false),
       TraceTree(false),
       TraceLexer(false),
+      KeepSourceLines(false),
       ErrorsFound(false) {}
 
 CasmReader::~CasmReader() {}
@@ -62,6 +66,7 @@ void CasmReader::readText(charstring Filename,
     Parser.setTraceParsing(true);
   if (TraceLexer)
     Parser.setTraceLexing(true);
+  Parser.setKeepSourceLines(KeepSourceLines);
   if (!Parser.parse(Filename)) {
     foundErrors();
     return;
@@ -160,8 +165,17 @@ void CasmReader::readTextOrBinary(charstring Filename,
         std::make_shared<FileReader>(Filename));
     // Mark the beginning of the stream, so that it doesn't loose the page.
     ReadCursor Hold(Binary);
-    if (hasBinaryHeader(Binary, AlgSymtab))
-      return readBinary(Binary, AlgSymtab, EnclosingScope);
+    if (hasBinaryHeader(Binary, AlgSymtab)) {
+      readBinary(Binary, AlgSymtab, EnclosingScope);
+      if (KeepSourceLines && Symtab) {
+        std::string LinesFilename = CasmLineTable::getFilenameFor(Filename);
+        if (access(LinesFilename.c_str(), R_OK) == 0 &&
+            !CasmLineTable::read(*Symtab, LinesFilename.c_str()))
+          fprintf(stderr, "Ignoring line table that doesn't match: %s\n",
+                  LinesFilename.c_str());
+      }
+      return;
+    }
   }
   if (std::string(Filename) == "-")
     // Can't reread from stdin, so fail!
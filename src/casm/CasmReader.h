@@ -106,6 +106,13 @@ class CasmReader {
     TraceLexer = Value;
     return *this;
   }
+  // When true, nodes record their source line. For binary files, the lines
+  // come from the (optional) line table written next to the file (see
+  // CasmLineTable).
+  CasmReader& setKeepSourceLines(bool Value) {
+    KeepSourceLines = Value;
+    return *this;
+  }
   std::shared_ptr<filt::SymbolTable> getReadSymtab() { return Symtab; }
 
  private:
@@ -113,6 +120,7 @@ class CasmReader {
   bool TraceRead;
   bool TraceTree;
   bool TraceLexer;
+  bool KeepSourceLines;
   bool ErrorsFound;
   std::shared_ptr<filt::SymbolTable> Symtab;
   void foundErrors();
@@ -58,10 +58,9 @@ void CasmWriter::writeBinary(std::shared_ptr<SymbolTable> Symtab,
     ErrorsFound = true;
 }
 
-const BitWriteCursor& CasmWriter::writeBinary(
-    std::shared_ptr<SymbolTable> Symtab,
-    std::shared_ptr<Queue> Output,
-    std::shared_ptr<SymbolTable> AlgSymtab) {
+BitWriteCursor CasmWriter::writeBinary(std::shared_ptr<SymbolTable> Symtab,
+                                       std::shared_ptr<Queue> Output,
+                                       std::shared_ptr<SymbolTable> AlgSymtab) {
   std::shared_ptr<IntStream> IntSeq = std::make_shared<IntStream>();
   writeBinary(Symtab, IntSeq);
   auto StrmWriter = std::make_shared<ByteWriter>(Output);
@@ -19,6 +19,7 @@
 #ifndef DECOMPRESSOR_SRC_CASM_CASM_WRITER_H_
 #define DECOMPRESSOR_SRC_CASM_CASM_WRITER_H_
 
+#include "stream/BitWriteCursor.h"
 #include "utils/Defs.h"
 
 namespace wasm {
@@ -33,7 +34,6 @@ class SymbolTable;
 
 namespace decode {
 
-class BitWriteCursor;
 class Queue;
 
 class CasmWriter {
@@ -49,14 +49,13 @@ class CasmWriter {
 
   // Write aglorithm in Symtab to Output, using CASM algorithm in AlgSymtab.
   // Returns final write position.
-  const BitWriteCursor& writeBinary(
-      std::shared_ptr<filt::SymbolTable> Symtab,
-      std::shared_ptr<Queue> Output,
-      std::shared_ptr<filt::SymbolTable> AlgSymtab);
+  BitWriteCursor writeBinary(std::shared_ptr<filt::SymbolTable> Symtab,
+                             std::shared_ptr<Queue> Output,
+                             std::shared_ptr<filt::SymbolTable> AlgSymtab);
 
   // Same as above, but using default aglorithm casm0x0.
-  const BitWriteCursor& writeBinary(std::shared_ptr<filt::SymbolTable> Symtab,
-                                    std::shared_ptr<Queue> Output);
+  BitWriteCursor writeBinary(std::shared_ptr<filt::SymbolTable> Symtab,
+                             std::shared_ptr<Queue> Output);
 
   bool hasErrors() const { return ErrorsFound; }
 
@@ -28,7 +28,7 @@ using namespace utils;
 
 namespace decode {
 
-const BitWriteCursor& CasmWriter::writeBinary(
+BitWriteCursor CasmWriter::writeBinary(
     std::shared_ptr<filt::SymbolTable> Symtab,
     std::shared_ptr<Queue> Output) {
   return writeBinary(Symtab, Output, getAlgcasm0x0Symtab());
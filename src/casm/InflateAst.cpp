@@ -351,6 +351,10 @@ bool InflateAst::writeAction(IntType Action) {
       }
       Node* Nd = nullptr;
       switch (NodeType(Values.popValue())) {
+        case NodeType::BinaryAdaptive:
+          Nd = IsDefault ? Symtab->create<BinaryAdaptive>()
+                         : Symtab->create<BinaryAdaptive>(Value, Format);
+          break;
         case NodeType::I32Const:
           Nd = IsDefault ? Symtab->create<I32Const>()
                          : Symtab->create<I32Const>(Value, Format);
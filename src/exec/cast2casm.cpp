@@ -17,6 +17,7 @@
 // Converts textual algorithm into binary file form.
 
 #include "algorithms/casm0x0.h"
+#include "casm/CasmLineTable.h"
 #include "casm/CasmReader.h"
 #include "casm/CasmWriter.h"
 
@@ -735,39 +735,40 @@ void CodeGenerator::generateArrayImplFile() {
   generateAlgorithmHeader();
   puts(
       " {\n"
-      "  static std::shared_ptr<SymbolTable> Symtable;\n"
-      "  if (Symtable)\n"
-      "    return Symtable;\n"
-      "  auto ArrayInput = std::make_shared<ArrayReader>(\n"
-      "    ");
+      "  // Note: Static initialization is thread safe.\n"
+      "  static std::shared_ptr<SymbolTable> Symtable =\n"
+      "      []() -> std::shared_ptr<SymbolTable> {\n"
+      "    auto ArrayInput = std::make_shared<ArrayReader>(\n"
+      "      ");
   generateArrayName();
   puts(", size(");
   generateArrayName();
   puts(
       "));\n"
-      "  auto Input = std::make_shared<ReadBackedQueue>(ArrayInput);\n"
-      "  CasmReader Reader;\n");
+      "    auto Input = std::make_shared<ReadBackedQueue>(ArrayInput);\n"
+      "    CasmReader Reader;\n");
 #if WASM_CAST_BOOT == 2
   if (Bootstrap) {
-    puts("  std::shared_ptr<SymbolTable> BootSymtab = get");
+    puts("    std::shared_ptr<SymbolTable> BootSymtab = get");
     puts(BootstrapAlg);
     puts(
         "Symtab();\n"
-        "  Reader.readBinary(Input, BootSymtab, BootSymtab);\n");
+        "    Reader.readBinary(Input, BootSymtab, BootSymtab);\n");
   } else {
-    puts("  Reader.readBinary(Input);\n");
+    puts("    Reader.readBinary(Input);\n");
   };
 #else
-  puts("  Reader.readBinary(Input);\n");
+  puts("    Reader.readBinary(Input);\n");
 #endif
   puts(
-      "  if (Reader.hasErrors()) {\n"
-      "    fatal(\"Malformed builtin algorithm: ");
+      "    if (Reader.hasErrors()) {\n"
+      "      fatal(\"Malformed builtin algorithm: ");
   puts(AlgName);
   puts(
       "\");\n"
-      "  }\n"
-      "  Symtable = Reader.getReadSymtab();\n"
+      "    }\n"
+      "    return Reader.getReadSymtab();\n"
+      "  }();\n"
       "  return Symtable;\n");
   generateFunctionFooter();
 }
@@ -785,17 +786,19 @@ void CodeGenerator::generateFunctionImplFile() {
   generateAlgorithmHeader();
   puts(
       " {\n"
-      "  static std::shared_ptr<SymbolTable> Symtable;\n"
-      "  if (Symtable)\n"
-      "    return Symtable;\n"
-      "  Symtable = std::make_shared<SymbolTable>();\n"
-      "  SymbolTable* Symtab = Symtable.get();\n"
-      "  Symtab->setAlgorithm(");
+      "  // Note: Static initialization is thread safe.\n"
+      "  static std::shared_ptr<SymbolTable> Symtable =\n"
+      "      []() -> std::shared_ptr<SymbolTable> {\n"
+      "    auto Symtable = std::make_shared<SymbolTable>();\n"
+      "    SymbolTable* Symtab = Symtable.get();\n"
+      "    Symtab->setAlgorithm(");
   generateFunctionCall(Index);
   puts(
       ");\n"
-      "  Symtab->install();\n"
-      "  SymbolTable::registerAlgorithm(Symtable);\n"
+      "    Symtab->install();\n"
+      "    SymbolTable::registerAlgorithm(Symtable);\n"
+      "    return Symtable;\n"
+      "  }();\n"
       "  return Symtable;\n");
   generateFunctionFooter();
 }
@@ -844,6 +847,7 @@ std::shared_ptr<SymbolTable> readCasmFile(
     bool Verbose,
     bool TraceLexer,
     bool TraceParser,
+    bool KeepSourceLines,
     std::shared_ptr<SymbolTable> EnclosingScope) {
   TRACE_METHOD("readCasmFile");
   bool HasErrors = false;
@@ -854,6 +858,7 @@ std::shared_ptr<SymbolTable> readCasmFile(
   Parser.setTraceLexing(TraceLexer);
   Parser.setTraceParsing(TraceParser);
   Parser.setTraceFilesParsed(Verbose);
+  Parser.setKeepSourceLines(KeepSourceLines);
   HasErrors = !Parser.parse(Filename);
 #else
   CasmReader Reader;
@@ -861,6 +866,7 @@ std::shared_ptr<SymbolTable> readCasmFile(
     fprintf(stderr, "Reading: %s\n", Filename);
   Reader.setTraceRead(TraceParser)
       .setTraceLexer(TraceLexer)
+      .setKeepSourceLines(KeepSourceLines)
       .readTextOrBinary(Filename, EnclosingScope);
   HasErrors = Reader.hasErrors();
   if (!HasErrors)
@@ -915,6 +921,7 @@ int main(int Argc, charstring Argv[]) {
   bool Verbose = false;
   bool HeaderFile = false;
   bool TraceProgress = false;
+  bool WriteLineTable = false;
 
 #if WASM_CAST_BOOT > 1
   bool BitCompress = true;
@@ -1082,6 +1089,13 @@ int main(int Argc, charstring Argv[]) {
                  .setDescription("Minimize size in binary file "
                                  "(note: runs slower)"));
 
+    ArgsParser::Optional<bool> WriteLineTableFlag(WriteLineTable);
+    Args.add(WriteLineTableFlag.setLongName("line-table")
+                 .setDescription(
+                     "Also write the source line of each node to "
+                     "OUTPUT.lines, so that profiles of the binary algorithm "
+                     "can be annotated with source lines"));
+
     ArgsParser::Optional<bool> TraceFlattenFlag(TraceFlatten);
     Args.add(TraceFlattenFlag.setLongName("verbose=flatten")
                  .setDescription("Show how algorithms are flattened"));
@@ -1144,6 +1158,11 @@ int main(int Argc, charstring Argv[]) {
       fprintf(stderr, "Opition --array can't be used with option --header\n");
       return exit_status(EXIT_FAILURE);
     }
+
+    if (WriteLineTable && strcmp(OutputFilename, "-") == 0) {
+      fprintf(stderr, "Option --line-table can't be used without --output\n");
+      return exit_status(EXIT_FAILURE);
+    }
 #endif
   }
 
@@ -1156,8 +1175,8 @@ int main(int Argc, charstring Argv[]) {
   charstring InputFilename = "-";
   for (charstring Filename : InputFilenames) {
     InputFilename = Filename;
-    InputSymtab =
-        readCasmFile(Filename, Verbose, TraceLexer, TraceParser, InputSymtab);
+    InputSymtab = readCasmFile(Filename, Verbose, TraceLexer, TraceParser,
+                               WriteLineTable, InputSymtab);
     if (!InputSymtab || !InputSymtab->install()) {
       fprintf(stderr, "Unable to parse: %s\n", InputFilename);
       return exit_status(EXIT_FAILURE);
@@ -1225,8 +1244,8 @@ int main(int Argc, charstring Argv[]) {
     fprintf(stderr, "Reading algorithms...\n");
   std::shared_ptr<SymbolTable> AlgSymtab;
   for (charstring Filename : AlgorithmFilenames) {
-    AlgSymtab =
-        readCasmFile(Filename, Verbose, TraceLexer, TraceParser, AlgSymtab);
+    AlgSymtab = readCasmFile(Filename, Verbose, TraceLexer, TraceParser,
+                             false, AlgSymtab);
     if (!AlgSymtab || !AlgSymtab->install()) {
       fprintf(stderr, "Problems reading file: %s\n", Filename);
       return exit_status(EXIT_FAILURE);
@@ -1286,6 +1305,13 @@ int main(int Argc, charstring Argv[]) {
       fprintf(stderr, "Problems writing: %s\n", OutputFilename);
       return exit_status(EXIT_FAILURE);
     }
+    if (WriteLineTable) {
+      std::string LinesFilename = CasmLineTable::getFilenameFor(OutputFilename);
+      if (!CasmLineTable::write(*InputSymtab, LinesFilename.c_str())) {
+        fprintf(stderr, "Problems writing: %s\n", LinesFilename.c_str());
+        return exit_status(EXIT_FAILURE);
+      }
+    }
   }
 #endif
 
@@ -17,11 +17,15 @@
 #include "algorithms/wasm0xd.h"
 #include "casm/CasmReader.h"
 #include "intcomp/IntCompress.h"
+#include "intcomp/Compress.h"
+#include "stream/ChecksumWriter.h"
 #include "stream/FileReader.h"
 #include "stream/FileWriter.h"
 #include "stream/ReadBackedQueue.h"
 #include "stream/WriteBackedQueue.h"
 #include "utils/ArgsParse.h"
+#include "utils/HugePages.h"
+#include "utils/TraceEvents.h"
 
 #define TRACE_ARGS_PARSE 0
 
@@ -33,18 +37,55 @@ using namespace wasm::utils;
 
 charstring InputFilename = "-";
 charstring OutputFilename = "-";
+charstring AbbrevReportFilename = nullptr;
+charstring AbbrevReportFormatName = "json";
+charstring CountSnapshotFilename = nullptr;
+bool AddChecksums = false;
+bool UseHugePages = false;
+charstring TraceEventsFilename = nullptr;
 
 std::shared_ptr<RawStream> getInput() {
   return std::make_shared<FileReader>(InputFilename);
 }
 
 std::shared_ptr<RawStream> getOutput() {
-  return std::make_shared<FileWriter>(OutputFilename);
+  std::shared_ptr<RawStream> Output =
+      std::make_shared<FileWriter>(OutputFilename);
+  if (AddChecksums)
+    Output = std::make_shared<ChecksumWriter>(Output);
+  return Output;
+}
+
+bool writeOutput(void* Data, const uint8_t* Buffer, int32_t Size) {
+  auto* Output = (RawStream*)Data;
+  return Output->write(const_cast<uint8_t*>(Buffer), Size);
+}
+
+int runUsingCApi(const CompressionFlags& Flags) {
+  std::vector<uint8_t> Input;
+  auto Reader = getInput();
+  constexpr size_t ChunkSize = 4096;
+  while (true) {
+    size_t Start = Input.size();
+    Input.resize(Start + ChunkSize);
+    size_t Count = Reader->read(Input.data() + Start, ChunkSize);
+    Input.resize(Start + Count);
+    if (Count == 0)
+      break;
+  }
+  auto Output = getOutput();
+  int32_t Status = compress_buffer(Input.data(), Input.size(), &Flags,
+                                   writeOutput, Output.get());
+  if (!Output->freeze())
+    Status = COMPRESSOR_ERROR;
+  return Status == COMPRESSOR_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 int main(int Argc, const char* Argv[]) {
   std::vector<charstring> AlgorithmFilenames;
+  std::vector<charstring> CountSnapshotInputs;
   bool TraceAlgorithmRead;
+  bool UseCApi = false;
   CompressionFlags MyCompressionFlags;
 
   {
@@ -64,6 +105,66 @@ int main(int Argc, const char* Argv[]) {
             .setOptionName("OUTPUT")
             .setDescription("Place to put resulting compressed WASM binary"));
 
+    ArgsParser::Optional<bool> UseCApiFlag(UseCApi);
+    Args.add(UseCApiFlag.setLongName("c-api").setDescription(
+        "Use C API to compress"));
+
+    ArgsParser::Optional<bool> AddChecksumsFlag(AddChecksums);
+    Args.add(AddChecksumsFlag.setLongName("checksums")
+                 .setDescription(
+                     "Write the compressed file as blocks with CRC32C "
+                     "checksums, so that corrupted files are rejected "
+                     "before decompression"));
+
+    ArgsParser::Optional<bool> UseHugePagesFlag(UseHugePages);
+    Args.add(UseHugePagesFlag.setLongName("huge-pages")
+                 .setDescription(
+                     "Back queue pages, integer streams, and count tries "
+                     "with huge pages, to reduce TLB misses on large inputs"));
+
+    ArgsParser::Optional<charstring> AbbrevReportFilenameFlag(
+        AbbrevReportFilename);
+    Args.add(AbbrevReportFilenameFlag.setLongName("abbrev-report")
+                 .setOptionName("FILE")
+                 .setDescription(
+                     "Write a report on the effectiveness of each assigned "
+                     "abbreviation (usage count, bits written, bits saved, "
+                     "and share of decoded values) to FILE"));
+
+    ArgsParser::Optional<charstring> AbbrevReportFormatFlag(
+        AbbrevReportFormatName);
+    Args.add(AbbrevReportFormatFlag.setLongName("abbrev-report-format")
+                 .setOptionName("FORMAT")
+                 .setDescription(
+                     "Format of the abbreviation report. FORMAT is either "
+                     "'json' or 'csv'"));
+
+    ArgsParser::Optional<charstring> TraceEventsFilenameFlag(
+        TraceEventsFilename);
+    Args.add(TraceEventsFilenameFlag.setLongName("trace-events")
+                 .setOptionName("FILE")
+                 .setDescription(
+                     "Write a timeline of the compression phases to FILE, "
+                     "using the Chrome trace-event format (viewable in "
+                     "chrome://tracing or ui.perfetto.dev)"));
+
+    ArgsParser::Optional<charstring> CountSnapshotFilenameFlag(
+        CountSnapshotFilename);
+    Args.add(CountSnapshotFilenameFlag.setLongName("write-counts")
+                 .setOptionName("FILE")
+                 .setDescription(
+                     "Write the pruned pattern counts of INPUT to snapshot "
+                     "FILE, instead of compressing INPUT. Snapshots can be "
+                     "combined using merge-counts"));
+
+    ArgsParser::OptionalVector<charstring> CountSnapshotInputsFlag(
+        CountSnapshotInputs);
+    Args.add(CountSnapshotInputsFlag.setLongName("read-counts")
+                 .setOptionName("FILE")
+                 .setDescription(
+                     "Use the pattern counts in snapshot FILE(s), rather than "
+                     "the counts of INPUT, to assign abbreviations"));
+
     ArgsParser::OptionalVector<charstring> AlgorithmFilenamesFlag(
         AlgorithmFilenames);
     Args.add(AlgorithmFilenamesFlag.setShortName('a')
@@ -85,6 +186,12 @@ int main(int Argc, const char* Argv[]) {
         "Toggles usage Huffman encoding for pattern abbreviations instead"
         "of a simple weighted ordering)"));
 
+    ArgsParser::Toggle UseAdaptiveEncodingFlag(
+        MyCompressionFlags.UseAdaptiveEncoding);
+    Args.add(UseAdaptiveEncodingFlag.setLongName("adaptive").setDescription(
+        "Toggles usage of an adaptive Huffman model for pattern "
+        "abbreviations, so that no Huffman table is embedded in the output"));
+
     ArgsParser::Toggle UseCismModelFlag(MyCompressionFlags.UseCismModel);
     Args.add(UseCismModelFlag.setLongName("cism").setDescription(
         "Generate compressed algorithm using Cism algorithm"));
@@ -176,6 +283,30 @@ int main(int Argc, const char* Argv[]) {
                                  "is '--singletons' "
                                  "sepcified"));
 
+    ArgsParser::Optional<size_t> TimeBudgetFlag(MyCompressionFlags.TimeBudget);
+    Args.add(TimeBudgetFlag.setLongName("time-budget")
+                 .setOptionName("SECONDS")
+                 .setDescription(
+                     "Compress within (about) SECONDS seconds, giving up "
+                     "compression as needed. Reports the limits applied"));
+
+    ArgsParser::Optional<size_t> MemoryBudgetFlag(
+        MyCompressionFlags.MemoryBudget);
+    Args.add(MemoryBudgetFlag.setLongName("memory-budget")
+                 .setOptionName("MB")
+                 .setDescription(
+                     "Compress within (about) MB megabytes of memory, giving "
+                     "up compression as needed. Reports the limits applied"));
+
+    ArgsParser::Optional<size_t> NumReadThreadsFlag(
+        MyCompressionFlags.NumReadThreads);
+    Args.add(NumReadThreadsFlag.setLongName("read-threads")
+                 .setOptionName("N")
+                 .setDescription(
+                     "Read the function bodies of the input using N threads "
+                     "(0 implies use the number of hardware threads). The "
+                     "input is read the same as when N is 1"));
+
     ArgsParser::Optional<IntType> SmallValueMaxFlag(
         MyCompressionFlags.SmallValueMax);
     Args.add(
@@ -385,9 +516,40 @@ int main(int Argc, const char* Argv[]) {
     }
   }
 
+  if (UseHugePages && !alloc::HugePages::setEnabled(true))
+    fprintf(stderr, "Huge pages not supported, ignoring --huge-pages\n");
+
   if (MyCompressionFlags.MatchSingletonsLast)
     fprintf(stderr, "*** Running singleton patterns experiment...\n");
 
+  AbbrevReport::Format AbbrevReportFormat;
+  if (!AbbrevReport::parseFormat(AbbrevReportFormatName, AbbrevReportFormat)) {
+    fprintf(stderr, "Unknown abbreviation report format: %s\n",
+            AbbrevReportFormatName);
+    return exit_status(EXIT_FAILURE);
+  }
+
+  if (UseCApi) {
+    if (AbbrevReportFilename != nullptr) {
+      fprintf(stderr, "--abbrev-report and --c-api options not allowed\n");
+      return exit_status(EXIT_FAILURE);
+    }
+    if (CountSnapshotFilename != nullptr || !CountSnapshotInputs.empty()) {
+      fprintf(stderr, "Count snapshots and --c-api options not allowed\n");
+      return exit_status(EXIT_FAILURE);
+    }
+    if (!AlgorithmFilenames.empty()) {
+      fprintf(stderr, "-a and --c-api options not allowed\n");
+      return exit_status(EXIT_FAILURE);
+    }
+    if (TraceEventsFilename != nullptr)
+      MyCompressionFlags.TraceEventsFilename = TraceEventsFilename;
+    return exit_status(runUsingCApi(MyCompressionFlags));
+  }
+
+  if (TraceEventsFilename != nullptr)
+    TraceEvents::start(TraceEventsFilename);
+
   SymbolTable::SharedPtr AlgSymtab;
   if (AlgorithmFilenames.empty()) {
     if (MyCompressionFlags.TraceCompression)
@@ -411,10 +573,35 @@ int main(int Argc, const char* Argv[]) {
   IntCompressor Compressor(std::make_shared<ReadBackedQueue>(getInput()),
                            std::make_shared<WriteBackedQueue>(getOutput()),
                            AlgSymtab, MyCompressionFlags);
+  if (CountSnapshotFilename != nullptr)
+    Compressor.setCountSnapshotOutput(CountSnapshotFilename);
+  for (charstring Filename : CountSnapshotInputs)
+    Compressor.addCountSnapshotInput(Filename);
+  std::shared_ptr<AbbrevReport> Report;
+  if (AbbrevReportFilename != nullptr) {
+    Report = std::make_shared<AbbrevReport>(MyCompressionFlags);
+    Compressor.setAbbrevReport(Report);
+  }
   Compressor.compress();
   if (Compressor.errorsFound()) {
     fatal("Failed to compress due to errors!");
     exit_status(EXIT_FAILURE);
   }
+  if (MyCompressionFlags.TimeBudget != 0 ||
+      MyCompressionFlags.MemoryBudget != 0)
+    Compressor.describeBudget(stderr);
+  if (UseHugePages && MyCompressionFlags.TraceCompression)
+    alloc::HugePages::describe(stderr);
+  if (Report) {
+    FILE* Out = fopen(AbbrevReportFilename, "w");
+    if (Out == nullptr) {
+      fprintf(stderr, "Unable to open: %s\n", AbbrevReportFilename);
+      return exit_status(EXIT_FAILURE);
+    }
+    Report->write(Out, AbbrevReportFormat);
+    fclose(Out);
+  }
+  if (TraceEventsFilename != nullptr && !TraceEvents::stop())
+    return exit_status(EXIT_FAILURE);
   return exit_status(EXIT_SUCCESS);
 }
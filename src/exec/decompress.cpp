@@ -22,13 +22,21 @@
 #include "interp/ByteReader.h"
 #include "interp/ByteWriter.h"
 #include "interp/Decompress.h"
+#include "interp/DecompressCache.h"
 #include "interp/DecompressSelector.h"
 #include "interp/Interpreter.h"
+#include "interp/SourceProfile.h"
+#include "stream/ArrayReader.h"
+#include "stream/ChecksumReader.h"
 #include "stream/FileReader.h"
 #include "stream/FileWriter.h"
+#include "stream/MappedFileWriter.h"
 #include "stream/ReadBackedQueue.h"
+#include "stream/SpliceWriter.h"
 #include "stream/WriteBackedQueue.h"
 #include "utils/ArgsParse.h"
+#include "utils/HugePages.h"
+#include "utils/TraceEvents.h"
 
 namespace {
 
@@ -40,19 +48,100 @@ using namespace wasm::utils;
 
 const char* InputFilename = "-";
 const char* OutputFilename = "-";
+const char* TraceEventsFilename = nullptr;
+const char* ProfileListingFilename = nullptr;
+const char* CacheDirectory = nullptr;
+size_t CacheMaxSize = DecompressCache::DefaultMaxSize;
+size_t ResumeSteps = 0;
+bool SpliceOutput = false;
+bool MapOutput = true;
 
 std::shared_ptr<RawStream> getInput() {
-  return std::make_shared<FileReader>(InputFilename);
+  // Note: Inputs without checksums are passed through unchanged.
+  return std::make_shared<ChecksumReader>(
+      std::make_shared<FileReader>(InputFilename));
 }
 
 std::shared_ptr<RawStream> getOutput() {
+  // Note: Standard output is only spliced (when a pipe) if requested, while
+  // (regular) output files are written using mapped memory unless turned off.
+  if (strcmp(OutputFilename, "-") == 0) {
+    if (SpliceOutput)
+      return std::make_shared<SpliceWriter>(OutputFilename);
+    return std::make_shared<FileWriter>(OutputFilename);
+  }
+  if (MapOutput)
+    return std::make_shared<MappedFileWriter>(OutputFilename);
   return std::make_shared<FileWriter>(OutputFilename);
 }
 
-int runUsingCApi(bool TraceProgress) {
+// Passes output through to Output, keeping a copy for the result cache.
+class RecordingWriter : public RawStream {
+  RecordingWriter() = delete;
+  RecordingWriter(const RecordingWriter&) = delete;
+  RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+ public:
+  explicit RecordingWriter(std::shared_ptr<RawStream> Output)
+      : Output(Output) {}
+  ~RecordingWriter() OVERRIDE {}
+  AddressType read(ByteType* Buf, AddressType Size = 1) OVERRIDE { return 0; }
+  bool write(ByteType* Buf, AddressType Size = 1) OVERRIDE {
+    Bytes.insert(Bytes.end(), Buf, Buf + Size);
+    return Output->write(Buf, Size);
+  }
+  bool freeze() OVERRIDE { return Output->freeze(); }
+  bool atEof() OVERRIDE { return Output->atEof(); }
+  bool hasErrors() OVERRIDE { return Output->hasErrors(); }
+  const std::vector<uint8_t>& getBytes() const { return Bytes; }
+
+ private:
+  std::shared_ptr<RawStream> Output;
+  std::vector<uint8_t> Bytes;
+};
+
+void readAll(RawStream& Input, std::vector<uint8_t>& Bytes) {
+  constexpr size_t ChunkSize = 4096;
+  while (true) {
+    size_t Size = Bytes.size();
+    Bytes.resize(Size + ChunkSize);
+    size_t Count = Input.read(Bytes.data() + Size, ChunkSize);
+    Bytes.resize(Size + Count);
+    if (Count == 0)
+      return;
+  }
+}
+
+// Verifies the checksums of the input, without decompressing it.
+int verifyInput() {
+  FileReader Input(InputFilename);
+  if (Input.hasErrors()) {
+    fprintf(stderr, "Problems opening %s!\n", InputFilename);
+    return EXIT_FAILURE;
+  }
+  std::vector<uint8_t> Bytes;
+  readAll(Input, Bytes);
+  if (!ChecksumReader::verify(Bytes.data(), Bytes.size(), stderr))
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
+
+int runUsingCApi(bool TraceProgress, bool UseCoroutines) {
   void* Decomp = create_decompressor();
   if (TraceProgress)
     set_trace_decompression(Decomp, TraceProgress);
+  if (UseCoroutines)
+    set_decompressor_coroutines(Decomp, UseCoroutines);
+  if (TraceEventsFilename != nullptr)
+    set_decompressor_trace_events(Decomp, TraceEventsFilename);
+  if (CacheDirectory != nullptr &&
+      !set_decompressor_cache(Decomp, CacheDirectory, CacheMaxSize)) {
+    fprintf(stderr, "Unable to use cache directory: %s\n", CacheDirectory);
+    destroy_decompressor(Decomp);
+    return EXIT_FAILURE;
+  }
+  if (ResumeSteps != 0)
+    set_decompressor_limits(Decomp, ResumeSteps, 0, 0);
   auto Input = getInput();
   auto Output = getOutput();
   constexpr int32_t MaxBufferSize = 4096;
@@ -75,6 +164,11 @@ int runUsingCApi(bool TraceProgress) {
     }
     if (BufferSize < 0)
       break;
+    // Process the input already passed in, if stopped at a limit.
+    if (decompression_pending(Decomp)) {
+      BufferSize = continue_decompression(Decomp);
+      continue;
+    }
     // Fill the buffer with more input.
     while (MoreInput && BufferSize < MaxBufferSize) {
       size_t Count = Input->read(Buffer, MaxBufferSize - BufferSize);
@@ -88,6 +182,7 @@ int runUsingCApi(bool TraceProgress) {
     BufferSize = resume_decompression(Decomp, BufferSize);
   }
   int Result = BufferSize == DECOMPRESSOR_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+  destroy_decompressor(Decomp);
   return Result;
 }
 
@@ -114,6 +209,8 @@ int main(const int Argc, const char* Argv[]) {
   bool Verbose = false;
   bool MinimizeBlockSize = false;
   bool UseCApi = false;
+  bool VerifyOnly = false;
+  bool UseHugePages = false;
   size_t NumTries = 1;
   InterpreterFlags InterpFlags;
 
@@ -124,6 +221,28 @@ int main(const int Argc, const char* Argv[]) {
     Args.add(UseCApiFlag.setLongName("c-api").setDescription(
         "Use C API to decompress"));
 
+    ArgsParser::Optional<bool> VerifyOnlyFlag(VerifyOnly);
+    Args.add(VerifyOnlyFlag.setLongName("verify-only")
+                 .setDescription(
+                     "Only check the checksums of INPUT (see compress-int "
+                     "--checksums), without decompressing it"));
+
+    ArgsParser::Optional<bool> UseHugePagesFlag(UseHugePages);
+    Args.add(UseHugePagesFlag.setLongName("huge-pages")
+                 .setDescription(
+                     "Back queue pages and integer streams with huge pages, "
+                     "to reduce TLB misses on large inputs"));
+
+    ArgsParser::Optional<bool> SpliceOutputFlag(SpliceOutput);
+    Args.add(SpliceOutputFlag.setLongName("splice").setDescription(
+        "When standard output is a pipe, hand output pages to the pipe "
+        "(using vmsplice) rather than copying them"));
+
+    ArgsParser::Toggle MapOutputFlag(MapOutput);
+    Args.add(MapOutputFlag.setLongName("mmap").setDescription(
+        "Write regular output files using mapped (preallocated) memory, "
+        "rather than copying output pages to the file"));
+
     ArgsParser::Optional<bool> ExpectExitFailFlag(ExpectExitFail);
     Args.add(
         ExpectExitFailFlag.setLongName("expect-fail")
@@ -173,6 +292,48 @@ int main(const int Argc, const char* Argv[]) {
             "Decompress N times (used to test performance "
             "when N!=1)"));
 
+    ArgsParser::Optional<charstring> TraceEventsFilenameFlag(
+        TraceEventsFilename);
+    Args.add(TraceEventsFilenameFlag.setLongName("trace-events")
+                 .setOptionName("FILE")
+                 .setDescription(
+                     "Write a timeline of the decompression (algorithm "
+                     "stages and wasm sections) to FILE, using the Chrome "
+                     "trace-event format (viewable in chrome://tracing or "
+                     "ui.perfetto.dev)"));
+
+    ArgsParser::Optional<charstring> ProfileListingFilenameFlag(
+        ProfileListingFilename);
+    Args.add(ProfileListingFilenameFlag.setLongName("profile-listing")
+                 .setOptionName("FILE")
+                 .setDescription(
+                     "Profile the algorithms read using -a, and write their "
+                     "source to FILE, with each line annotated with its time "
+                     "and number of evaluations. Binary algorithms need a "
+                     "line table (see cast2casm --line-table)"));
+
+    ArgsParser::Optional<charstring> CacheDirectoryFlag(CacheDirectory);
+    Args.add(CacheDirectoryFlag.setLongName("cache")
+                 .setOptionName("DIR")
+                 .setDescription(
+                     "Cache decompressed results in directory DIR, keyed by "
+                     "the input and the algorithms used. Cached results are "
+                     "written without running the interpreter"));
+
+    ArgsParser::Optional<size_t> CacheMaxSizeFlag(CacheMaxSize);
+    Args.add(CacheMaxSizeFlag.setLongName("cache-size")
+                 .setOptionName("N")
+                 .setDescription(
+                     "Limit the cache directory to N bytes, removing the "
+                     "least recently used results first"));
+
+    ArgsParser::Optional<size_t> ResumeStepsFlag(ResumeSteps);
+    Args.add(ResumeStepsFlag.setLongName("resume-steps")
+                 .setOptionName("N")
+                 .setDescription(
+                     "Limit each call to resume_decompression to N "
+                     "interpreter steps (only applies with --c-api)"));
+
     ArgsParser::Toggle VerboseFlag(Verbose);
     Args.add(
         VerboseFlag.setShortName('v').setLongName("verbose").setDescription(
@@ -196,6 +357,19 @@ int main(const int Argc, const char* Argv[]) {
             .setDescription(
                 "Show algorithms as they are applied to the compressed input"));
 
+    ArgsParser::Optional<bool> UseCoroutinesFlag(InterpFlags.UseCoroutines);
+    Args.add(UseCoroutinesFlag.setLongName("coroutines")
+                 .setDescription(
+                     "Evaluate algorithms using the coroutine engine, rather "
+                     "than the state machine"));
+
+    ArgsParser::Optional<bool> MemoizePureDefinesFlag(
+        InterpFlags.MemoizePureDefines);
+    Args.add(MemoizePureDefinesFlag.setLongName("memoize")
+                 .setDescription(
+                     "Cache the results of defines that don't read or write "
+                     "streams, rather than evaluating them on each call"));
+
     switch (Args.parse(Argc, Argv)) {
       case ArgsParser::State::Good:
         break;
@@ -207,14 +381,28 @@ int main(const int Argc, const char* Argv[]) {
     }
   }
 
+  if (VerifyOnly)
+    return exit_status(verifyInput());
+
+  if (UseHugePages && !alloc::HugePages::setEnabled(true))
+    fprintf(stderr, "Huge pages not supported, ignoring --huge-pages\n");
+
   if (UseCApi) {
     if (NumTries != 1) {
       fprintf(stderr, "-t and --c-api options not allowed");
       return exit_status(EXIT_FAILURE);
     }
-    return exit_status(runUsingCApi(Verbose >= 1));
+    if (ProfileListingFilename != nullptr) {
+      fprintf(stderr, "--profile-listing and --c-api options not allowed\n");
+      return exit_status(EXIT_FAILURE);
+    }
+    return exit_status(
+        runUsingCApi(Verbose >= 1, InterpFlags.UseCoroutines));
   }
 
+  if (TraceEventsFilename != nullptr)
+    TraceEvents::start(TraceEventsFilename);
+
   std::vector<std::shared_ptr<SymbolTable>> AdditionalAlgorithms;
   SymbolTable::SharedPtr AlgSymtab;
   getNextSeparator();
@@ -224,7 +412,9 @@ int main(const int Argc, const char* Argv[]) {
       fprintf(stderr, "Opening algorithm file (%" PRIuMAX "): %s\n",
               uintmax_t(NextAlgorithm), Filename);
     CasmReader Reader;
-    Reader.setInstall(true).readTextOrBinary(Filename, AlgSymtab);
+    Reader.setInstall(true)
+        .setKeepSourceLines(ProfileListingFilename != nullptr)
+        .readTextOrBinary(Filename, AlgSymtab);
     AlgSymtab = Reader.getReadSymtab();
     size_t NextIndex = AlgIndex + 1;
     if (NextIndex == NextSeparator) {
@@ -238,6 +428,26 @@ int main(const int Argc, const char* Argv[]) {
     }
   }
 
+  std::shared_ptr<SourceProfile> Profile;
+  if (ProfileListingFilename != nullptr)
+    Profile = std::make_shared<SourceProfile>();
+
+  std::unique_ptr<DecompressCache> Cache;
+  if (CacheDirectory != nullptr) {
+    Cache.reset(new DecompressCache(CacheDirectory, CacheMaxSize));
+    if (!Cache->isValid()) {
+      fprintf(stderr, "Unable to use cache directory: %s\n", CacheDirectory);
+      return exit_status(EXIT_FAILURE);
+    }
+    // Note: Must match the selectors added below.
+    Cache->addOption(MinimizeBlockSize);
+    for (std::shared_ptr<SymbolTable> Symtab : AdditionalAlgorithms)
+      Cache->addAlgorithm(Symtab);
+    Cache->addAlgorithm(getAlgcasm0x0Symtab());
+    Cache->addAlgorithm(getAlgwasm0xdSymtab());
+    Cache->addAlgorithm(getAlgcism0x0Symtab());
+  }
+
   bool Succeeded = true;  // until proven otherwise.
   for (size_t i = 0; i < NumTries; ++i) {
     if (Verbose)
@@ -254,6 +464,33 @@ int main(const int Argc, const char* Argv[]) {
       fprintf(stderr, "Problems opening %s!\n", OutputFilename);
       return exit_status(EXIT_SUCCESS);
     }
+    std::vector<uint8_t> CacheInput;
+    std::string CacheKey;
+    std::shared_ptr<RecordingWriter> Recorder;
+    if (Cache) {
+      readAll(*Input, CacheInput);
+      if (Input->hasErrors()) {
+        fprintf(stderr, "Problems reading %s!\n", InputFilename);
+        Succeeded = false;
+        continue;
+      }
+      CacheKey = Cache->getKey(CacheInput.data(), CacheInput.size());
+      std::vector<uint8_t> CacheOutput;
+      if (Cache->lookup(CacheKey, CacheOutput)) {
+        if (Verbose)
+          fprintf(stderr, "Using cached result: %s\n", CacheKey.c_str());
+        if (!Output->write(CacheOutput.data(), CacheOutput.size()) ||
+            !Output->freeze()) {
+          fatal("Failed to write cached result!");
+          Succeeded = false;
+        }
+        continue;
+      }
+      Input = std::make_shared<ArrayReader>(CacheInput.data(),
+                                            CacheInput.size());
+      Recorder = std::make_shared<RecordingWriter>(Output);
+      Output = Recorder;
+    }
     if (Verbose)
       fprintf(stderr, "Decompressing...\n");
     // Create input, output, and decompressor.
@@ -283,11 +520,28 @@ int main(const int Argc, const char* Argv[]) {
       Trace->setTraceProgress(true);
       Decompressor.setTrace(Trace);
     }
+    if (Profile)
+      Decompressor.setSourceProfile(Profile);
     Decompressor.algorithmRead();
-    if (Decompressor.errorsFound()) {
+    if (Decompressor.errorsFound() || Input->hasErrors()) {
       fatal("Failed to decompress due to errors!");
       Succeeded = false;
+    } else if (Recorder) {
+      BackedOutput->close();
+      if (!Cache->insert(CacheKey, Recorder->getBytes()) && Verbose)
+        fprintf(stderr, "Unable to cache result: %s\n", CacheKey.c_str());
+    }
+  }
+  if (Profile) {
+    FILE* Out = fopen(ProfileListingFilename, "w");
+    if (Out == nullptr) {
+      fprintf(stderr, "Unable to open: %s\n", ProfileListingFilename);
+      return exit_status(EXIT_FAILURE);
     }
+    Profile->writeListing(Out);
+    fclose(Out);
   }
+  if (TraceEventsFilename != nullptr && !TraceEvents::stop())
+    Succeeded = false;
   return exit_status(Succeeded ? EXIT_SUCCESS : EXIT_FAILURE);
 }
@@ -0,0 +1,108 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Merges count snapshots (written by compress-int --write-counts) into a
+// single snapshot.
+
+#include "intcomp/CompressionFlags.h"
+#include "intcomp/CountSnapshot.h"
+#include "intcomp/RemoveNodesVisitor.h"
+#include "utils/ArgsParse.h"
+
+using namespace wasm;
+using namespace wasm::decode;
+using namespace wasm::intcomp;
+using namespace wasm::utils;
+
+int main(int Argc, const char* Argv[]) {
+  std::vector<charstring> InputFilenames;
+  charstring OutputFilename = nullptr;
+  bool Verbose = false;
+  CompressionFlags MyCompressionFlags;
+
+  {
+    ArgsParser Args("Merge count snapshots into a single snapshot");
+
+    ArgsParser::RequiredVector<charstring> InputFilenamesFlag(InputFilenames);
+    Args.add(InputFilenamesFlag.setOptionName("INPUT").setDescription(
+        "Count snapshot(s) to merge"));
+
+    ArgsParser::Optional<charstring> OutputFilenameFlag(OutputFilename);
+    Args.add(OutputFilenameFlag.setShortName('o')
+                 .setLongName("output")
+                 .setOptionName("OUTPUT")
+                 .setDescription("Place to put the merged count snapshot"));
+
+    ArgsParser::Optional<size_t> CountCutoffFlag(
+        MyCompressionFlags.CountCutoff);
+    Args.add(CountCutoffFlag.setDefault(100)
+                 .setLongName("min-count")
+                 .setOptionName("INTEGER")
+                 .setDescription(
+                     "Minimum number of uses of a pattern before it is kept"));
+
+    ArgsParser::Optional<size_t> WeightCutoffFlag(
+        MyCompressionFlags.WeightCutoff);
+    Args.add(WeightCutoffFlag.setDefault(100)
+                 .setLongName("min-weight")
+                 .setOptionName("INTEGER")
+                 .setDescription(
+                     "Minimum weight of a pattern before it is kept"));
+
+    ArgsParser::Toggle VerboseFlag(Verbose);
+    Args.add(
+        VerboseFlag.setShortName('v').setLongName("verbose").setDescription(
+            "Show progress of merging"));
+
+    switch (Args.parse(Argc, Argv)) {
+      case ArgsParser::State::Good:
+        break;
+      case ArgsParser::State::Usage:
+        return exit_status(EXIT_SUCCESS);
+      default:
+        fprintf(stderr, "Unable to parse command line arguments!\n");
+        return exit_status(EXIT_FAILURE);
+    }
+  }
+
+  if (OutputFilename == nullptr) {
+    fprintf(stderr, "No output file specified!\n");
+    return exit_status(EXIT_FAILURE);
+  }
+
+  auto Root = std::make_shared<RootCountNode>();
+  CountSnapshot Snapshot(Root);
+  for (charstring Filename : InputFilenames) {
+    if (Verbose)
+      fprintf(stderr, "Merging: %s\n", Filename);
+    if (!Snapshot.merge(Filename)) {
+      fprintf(stderr, "Unable to read count snapshot: %s\n", Filename);
+      return exit_status(EXIT_FAILURE);
+    }
+  }
+  if (Verbose)
+    fprintf(stderr, "Removing small usage counts\n");
+  RemoveNodesVisitor Visitor(Root, MyCompressionFlags, false, false);
+  Visitor.walk();
+  if (Verbose)
+    fprintf(stderr, "Writing: %s\n", OutputFilename);
+  if (!Snapshot.write(OutputFilename)) {
+    fprintf(stderr, "Unable to write count snapshot: %s\n", OutputFilename);
+    return exit_status(EXIT_FAILURE);
+  }
+  return exit_status(EXIT_SUCCESS);
+}
@@ -17,7 +17,6 @@
 // Implements a writer that injects abbreviations into the input stream.
 
 #include "intcomp/AbbrevAssignWriter.h"
-#include "intcomp/AbbrevSelector.h"
 #include "intcomp/AbbreviationsCollector.h"
 #include "sexp/Ast.h"
 
@@ -185,8 +184,10 @@ AbbrevAssignWriter::AbbrevAssignWriter(
       EncodingRoot(EncodingRoot),
       OutWriter(Output),
       Buffer(BufSize),
+      Selector(Buffer, Root, MyFlags),
       AssumeByteAlignment(AssumeByteAlignment),
-      ProgressCount(0) {
+      ProgressCount(0),
+      Budget(nullptr) {
   assert(Root->getDefaultSingle()->hasAbbrevIndex());
   assert(Root->getDefaultMultiple()->hasAbbrevIndex());
 }
@@ -336,11 +337,21 @@ bool AbbrevAssignWriter::flushValues() {
     Trace->setTraceProgress(true);
     Trace->addContext(OutWriter.getTraceContext());
   }
+  if (Report)
+    Report->reset(Root);
   for (AbbrevAssignValue* Value : Values) {
     if (Trace) {
       TRACE_PREFIX_USING(*Trace, "Write ");
       Value->describe(Trace->getFile());
     }
+    if (Report) {
+      if (auto* Abbrev = dyn_cast<AbbrevValue>(Value))
+        Report->recordUse(Abbrev->getAbbreviation());
+      else if (auto* Default = dyn_cast<DefaultValue>(Value))
+        Report->recordValue(Default->getValue(), MyFlags.DefaultFormat);
+      else if (auto* Loop = dyn_cast<LoopValue>(Value))
+        Report->recordValue(Loop->getValue(), MyFlags.LoopSizeFormat);
+    }
     switch (Value->getKind()) {
       default:
         fprintf(
@@ -447,9 +458,10 @@ void AbbrevAssignWriter::writeFromBuffer() {
       fprintf(Out, "************\n");
     }
   });
-  AbbrevSelector Selector(Buffer, Root, DefaultValues.size(), MyFlags);
   Selector.setTrace(getTracePtr());
-  AbbrevSelection::Ptr Sel = Selector.select();
+  if (Budget)
+    Selector.setEffortLimit(Budget->getSelectEffortLimit());
+  AbbrevSelection::Ptr Sel = Selector.select(DefaultValues.size());
   // Report progress...
   // TODO(karlschimp): Figure out why TRACE macro can't be used!
   if (MyFlags.TraceAbbrevSelectionProgress != 0) {
@@ -500,6 +512,7 @@ void AbbrevAssignWriter::writeFromBuffer() {
         break;
     }
   }
+  Selector.consumed(Index);
 }
 
 void AbbrevAssignWriter::writeUntilBufferEmpty() {
@@ -21,6 +21,9 @@
 
 #include <vector>
 
+#include "intcomp/AbbrevReport.h"
+#include "intcomp/AbbrevSelector.h"
+#include "intcomp/CompressionBudget.h"
 #include "intcomp/CompressionFlags.h"
 #include "intcomp/CountNode.h"
 #include "interp/IntStream.h"
@@ -58,6 +61,15 @@ class AbbrevAssignWriter : public interp::Writer {
 
   void setTrace(std::shared_ptr<utils::TraceClass> Trace) OVERRIDE;
 
+  // When set, records usage of abbreviations as they are flushed.
+  void setReport(std::shared_ptr<AbbrevReport> NewReport) {
+    Report = NewReport;
+  }
+
+  // When set, bounds the effort of selecting abbreviations as the budget
+  // runs down.
+  void setBudget(CompressionBudget* NewBudget) { Budget = NewBudget; }
+
  private:
   const CompressionFlags& MyFlags;
   CountNode::RootPtr Root;
@@ -66,12 +78,16 @@ class AbbrevAssignWriter : public interp::Writer {
   utils::HuffmanEncoder::NodePtr& EncodingRoot;
   interp::IntWriter OutWriter;
   utils::circular_vector<decode::IntType> Buffer;
+  // Note: Kept across flushes, so that its state can be reused.
+  AbbrevSelector Selector;
   std::vector<decode::IntType> DefaultValues;
   // Intermediate structure. Allows us to change encoding of
   // abbreviations once we know the actually usage counts.
   std::vector<AbbrevAssignValue*> Values;
   bool AssumeByteAlignment;
   size_t ProgressCount;
+  std::shared_ptr<AbbrevReport> Report;
+  CompressionBudget* Budget;
 
   void bufferValue(decode::IntType Value);
   void forwardAbbrev(CountNode::Ptr Abbrev);
@@ -0,0 +1,284 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a report on how effective the assigned abbreviations were.
+
+#include "intcomp/AbbrevReport.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wasm {
+
+using namespace decode;
+using namespace interp;
+using namespace utils;
+
+namespace intcomp {
+
+namespace {
+
+// Returns the number of bits used to write Value using format Fmt.
+size_t getFormatBits(IntType Value, IntTypeFormat Fmt) {
+  IntTypeFormats Formats(Value);
+  size_t Size = Formats.getByteSize(Fmt);
+  if (Size == IntTypeFormats::NotValid)
+    Size = Formats.getByteSize(Formats.getFirstMinimumFormat());
+  return Size * 8;
+}
+
+}  // end of anonymous namespace
+
+AbbrevReport::AbbrevReport(const CompressionFlags& MyFlags)
+    : MyFlags(MyFlags), LastUsage(nullptr) {}
+
+AbbrevReport::~AbbrevReport() {}
+
+bool AbbrevReport::parseFormat(charstring Name, Format& Fmt) {
+  if (strcmp(Name, "json") == 0) {
+    Fmt = Format::Json;
+    return true;
+  }
+  if (strcmp(Name, "csv") == 0) {
+    Fmt = Format::Csv;
+    return true;
+  }
+  return false;
+}
+
+void AbbrevReport::reset(CountNode::RootPtr NewRoot) {
+  UsageMap.clear();
+  LastUsage = nullptr;
+  Root = NewRoot;
+}
+
+void AbbrevReport::recordUse(CountNode::Ptr Abbrev) {
+  LastUsage = &UsageMap[Abbrev];
+  ++LastUsage->Uses;
+  ++LastUsage->DecodedValues;
+  if (auto* IntNd = dyn_cast<IntCountNode>(Abbrev.get())) {
+    LastUsage->DecodedValues += IntNd->getPathLength();
+    // The cism model also reads the size and values of the pattern.
+    if (MyFlags.UseCismModel)
+      LastUsage->DecodedValues += IntNd->getPathLength() + 1;
+  }
+}
+
+void AbbrevReport::recordValue(IntType Value, IntTypeFormat Fmt) {
+  if (LastUsage == nullptr)
+    return;
+  ++LastUsage->DecodedValues;
+  LastUsage->ValueBits += getFormatBits(Value, Fmt);
+}
+
+size_t AbbrevReport::getCodeBits(const CountNode* Abbrev) const {
+  if (!Abbrev->hasAbbrevIndex())
+    return 0;
+  if (MyFlags.UseHuffmanEncoding && !MyFlags.UseAdaptiveEncoding)
+    return Abbrev->getAbbrevNumBits();
+  return getFormatBits(Abbrev->getAbbrevIndex(), MyFlags.AbbrevFormat);
+}
+
+size_t AbbrevReport::getInlineBits(const CountNode* Abbrev) const {
+  // Note: Matches the values written for each use by
+  // AbbrevAssignWriter::flushValues() when using the cism model.
+  if (!MyFlags.UseCismModel || !isa<IntCountNode>(Abbrev))
+    return 0;
+  std::vector<IntType> Values;
+  getValues(Abbrev, Values);
+  size_t Bits = getFormatBits(Values.size(), MyFlags.LoopSizeFormat);
+  for (IntType Value : Values)
+    Bits += getFormatBits(Value, MyFlags.DefaultFormat);
+  return Bits;
+}
+
+size_t AbbrevReport::getDefaultBits(const CountNode* Abbrev) const {
+  if (!isa<IntCountNode>(Abbrev) || !Root)
+    return getCodeBits(Abbrev);
+  // Cost of writing each value of the pattern using the default single
+  // abbreviation.
+  size_t SingleBits = getCodeBits(Root->getDefaultSingle().get());
+  std::vector<IntType> Values;
+  getValues(Abbrev, Values);
+  size_t Bits = 0;
+  for (IntType Value : Values)
+    Bits += SingleBits + getFormatBits(Value, MyFlags.DefaultFormat);
+  return Bits;
+}
+
+void AbbrevReport::getValues(const CountNode* Abbrev,
+                             std::vector<IntType>& Values) {
+  const auto* Nd = dyn_cast<IntCountNode>(Abbrev);
+  while (Nd) {
+    Values.push_back(Nd->getValue());
+    Nd = Nd->getParent().get();
+  }
+  std::reverse(Values.begin(), Values.end());
+}
+
+charstring AbbrevReport::getKindName(const CountNode* Abbrev) {
+  switch (Abbrev->getKind()) {
+    case CountNode::Kind::Root:
+      return "root";
+    case CountNode::Kind::Block:
+      return cast<BlockCountNode>(Abbrev)->isEnter() ? "block.enter"
+                                                     : "block.exit";
+    case CountNode::Kind::Default:
+      return cast<DefaultCountNode>(Abbrev)->isSingle() ? "default.single"
+                                                        : "default.multiple";
+    case CountNode::Kind::Align:
+      return "align";
+    case CountNode::Kind::Singleton:
+      return "singleton";
+    case CountNode::Kind::IntSequence:
+      return "sequence";
+  }
+  WASM_RETURN_UNREACHABLE("unknown");
+}
+
+void AbbrevReport::writePattern(FILE* Out, const CountNode* Abbrev) {
+  if (!isa<IntCountNode>(Abbrev)) {
+    fputs(getKindName(Abbrev), Out);
+    return;
+  }
+  std::vector<IntType> Values;
+  getValues(Abbrev, Values);
+  bool IsFirst = true;
+  for (IntType Value : Values) {
+    if (IsFirst)
+      IsFirst = false;
+    else
+      fputc(' ', Out);
+    fprint_IntType(Out, Value);
+  }
+}
+
+void AbbrevReport::collectEntries(std::vector<Entry>& Entries) const {
+  for (const auto& Pair : UsageMap) {
+    Entry E;
+    E.Abbrev = Pair.first;
+    E.Uses = Pair.second.Uses;
+    E.DecodedValues = Pair.second.DecodedValues;
+    E.CodeBits = getCodeBits(E.Abbrev.get());
+    E.InlineBits = getInlineBits(E.Abbrev.get());
+    E.ValueBits = Pair.second.ValueBits;
+    E.DefaultBits = getDefaultBits(E.Abbrev.get());
+    // Note: Following values are written either way, and hence don't
+    // change the savings.
+    E.SavedBits = (int64_t(E.DefaultBits) - int64_t(E.CodeBits) -
+                   int64_t(E.InlineBits)) *
+                  int64_t(E.Uses);
+    Entries.push_back(E);
+  }
+  std::sort(Entries.begin(), Entries.end(),
+            [](const Entry& E1, const Entry& E2) {
+              if (E1.Uses != E2.Uses)
+                return E1.Uses > E2.Uses;
+              return *E1.Abbrev < *E2.Abbrev;
+            });
+}
+
+void AbbrevReport::write(FILE* Out, Format Fmt) const {
+  std::vector<Entry> Entries;
+  collectEntries(Entries);
+  switch (Fmt) {
+    case Format::Json:
+      writeJson(Out, Entries);
+      break;
+    case Format::Csv:
+      writeCsv(Out, Entries);
+      break;
+  }
+}
+
+void AbbrevReport::writeJson(FILE* Out,
+                             const std::vector<Entry>& Entries) const {
+  size_t TotalUses = 0;
+  size_t TotalDecoded = 0;
+  size_t TotalBits = 0;
+  int64_t TotalSaved = 0;
+  for (const Entry& E : Entries) {
+    TotalUses += E.Uses;
+    TotalDecoded += E.DecodedValues;
+    TotalBits += getTotalBits(E);
+    TotalSaved += E.SavedBits;
+  }
+  fprintf(Out, "{\n");
+  fprintf(Out, "  \"huffman\": %s,\n",
+          MyFlags.UseHuffmanEncoding ? "true" : "false");
+  fprintf(Out, "  \"adaptive\": %s,\n",
+          MyFlags.UseAdaptiveEncoding ? "true" : "false");
+  fprintf(Out, "  \"cism\": %s,\n", MyFlags.UseCismModel ? "true" : "false");
+  fprintf(Out, "  \"uses\": %" PRIuMAX ",\n", uintmax_t(TotalUses));
+  fprintf(Out, "  \"decoded_values\": %" PRIuMAX ",\n",
+          uintmax_t(TotalDecoded));
+  fprintf(Out, "  \"total_bits\": %" PRIuMAX ",\n", uintmax_t(TotalBits));
+  fprintf(Out, "  \"bits_saved\": %" PRIdMAX ",\n", intmax_t(TotalSaved));
+  fprintf(Out, "  \"abbreviations\": [");
+  bool IsFirst = true;
+  for (const Entry& E : Entries) {
+    fputs(IsFirst ? "\n" : ",\n", Out);
+    IsFirst = false;
+    fprintf(Out, "    {\"index\": %" PRIuMAX ", \"kind\": \"%s\", ",
+            uintmax_t(E.Abbrev->getAbbrevIndex()),
+            getKindName(E.Abbrev.get()));
+    fputs("\"pattern\": \"", Out);
+    writePattern(Out, E.Abbrev.get());
+    fprintf(Out,
+            "\", \"uses\": %" PRIuMAX ", \"code_bits\": %" PRIuMAX
+            ", \"inline_bits\": %" PRIuMAX ", \"value_bits\": %" PRIuMAX
+            ", \"total_bits\": %" PRIuMAX ", \"default_bits\": %" PRIuMAX
+            ", \"bits_saved\": %" PRIdMAX ", \"decoded_values\": %" PRIuMAX
+            ", \"decoded_share\": %.6f}",
+            uintmax_t(E.Uses), uintmax_t(E.CodeBits), uintmax_t(E.InlineBits),
+            uintmax_t(E.ValueBits), uintmax_t(getTotalBits(E)),
+            uintmax_t(E.DefaultBits), intmax_t(E.SavedBits),
+            uintmax_t(E.DecodedValues),
+            TotalDecoded == 0 ? 0.0
+                              : double(E.DecodedValues) / double(TotalDecoded));
+  }
+  fputs(IsFirst ? "]\n" : "\n  ]\n", Out);
+  fprintf(Out, "}\n");
+}
+
+void AbbrevReport::writeCsv(FILE* Out,
+                            const std::vector<Entry>& Entries) const {
+  size_t TotalDecoded = 0;
+  for (const Entry& E : Entries)
+    TotalDecoded += E.DecodedValues;
+  fprintf(Out,
+          "index,kind,pattern,uses,code_bits,inline_bits,value_bits,"
+          "total_bits,default_bits,bits_saved,decoded_values,"
+          "decoded_share\n");
+  for (const Entry& E : Entries) {
+    fprintf(Out, "%" PRIuMAX ",%s,", uintmax_t(E.Abbrev->getAbbrevIndex()),
+            getKindName(E.Abbrev.get()));
+    writePattern(Out, E.Abbrev.get());
+    fprintf(Out,
+            ",%" PRIuMAX ",%" PRIuMAX ",%" PRIuMAX ",%" PRIuMAX ",%" PRIuMAX
+            ",%" PRIuMAX ",%" PRIdMAX ",%" PRIuMAX ",%.6f\n",
+            uintmax_t(E.Uses), uintmax_t(E.CodeBits), uintmax_t(E.InlineBits),
+            uintmax_t(E.ValueBits), uintmax_t(getTotalBits(E)),
+            uintmax_t(E.DefaultBits), intmax_t(E.SavedBits),
+            uintmax_t(E.DecodedValues),
+            TotalDecoded == 0 ? 0.0
+                              : double(E.DecodedValues) / double(TotalDecoded));
+  }
+}
+
+}  // end of namespace intcomp
+
+}  // end of namespace wasm
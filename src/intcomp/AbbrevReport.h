@@ -0,0 +1,115 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a report on how effective the assigned abbreviations were, based
+// on how they were actually used in the compressed integer stream.
+
+#ifndef DECOMPRESSOR_SRC_INTCOMP_ABBREVREPORT_H
+#define DECOMPRESSOR_SRC_INTCOMP_ABBREVREPORT_H
+
+#include <map>
+
+#include "intcomp/CompressionFlags.h"
+#include "intcomp/CountNode.h"
+
+namespace wasm {
+
+namespace intcomp {
+
+class AbbrevReport {
+  AbbrevReport() = delete;
+  AbbrevReport(const AbbrevReport&) = delete;
+  AbbrevReport& operator=(const AbbrevReport&) = delete;
+
+ public:
+  enum class Format { Json, Csv };
+
+  explicit AbbrevReport(const CompressionFlags& MyFlags);
+  ~AbbrevReport();
+
+  // Returns false if Name isn't a known report format.
+  static bool parseFormat(charstring Name, Format& Fmt);
+
+  // Clears recorded usage, and sets the root of the abbreviation trie.
+  void reset(CountNode::RootPtr NewRoot);
+
+  // Records that Abbrev was written to the compressed integer stream.
+  void recordUse(CountNode::Ptr Abbrev);
+
+  // Records a (non-abbreviation) value written to the compressed integer
+  // stream, using format Fmt. The value is charged to the last recorded
+  // abbreviation.
+  void recordValue(decode::IntType Value, interp::IntTypeFormat Fmt);
+
+  void write(FILE* Out, Format Fmt) const;
+
+ private:
+  struct Usage {
+    size_t Uses;
+    // Number of integers read (abbreviation indices, inlined and following
+    // values) and generated (values of patterns) by the decompressor, when
+    // processing the uses. Approximates, but doesn't count, the steps of
+    // the decompressor.
+    size_t DecodedValues;
+    // Bits of the (non-abbreviation) values following the uses.
+    size_t ValueBits;
+    Usage() : Uses(0), DecodedValues(0), ValueBits(0) {}
+  };
+  struct Entry {
+    CountNode::Ptr Abbrev;
+    size_t Uses;
+    size_t DecodedValues;
+    size_t CodeBits;
+    // Bits of the values written after each use, when using the cism model.
+    size_t InlineBits;
+    size_t ValueBits;
+    size_t DefaultBits;
+    int64_t SavedBits;
+    Entry()
+        : Uses(0),
+          DecodedValues(0),
+          CodeBits(0),
+          InlineBits(0),
+          ValueBits(0),
+          DefaultBits(0),
+          SavedBits(0) {}
+  };
+  const CompressionFlags& MyFlags;
+  std::map<CountNode::Ptr, Usage> UsageMap;
+  Usage* LastUsage;
+  CountNode::RootPtr Root;
+
+  void collectEntries(std::vector<Entry>& Entries) const;
+  // Returns the bits written for the uses, including following values.
+  static size_t getTotalBits(const Entry& E) {
+    return (E.CodeBits + E.InlineBits) * E.Uses + E.ValueBits;
+  }
+  size_t getCodeBits(const CountNode* Abbrev) const;
+  size_t getInlineBits(const CountNode* Abbrev) const;
+  size_t getDefaultBits(const CountNode* Abbrev) const;
+  static void getValues(const CountNode* Abbrev,
+                        std::vector<decode::IntType>& Values);
+  static charstring getKindName(const CountNode* Abbrev);
+  static void writePattern(FILE* Out, const CountNode* Abbrev);
+  void writeJson(FILE* Out, const std::vector<Entry>& Entries) const;
+  void writeCsv(FILE* Out, const std::vector<Entry>& Entries) const;
+};
+
+}  // end of namespace intcomp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTCOMP_ABBREVREPORT_H
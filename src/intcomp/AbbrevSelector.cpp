@@ -18,6 +18,7 @@
 
 #include "intcomp/AbbrevSelector.h"
 
+#include <algorithm>
 #include <cassert>
 
 #ifdef NODEBUG
@@ -138,16 +139,17 @@ void AbbrevSelection::describe(FILE* Out, bool Summary) {
   } while (Next && !Summary);
 }
 
-AbbrevSelector::AbbrevSelector(BufferType Buffer,
+AbbrevSelector::AbbrevSelector(const BufferType& Buffer,
                                CountNode::RootPtr Root,
-                               size_t NumLeadingDefaultValues,
                                const CompressionFlags& Flags)
     : Buffer(Buffer),
       Root(Root),
-      NumLeadingDefaultValues(NumLeadingDefaultValues),
+      NumLeadingDefaultValues(0),
       NextCreationIndex(0),
+      EffortLimit(0),
       Flags(Flags),
-      Heap(std::make_shared<HeapType>(isHillclimbLT)) {}
+      Heap(std::make_shared<HeapType>(isHillclimbLT)),
+      NumPoolUsed(0) {}
 
 void AbbrevSelector::setTrace(TraceClass::Ptr NewTrace) {
   Trace = NewTrace;
@@ -178,13 +180,42 @@ AbbrevSelection::Ptr AbbrevSelector::create(CountNode::Ptr Abbreviation,
     LocalWeight += PreviousPtr->getWeight();
     LocalIntsConsumed += PreviousPtr->getIntsConsumed();
   }
-  return std::make_shared<AbbrevSelection>(Abbreviation, Previous,
-                                           LocalIntsConsumed, LocalWeight,
-                                           NextCreationIndex++);
+  if (NumPoolUsed < Pool.size()) {
+    AbbrevSelection::Ptr& Sel = Pool[NumPoolUsed++];
+    // Only recycle if no longer referenced outside of the pool.
+    if (Sel.use_count() == 1) {
+      Sel->Abbreviation = Abbreviation;
+      Sel->Previous = Previous;
+      Sel->IntsConsumed = LocalIntsConsumed;
+      Sel->Weight = LocalWeight;
+      Sel->CreationIndex = NextCreationIndex++;
+      return Sel;
+    }
+    Sel = std::make_shared<AbbrevSelection>(Abbreviation, Previous,
+                                            LocalIntsConsumed, LocalWeight,
+                                            NextCreationIndex++);
+    return Sel;
+  }
+  Pool.push_back(std::make_shared<AbbrevSelection>(
+      Abbreviation, Previous, LocalIntsConsumed, LocalWeight,
+      NextCreationIndex++));
+  ++NumPoolUsed;
+  return Pool.back();
 }
 
-void AbbrevSelector::createDefaults(AbbrevSelection::Ptr Previous) {
-  IF_TRACE(Detail, TRACE_MESSAGE("Try default match"));
+void AbbrevSelector::recyclePool() {
+  // Release the links between selections, so that selections that are no
+  // longer used are only referenced by the pool.
+  for (size_t i = 0; i < NumPoolUsed; ++i) {
+    AbbrevSelection* Sel = Pool[i].get();
+    Sel->Abbreviation.reset();
+    Sel->Previous.reset();
+  }
+  NumPoolUsed = 0;
+}
+
+AbbrevSelection::Ptr AbbrevSelector::createDefault(
+    AbbrevSelection::Ptr Previous) {
   AbbrevSelection::Ptr Sel;
   bool HasPrevious = bool(Previous);
   size_t Index = HasPrevious ? Previous->getIntsConsumed() : 0;
@@ -222,6 +253,12 @@ void AbbrevSelector::createDefaults(AbbrevSelection::Ptr Previous) {
     CountNode::DefaultPtr Default = Root->getDefaultMultiple();
     Sel = create(Root->getDefaultMultiple(), Previous, ValueWeight, 1);
   }
+  return Sel;
+}
+
+void AbbrevSelector::createDefaults(AbbrevSelection::Ptr Previous) {
+  IF_TRACE(Detail, TRACE_MESSAGE("Try default match"));
+  AbbrevSelection::Ptr Sel = createDefault(Previous);
   IF_TRACE(Create, TRACE_ABBREV_SELECTION("create", Sel));
   Heap->push(Sel);
 }
@@ -267,6 +304,59 @@ void AbbrevSelector::createMatches() {
   createMatches(Empty);
 }
 
+bool AbbrevSelector::matchesBuffer(IntCountNode* Nd, size_t Index) const {
+  // Note: Nd matches the values ending at Index - 1.
+  while (Nd != nullptr) {
+    if (Index == 0 || Buffer[--Index] != Nd->getValue())
+      return false;
+    Nd = Nd->getParent().get();
+  }
+  return true;
+}
+
+void AbbrevSelector::createCarryOver() {
+  if (CarryOver.empty())
+    return;
+  IF_TRACE(Detail, TRACE_MESSAGE("Try carried over selection"));
+  AbbrevSelection::Ptr Sel;
+  for (CountNode::Ptr& Abbrev : CarryOver) {
+    size_t Index = Sel ? Sel->getIntsConsumed() : 0;
+    if (Index >= Buffer.size()) {
+      Sel.reset();
+      break;
+    }
+    if (auto* IntNd = dyn_cast<IntCountNode>(Abbrev.get())) {
+      size_t Length = IntNd->getPathLength();
+      if (!IntNd->hasAbbrevIndex() || Index + Length > Buffer.size() ||
+          !matchesBuffer(IntNd, Index + Length)) {
+        Sel.reset();
+        break;
+      }
+      Sel = create(Abbrev, Sel, computeAbbrevWeight(Abbrev), Length);
+    } else {
+      Sel = createDefault(Sel);
+    }
+  }
+  CarryOver.clear();
+  if (!Sel)
+    return;
+  IF_TRACE(Create, TRACE_ABBREV_SELECTION("create", Sel));
+  Heap->push(Sel);
+}
+
+void AbbrevSelector::consumed(size_t NumInts) {
+  CarryOver.clear();
+  AbbrevSelection::Ptr Sel = Selected;
+  Selected.reset();
+  // Collect (in reverse order) the abbreviations after the consumed values,
+  // requiring that the consumed values end on a selection boundary.
+  for (; Sel && Sel->getIntsConsumed() > NumInts; Sel = Sel->getPrevious())
+    CarryOver.push_back(Sel->getAbbreviation());
+  if (Sel && Sel->getIntsConsumed() != NumInts)
+    CarryOver.clear();
+  std::reverse(CarryOver.begin(), CarryOver.end());
+}
+
 AbbrevSelection::Ptr AbbrevSelector::popHeap() {
   assert(Heap);
   HeapType::entry_ptr Entry = Heap->top();
@@ -274,17 +364,35 @@ AbbrevSelection::Ptr AbbrevSelector::popHeap() {
   return Entry->getValue();
 }
 
-AbbrevSelection::Ptr AbbrevSelector::select() {
+AbbrevSelection::Ptr AbbrevSelector::select(size_t NumLeadingDefaultValues) {
   TRACE_METHOD("select");
   (void)Flags;
+  this->NumLeadingDefaultValues = NumLeadingDefaultValues;
+  Selected.reset();
+  Heap->clear();
+  recyclePool();
   AbbrevSelection::Ptr Min;
-  if (Buffer.size() == 0)
+  if (Buffer.size() == 0) {
+    CarryOver.clear();
     return Min;
+  }
   // Create possible defaults.
   AbbrevSelection::Ptr UsableMin;
-  Heap->clear();
   createMatches();
+  // Note: Added after the matches, so that the (newly created) matches win
+  // ties.
+  createCarryOver();
+  size_t Effort = 0;
+  // Candidate that consumed the most of the buffer, in case the search is
+  // cut short by the effort limit.
+  AbbrevSelection::Ptr Furthest;
   while (!Heap->empty()) {
+    if (EffortLimit != 0 && Effort++ >= EffortLimit) {
+      IF_TRACE(Select, TRACE_MESSAGE("Effort limit reached"));
+      if (!Min)
+        Min = Furthest;
+      break;
+    }
     // Get candidate selection.
     IF_TRACE(Detail, {
       TRACE(size_t, "heap size", Heap->size());
@@ -294,6 +402,9 @@ AbbrevSelection::Ptr AbbrevSelector::select() {
     IF_TRACE(Select, TRACE_ABBREV_SELECTION("Select", Sel));
     assert(bool(Sel));
 
+    if (!Furthest || Sel->getIntsConsumed() > Furthest->getIntsConsumed())
+      Furthest = Sel;
+
     bool UsableCase = true;
     if (Flags.MatchSingletonsLast) {
       if (CountNode::Ptr Abbrev = Sel->getAbbreviation()) {
@@ -348,6 +459,7 @@ AbbrevSelection::Ptr AbbrevSelector::select() {
     createMatches(Sel);
   }
   TRACE_ABBREV_SELECTION("Selected min", Min);
+  Selected = Min;
   return Min;
 }
 
@@ -86,16 +86,35 @@ class AbbrevSelection : public std::enable_shared_from_this<AbbrevSelection> {
   size_t CreationIndex;
 };
 
+// Selects abbreviations for the (sliding) window of values in a buffer.
+// The selector is meant to be long-lived: after each selection, the caller
+// reports (with consumed()) how many values it removed from the front of the
+// buffer. The part of the selection covering the remaining values is then
+// used as an initial candidate of the next selection. Selection nodes are
+// recycled, and hence a selection returned by select() is only valid until
+// the next call to select().
 class AbbrevSelector {
+  AbbrevSelector() = delete;
+  AbbrevSelector(const AbbrevSelector&) = delete;
+  AbbrevSelector& operator=(const AbbrevSelector&) = delete;
+
  public:
   typedef utils::circular_vector<decode::IntType> BufferType;
-  AbbrevSelector(BufferType Buffer,
+  // Note: Buffer is not copied, and must outlive the selector.
+  AbbrevSelector(const BufferType& Buffer,
                  CountNode::RootPtr Root,
-                 size_t NumLeadingDefaultValues,
                  const CompressionFlags& Flags);
   // Heuristically finds the best (measured by weight) abberviation selection
   // for the contents of the buffer.
-  AbbrevSelection::Ptr select();
+  AbbrevSelection::Ptr select(size_t NumLeadingDefaultValues);
+
+  // Notes that the first NumInts values of the buffer (covered by leading
+  // abbreviations of the last selection) have been removed.
+  void consumed(size_t NumInts);
+
+  // When non-zero, bounds the number of candidate selections expanded by
+  // select(). If reached, the best selection found so far is used.
+  void setEffortLimit(size_t NewValue) { EffortLimit = NewValue; }
 
   void setTrace(utils::TraceClass::Ptr Trace);
   utils::TraceClass::Ptr getTracePtr();
@@ -104,14 +123,23 @@ class AbbrevSelector {
 
  private:
   typedef utils::heap<AbbrevSelection::Ptr> HeapType;
-  BufferType Buffer;
+  const BufferType& Buffer;
   CountNode::RootPtr Root;
   size_t NumLeadingDefaultValues;
   size_t NextCreationIndex;
+  size_t EffortLimit;
   const CompressionFlags& Flags;
   std::shared_ptr<HeapType> Heap;
   std::map<decode::IntType, interp::IntTypeFormats*> FormatMap;
   utils::TraceClass::Ptr Trace;
+  // The last selection made (until consumed() is called).
+  AbbrevSelection::Ptr Selected;
+  // The abbreviations of the last selection not consumed, in order.
+  std::vector<CountNode::Ptr> CarryOver;
+  // Selection nodes created by select(). The first NumPoolUsed are in use
+  // by the current selection.
+  std::vector<AbbrevSelection::Ptr> Pool;
+  size_t NumPoolUsed;
 
   AbbrevSelection::Ptr create(CountNode::Ptr Abbreviation,
                               AbbrevSelection::Ptr Previous,
@@ -120,10 +148,16 @@ class AbbrevSelector {
 
   size_t computeAbbrevWeight(CountNode::Ptr Abbev);
   size_t computeValueWeight(decode::IntType Value);
+  AbbrevSelection::Ptr createDefault(AbbrevSelection::Ptr Previous);
   void createDefaults(AbbrevSelection::Ptr Previous);
   void createIntSeqMatches(AbbrevSelection::Ptr Previous);
   void createMatches(AbbrevSelection::Ptr Previous);
   void createMatches();
+  // Adds the carried over abbreviations (if still valid for the buffer) as a
+  // candidate selection.
+  void createCarryOver();
+  bool matchesBuffer(IntCountNode* Nd, size_t Index) const;
+  void recyclePool();
   AbbrevSelection::Ptr popHeap();
 };
 
@@ -265,10 +265,15 @@ Node* AbbreviationCodegen::generateStartFunction() {
 }
 
 Node* AbbreviationCodegen::generateAbbreviationRead() {
-  auto* Format =
-      EncodingRoot
-          ? Symtab->create<BinaryEval>(generateHuffmanEncoding(EncodingRoot))
-          : generateAbbrevFormat(Flags.AbbrevFormat);
+  Node* Format = nullptr;
+  if (EncodingRoot)
+    Format =
+        Symtab->create<BinaryEval>(generateHuffmanEncoding(EncodingRoot));
+  else if (Flags.UseAdaptiveEncoding)
+    Format = Symtab->create<BinaryAdaptive>(Assignments.size(),
+                                            ValueFormat::Decimal);
+  else
+    Format = generateAbbrevFormat(Flags.AbbrevFormat);
   if (ToRead) {
     Format = Symtab->create<Read>(Format);
   }
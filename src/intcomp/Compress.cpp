@@ -0,0 +1,182 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implementation of the in-process API to the (integer) compressor.
+
+#include "intcomp/Compress.h"
+
+#include "algorithms/wasm0xd.h"
+#include "intcomp/IntCompress.h"
+#include "stream/ArrayReader.h"
+#include "stream/ReadBackedQueue.h"
+#include "stream/WriteBackedQueue.h"
+#include "utils/TraceEvents.h"
+
+namespace wasm {
+
+using namespace decode;
+using namespace filt;
+
+namespace intcomp {
+
+namespace {
+
+// Passes written bytes to a callback.
+class CallbackWriter FINAL : public RawStream {
+  CallbackWriter() = delete;
+  CallbackWriter(const CallbackWriter&) = delete;
+  CallbackWriter& operator=(const CallbackWriter&) = delete;
+
+ public:
+  explicit CallbackWriter(CompressOutputFcn& Output)
+      : Output(Output), FoundErrors(false), IsFrozen(false) {}
+  ~CallbackWriter() OVERRIDE {}
+
+  AddressType read(ByteType* Buf, AddressType Size = 1) OVERRIDE { return 0; }
+
+  bool write(ByteType* Buf, AddressType Size = 1) OVERRIDE {
+    if (IsFrozen || FoundErrors)
+      return false;
+    if (Size == 0)
+      return true;
+    if (!Output(Buf, Size))
+      FoundErrors = true;
+    return !FoundErrors;
+  }
+
+  bool freeze() OVERRIDE {
+    IsFrozen = true;
+    return !FoundErrors;
+  }
+
+  bool atEof() OVERRIDE { return IsFrozen; }
+
+  bool hasErrors() OVERRIDE { return FoundErrors; }
+
+ private:
+  CompressOutputFcn& Output;
+  bool FoundErrors;
+  bool IsFrozen;
+};
+
+}  // end of anonymous namespace
+
+bool compressBuffer(const uint8_t* Input,
+                    size_t Size,
+                    const CompressionFlags& Flags,
+                    CompressOutputFcn Output) {
+  bool RecordTraceEvents = !Flags.TraceEventsFilename.empty() &&
+                           utils::TraceEvents::start(
+                               Flags.TraceEventsFilename.c_str());
+  auto Writer = std::make_shared<CallbackWriter>(Output);
+  auto OutputQueue = std::make_shared<WriteBackedQueue>(Writer);
+  bool Success;
+  {
+    IntCompressor Compressor(std::make_shared<ReadBackedQueue>(
+                                 std::make_shared<ArrayReader>(Input, Size)),
+                             OutputQueue, getAlgwasm0xdSymtab(), Flags);
+    Compressor.compress();
+    Success = !Compressor.errorsFound();
+  }
+  // Flush remaining pages to the writer.
+  OutputQueue->close();
+  if (RecordTraceEvents && !utils::TraceEvents::stop())
+    Success = false;
+  return Success && OutputQueue->isGood() && Writer->freeze();
+}
+
+bool compressBuffer(const uint8_t* Input,
+                    size_t Size,
+                    const CompressionFlags& Flags,
+                    std::vector<uint8_t>& Output) {
+  return compressBuffer(Input, Size, Flags,
+                        [&](const uint8_t* Buffer, size_t BufSize) -> bool {
+                          Output.insert(Output.end(), Buffer,
+                                        Buffer + BufSize);
+                          return true;
+                        });
+}
+
+}  // end of namespace intcomp
+
+extern "C" {
+
+using namespace intcomp;
+
+void* create_compression_flags() {
+  return new CompressionFlags();
+}
+
+void set_compression_cutoffs(void* Flags,
+                             uint64_t CountCutoff,
+                             uint64_t WeightCutoff) {
+  auto* MyFlags = (CompressionFlags*)Flags;
+  MyFlags->CountCutoff = CountCutoff;
+  MyFlags->WeightCutoff = WeightCutoff;
+}
+
+void set_compression_huffman(void* Flags, bool NewValue) {
+  auto* MyFlags = (CompressionFlags*)Flags;
+  MyFlags->UseHuffmanEncoding = NewValue;
+}
+
+void set_compression_adaptive(void* Flags, bool NewValue) {
+  auto* MyFlags = (CompressionFlags*)Flags;
+  MyFlags->UseAdaptiveEncoding = NewValue;
+}
+
+void set_compression_budget(void* Flags,
+                            uint64_t TimeBudget,
+                            uint64_t MemoryBudget) {
+  auto* MyFlags = (CompressionFlags*)Flags;
+  MyFlags->TimeBudget = TimeBudget;
+  MyFlags->MemoryBudget = MemoryBudget;
+}
+
+void set_compression_trace_events(void* Flags, const char* Filename) {
+  auto* MyFlags = (CompressionFlags*)Flags;
+  MyFlags->TraceEventsFilename = Filename ? Filename : "";
+}
+
+void set_compression_cism(void* Flags, bool UseCism, bool Align) {
+  auto* MyFlags = (CompressionFlags*)Flags;
+  MyFlags->UseCismModel = UseCism;
+  MyFlags->AlignOpcodes = Align;
+}
+
+void destroy_compression_flags(void* Flags) {
+  delete (CompressionFlags*)Flags;
+}
+
+int32_t compress_buffer(const uint8_t* Input,
+                        int32_t Size,
+                        const void* Flags,
+                        compressor_output_fcn Output,
+                        void* Data) {
+  if (Size < 0 || Output == nullptr)
+    return COMPRESSOR_ERROR;
+  CompressionFlags Defaults;
+  const auto* MyFlags = Flags ? (const CompressionFlags*)Flags : &Defaults;
+  bool Success = compressBuffer(
+      Input, Size, *MyFlags, [&](const uint8_t* Buffer, size_t BufSize) {
+        return Output(Data, Buffer, int32_t(BufSize));
+      });
+  return Success ? COMPRESSOR_SUCCESS : COMPRESSOR_ERROR;
+}
+
+}  // end extern "C".
+
+}  // end of namespace wasm
@@ -0,0 +1,120 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* In-process API to the (integer) compressor. */
+
+#ifndef DECOMPRESSOR_SRC_INTCOMP_COMPRESS_H
+#define DECOMPRESSOR_SRC_INTCOMP_COMPRESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "intcomp/CompressionFlags.h"
+
+namespace wasm {
+
+namespace intcomp {
+
+// Called with each sequence of compressed bytes, in order. Returns false if
+// unable to accept the bytes (which stops compression).
+typedef std::function<bool(const uint8_t* Buffer, size_t Size)>
+    CompressOutputFcn;
+
+// Compresses the WASM module in Input (of the given Size) using Flags,
+// passing the compressed bytes to Output. Returns true if successful.
+//
+// Note: Can be called from multiple threads, and calls run concurrently.
+// Trace events are recorded process wide, so at most one call records them
+// at a time.
+bool compressBuffer(const uint8_t* Input,
+                    size_t Size,
+                    const CompressionFlags& Flags,
+                    CompressOutputFcn Output);
+
+// Same as above, except that the compressed bytes are appended to Output.
+bool compressBuffer(const uint8_t* Input,
+                    size_t Size,
+                    const CompressionFlags& Flags,
+                    std::vector<uint8_t>& Output);
+
+}  // end of namespace intcomp
+
+}  // end of namespace wasm
+
+extern "C" {
+
+#define COMPRESSOR_SUCCESS (-1)
+#define COMPRESSOR_ERROR (-2)
+
+/* Called with each sequence of compressed bytes. Data is the value passed to
+ * compress_buffer(). Returns false if unable to accept the bytes.
+ */
+typedef bool (*compressor_output_fcn)(void* Data,
+                                      const uint8_t* Buffer,
+                                      int32_t Size);
+
+/* Returns allocated compression flags, initialized to their defaults. */
+extern void* create_compression_flags();
+
+/* Sets the minimum count and weight of patterns considered for abbreviating.
+ */
+extern void set_compression_cutoffs(void* Flags,
+                                    uint64_t CountCutoff,
+                                    uint64_t WeightCutoff);
+
+/* Toggles Huffman encoding of abbreviations. */
+extern void set_compression_huffman(void* Flags, bool NewValue);
+
+/* Toggles adaptive Huffman encoding of abbreviations (no code table is
+ * embedded in the output). Overrides set_compression_huffman. */
+extern void set_compression_adaptive(void* Flags, bool NewValue);
+
+/* Sets the time (in seconds) and memory (in megabytes) budgets for
+ * compressing. Zero means no limit.
+ */
+extern void set_compression_budget(void* Flags,
+                                   uint64_t TimeBudget,
+                                   uint64_t MemoryBudget);
+
+/* Records a trace-event timeline (in Chrome's JSON trace format) of each
+ * compression to Filename. Null (or empty) turns recording off.
+ */
+extern void set_compression_trace_events(void* Flags, const char* Filename);
+
+/* Toggles generating the compressed algorithm using the cism model (and
+ * whether opcodes are aligned).
+ */
+extern void set_compression_cism(void* Flags, bool UseCism, bool Align);
+
+/* Deallocates flags created by create_compression_flags(). */
+extern void destroy_compression_flags(void* Flags);
+
+/* Compresses the Size bytes in Input using Flags (or defaults if null),
+ * passing the compressed bytes to Output. Returns either COMPRESSOR_SUCCESS
+ * or COMPRESSOR_ERROR. May be called from multiple threads.
+ */
+extern int32_t compress_buffer(const uint8_t* Input,
+                               int32_t Size,
+                               const void* Flags,
+                               compressor_output_fcn Output,
+                               void* Data);
+}
+
+#endif  // DECOMPRESSOR_SRC_INTCOMP_COMPRESS_H
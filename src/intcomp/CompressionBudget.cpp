@@ -0,0 +1,158 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a (time and memory) budget for the compressor.
+
+#include "intcomp/CompressionBudget.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "utils/TraceEvents.h"
+
+namespace wasm {
+
+namespace intcomp {
+
+constexpr size_t CompressionBudget::MaxSelectEffort;
+
+CompressionBudget::CompressionBudget(size_t TimeLimit, size_t MemoryLimit)
+    : TimeLimit(TimeLimit),
+      MemoryLimit(MemoryLimit),
+      Start(ClockType::now()),
+      PhaseStart(Start),
+      PhaseName(nullptr),
+      PhaseAllotment(std::numeric_limits<double>::infinity()),
+      MinSelectEffort(0) {}
+
+CompressionBudget::~CompressionBudget() {}
+
+double CompressionBudget::secondsSince(ClockType::time_point Time) {
+  return std::chrono::duration<double>(ClockType::now() - Time).count();
+}
+
+void CompressionBudget::startPhase(charstring Name, double Share) {
+  endPhase();
+  PhaseName = Name;
+  PhaseStart = ClockType::now();
+  utils::TraceEvents::begin("compress", Name);
+  PhaseAllotment = hasTimeLimit() ? std::max(0.0, getTimeLeft()) * Share
+                                  : std::numeric_limits<double>::infinity();
+}
+
+void CompressionBudget::endPhase() {
+  if (PhaseName == nullptr)
+    return;
+  Phase P;
+  P.Name = PhaseName;
+  P.Seconds = getPhaseTimeUsed();
+  P.Memory = getMemoryUsed();
+  Phases.push_back(P);
+  PhaseName = nullptr;
+  utils::TraceEvents::end("compress");
+}
+
+double CompressionBudget::getTimeUsed() const {
+  return secondsSince(Start);
+}
+
+double CompressionBudget::getTimeLeft() const {
+  if (!hasTimeLimit())
+    return std::numeric_limits<double>::infinity();
+  return double(TimeLimit) - getTimeUsed();
+}
+
+double CompressionBudget::getFractionLeft() const {
+  if (!hasTimeLimit())
+    return 1.0;
+  return std::max(0.0, getTimeLeft() / double(TimeLimit));
+}
+
+double CompressionBudget::getPhaseTimeUsed() const {
+  return secondsSince(PhaseStart);
+}
+
+bool CompressionBudget::isPhaseOverTime() const {
+  return hasTimeLimit() && getPhaseTimeUsed() > PhaseAllotment;
+}
+
+size_t CompressionBudget::getMemoryUsed() const {
+  struct rusage Usage;
+  if (getrusage(RUSAGE_SELF, &Usage) != 0)
+    return 0;
+  // Note: ru_maxrss is in kilobytes.
+  return size_t(Usage.ru_maxrss) / 1024;
+}
+
+bool CompressionBudget::isOverMemory() const {
+  return hasMemoryLimit() && getMemoryUsed() >= MemoryLimit;
+}
+
+bool CompressionBudget::isTight() const {
+  return isOverMemory() || getFractionLeft() < 0.5;
+}
+
+size_t CompressionBudget::getSelectEffortLimit() {
+  // Don't limit the search while at least half of the time is left. Then
+  // shrink the search effort with the time left.
+  double Fraction = getFractionLeft();
+  if (Fraction >= 0.5)
+    return 0;
+  size_t Effort =
+      std::max(size_t(1), size_t(2 * Fraction * double(MaxSelectEffort)));
+  if (MinSelectEffort == 0 || Effort < MinSelectEffort) {
+    if (MinSelectEffort == 0)
+      noteLimit("abbreviation selection search effort bounded");
+    MinSelectEffort = Effort;
+  }
+  return Effort;
+}
+
+void CompressionBudget::noteLimit(const std::string& Description) {
+  Limits.push_back(Description);
+}
+
+void CompressionBudget::describe(FILE* Out) const {
+  fprintf(Out, "Compression budget:");
+  if (hasTimeLimit())
+    fprintf(Out, " %" PRIuMAX "s", uintmax_t(TimeLimit));
+  if (hasMemoryLimit())
+    fprintf(Out, " %" PRIuMAX "MB", uintmax_t(MemoryLimit));
+  if (!hasLimits())
+    fprintf(Out, " unlimited");
+  fprintf(Out, "\n");
+  for (const Phase& P : Phases)
+    fprintf(Out, "  %-24s %8.3fs %6" PRIuMAX "MB (peak)\n", P.Name, P.Seconds,
+            uintmax_t(P.Memory));
+  fprintf(Out, "  %-24s %8.3fs %6" PRIuMAX "MB (peak)\n", "total",
+          getTimeUsed(), uintmax_t(getMemoryUsed()));
+  if (Limits.empty()) {
+    fprintf(Out, "  No limits applied\n");
+    return;
+  }
+  fprintf(Out, "  Limits applied:\n");
+  for (const std::string& Limit : Limits)
+    fprintf(Out, "    %s\n", Limit.c_str());
+  if (MinSelectEffort != 0)
+    fprintf(Out, "    (minimum search effort: %" PRIuMAX " candidates)\n",
+            uintmax_t(MinSelectEffort));
+}
+
+}  // end of namespace intcomp
+
+}  // end of namespace wasm
@@ -0,0 +1,108 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a (time and memory) budget for the compressor. The compressor
+// consults the budget between (and during) its phases, and trades
+// compression for resources as the budget runs down. The budget also
+// records the resources used by each phase, and the limits that were
+// applied, so that they can be reported.
+
+#ifndef DECOMPRESSOR_SRC_INTCOMP_COMPRESSIONBUDGET_H
+#define DECOMPRESSOR_SRC_INTCOMP_COMPRESSIONBUDGET_H
+
+#include "utils/Defs.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace wasm {
+
+namespace intcomp {
+
+class CompressionBudget {
+  CompressionBudget() = delete;
+  CompressionBudget(const CompressionBudget&) = delete;
+  CompressionBudget& operator=(const CompressionBudget&) = delete;
+
+ public:
+  // Note: Zero means no limit. Time is in seconds, memory in megabytes.
+  CompressionBudget(size_t TimeLimit, size_t MemoryLimit);
+  ~CompressionBudget();
+
+  bool hasLimits() const { return TimeLimit > 0 || MemoryLimit > 0; }
+  bool hasTimeLimit() const { return TimeLimit > 0; }
+  bool hasMemoryLimit() const { return MemoryLimit > 0; }
+
+  // Starts the named phase, ending the current phase (if any). Share is
+  // the fraction of the remaining time the phase may use.
+  void startPhase(charstring Name, double Share = 1.0);
+  void endPhase();
+
+  // Seconds used since the budget was created.
+  double getTimeUsed() const;
+  // Seconds left in the budget (negative if overspent).
+  double getTimeLeft() const;
+  // Fraction of the time budget left (1.0 if no time limit).
+  double getFractionLeft() const;
+  // Seconds used by the current phase.
+  double getPhaseTimeUsed() const;
+  // True if the current phase has used up its share of time.
+  bool isPhaseOverTime() const;
+
+  // Peak memory (in megabytes) used by the process.
+  size_t getMemoryUsed() const;
+  bool isOverMemory() const;
+
+  // True if the compressor should give up some compression to stay in
+  // budget.
+  bool isTight() const;
+
+  // Returns the maximum number of candidates AbbrevSelector::select should
+  // expand, based on the time left (0 means no limit).
+  size_t getSelectEffortLimit();
+
+  // Records that a limit was applied.
+  void noteLimit(const std::string& Description);
+
+  void describe(FILE* Out) const;
+
+ private:
+  typedef std::chrono::steady_clock ClockType;
+  struct Phase {
+    charstring Name;
+    double Seconds;
+    size_t Memory;
+  };
+  static constexpr size_t MaxSelectEffort = 4096;
+  size_t TimeLimit;
+  size_t MemoryLimit;
+  ClockType::time_point Start;
+  ClockType::time_point PhaseStart;
+  charstring PhaseName;
+  double PhaseAllotment;
+  size_t MinSelectEffort;
+  std::vector<Phase> Phases;
+  std::vector<std::string> Limits;
+
+  static double secondsSince(ClockType::time_point Time);
+};
+
+}  // end of namespace intcomp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTCOMP_COMPRESSIONBUDGET_H
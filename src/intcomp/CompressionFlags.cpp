@@ -46,6 +46,7 @@ CompressionFlags::CompressionFlags()
       AbbrevFormat(IntTypeFormat::Varuint64),
       MinimizeCodeSize(true),
       UseHuffmanEncoding(true),
+      UseAdaptiveEncoding(false),
       TrimOverriddenPatterns(false),
       BitCompressOpcodes(false),
       ReassignAbbreviations(true),
@@ -54,6 +55,9 @@ CompressionFlags::CompressionFlags()
       DefaultFormat(IntTypeFormat::Varint64),
       LoopSizeFormat(IntTypeFormat::Varuint64),
       MatchSingletonsLast(false),
+      TimeBudget(0),
+      MemoryBudget(0),
+      NumReadThreads(1),
       TraceMatchSingletonsLast(false),
       TraceHuffmanAssignments(false),
       TraceReadingInput(false),
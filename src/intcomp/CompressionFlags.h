@@ -63,6 +63,9 @@ struct CompressionFlags {
   interp::IntTypeFormat AbbrevFormat;
   bool MinimizeCodeSize;
   bool UseHuffmanEncoding;
+  // When true, abbreviations are encoded using an adaptive Huffman model
+  // (rather than an embedded Huffman table). Overrides UseHuffmanEncoding.
+  bool UseAdaptiveEncoding;
   bool TrimOverriddenPatterns;
   bool BitCompressOpcodes;
   bool ReassignAbbreviations;
@@ -71,6 +74,17 @@ struct CompressionFlags {
   interp::IntTypeFormat DefaultFormat;
   interp::IntTypeFormat LoopSizeFormat;
   bool MatchSingletonsLast;
+  // Time (in seconds) and memory (in megabytes) budgets for compressing.
+  // Zero means no limit.
+  size_t TimeBudget;
+  size_t MemoryBudget;
+  // When non-empty, compressBuffer() records a trace-event timeline of the
+  // compression to this file.
+  std::string TraceEventsFilename;
+  // Number of threads used to read the function bodies of the input. One
+  // means read the input sequentially, and zero means use the number of
+  // hardware threads.
+  size_t NumReadThreads;
 
   interp::InterpreterFlags MyInterpFlags;
 
@@ -68,7 +68,7 @@ HuffmanEncoder::NodePtr CountNode::assignAbbreviations(
     Heap->pop();
     Nd->setAbbrevIndex(Encoder.createSymbol(Nd->getCount()));
   }
-  if (!Flags.UseHuffmanEncoding)
+  if (!Flags.UseHuffmanEncoding || Flags.UseAdaptiveEncoding)
     return HuffmanEncoder::NodePtr();
   return Encoder.encodeSymbols();
 }
@@ -126,6 +126,12 @@ decode::IntType CountNode::getAbbrevIndex() const {
   return AbbrevSymbol->getPath();
 }
 
+size_t CountNode::getAbbrevNumBits() const {
+  if (!AbbrevSymbol)
+    return 0;
+  return AbbrevSymbol->getNumBits();
+}
+
 bool CountNode::hasAbbrevIndex() const {
   return bool(AbbrevSymbol);
 }
@@ -148,7 +154,8 @@ CountNode::IntPtr lookup(CountNode::RootPtr Root,
   if (!AddIfNotFound)
     return CountNode::IntPtr();
 
-  Succ = std::make_shared<SingletonCountNode>(Value);
+  Succ = std::allocate_shared<SingletonCountNode>(
+      alloc::HugePageAllocator<SingletonCountNode>(), Value);
   Root->Successors[Value] = Succ;
   return Succ;
 }
@@ -163,7 +170,8 @@ CountNode::IntPtr lookup(CountNode::IntPtr Nd,
   if (!AddIfNotFound)
     return CountNode::IntPtr();
 
-  Succ = std::make_shared<IntSeqCountNode>(Value, Nd);
+  Succ = std::allocate_shared<IntSeqCountNode>(
+      alloc::HugePageAllocator<IntSeqCountNode>(), Value, Nd);
   Nd->Successors[Value] = Succ;
   return Succ;
 }
@@ -24,6 +24,7 @@
 #include <set>
 
 #include "intcomp/CompressionFlags.h"
+#include "utils/HugePages.h"
 #include "utils/HuffmanEncoding.h"
 #include "utils/heap.h"
 
@@ -57,7 +58,12 @@ class CountNode : public std::enable_shared_from_this<CountNode> {
   typedef std::weak_ptr<IntCountNode> ParentPtr;
   typedef std::shared_ptr<RootCountNode> RootPtr;
   typedef std::shared_ptr<CountNodeWithSuccs> WithSuccsPtr;
-  typedef std::map<decode::IntType, CountNode::IntPtr> SuccMap;
+  typedef std::map<
+      decode::IntType,
+      CountNode::IntPtr,
+      std::less<decode::IntType>,
+      alloc::HugePageAllocator<std::pair<const decode::IntType, IntPtr>>>
+      SuccMap;
   typedef std::vector<Ptr> PtrVector;
   typedef std::set<Ptr> PtrSet;
   typedef std::map<size_t, Ptr> Int2PtrMap;
@@ -0,0 +1,146 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements snapshots of a count trie.
+
+#include "intcomp/CountSnapshot.h"
+
+#include <iterator>
+
+namespace wasm {
+
+using namespace decode;
+
+namespace intcomp {
+
+namespace {
+
+constexpr uint64_t SnapshotMagic = 0x746e6377;  // "wcnt"
+constexpr uint64_t SnapshotVersion = 1;
+
+// Guards against malformed (or hostile) snapshots blowing the stack.
+constexpr size_t MaxPatternDepth = 1024;
+
+}  // end of anonymous namespace
+
+CountSnapshot::CountSnapshot(CountNode::RootPtr Root)
+    : Root(Root), File(nullptr) {}
+
+CountSnapshot::~CountSnapshot() {}
+
+void CountSnapshot::writeUint(uint64_t Value) {
+  do {
+    uint8_t Byte = Value & 0x7f;
+    Value >>= 7;
+    if (Value)
+      Byte |= 0x80;
+    fputc(Byte, File);
+  } while (Value);
+}
+
+bool CountSnapshot::readUint(uint64_t& Value) {
+  Value = 0;
+  for (unsigned Shift = 0; Shift < 64; Shift += 7) {
+    int Byte = fgetc(File);
+    if (Byte == EOF)
+      return false;
+    // Note: Only the low bit of the tenth byte fits, and it must be the
+    // last byte.
+    if (Shift == 63 && (Byte & 0xfe) != 0)
+      return false;
+    Value |= uint64_t(Byte & 0x7f) << Shift;
+    if ((Byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+void CountSnapshot::writeSuccs(const CountNodeWithSuccs* Nd) {
+  writeUint(std::distance(Nd->begin(), Nd->end()));
+  for (const auto& Pair : *Nd) {
+    writeUint(Pair.first);
+    writeUint(Pair.second->getCount());
+    writeSuccs(Pair.second.get());
+  }
+}
+
+bool CountSnapshot::write(charstring Filename) {
+  File = fopen(Filename, "wb");
+  if (File == nullptr)
+    return false;
+  writeUint(SnapshotMagic);
+  writeUint(SnapshotVersion);
+  writeUint(Root->getCount());
+  writeUint(Root->getBlockEnter()->getCount());
+  writeUint(Root->getBlockExit()->getCount());
+  writeUint(Root->getDefaultSingle()->getCount());
+  writeUint(Root->getDefaultMultiple()->getCount());
+  writeUint(Root->getAlign()->getCount());
+  writeSuccs(Root.get());
+  bool Okay = !ferror(File);
+  if (fclose(File) != 0)
+    Okay = false;
+  File = nullptr;
+  return Okay;
+}
+
+bool CountSnapshot::mergeCount(CountNode::Ptr Nd) {
+  uint64_t Count;
+  if (!readUint(Count))
+    return false;
+  Nd->increment(Count);
+  return true;
+}
+
+bool CountSnapshot::mergeSuccs(CountNode::IntPtr Nd, size_t Depth) {
+  if (Depth > MaxPatternDepth)
+    return false;
+  uint64_t NumSuccs;
+  if (!readUint(NumSuccs))
+    return false;
+  for (uint64_t i = 0; i < NumSuccs; ++i) {
+    uint64_t Value;
+    if (!readUint(Value))
+      return false;
+    CountNode::IntPtr Succ = Nd ? lookup(Nd, Value) : lookup(Root, Value);
+    if (!mergeCount(Succ) || !mergeSuccs(Succ, Depth + 1))
+      return false;
+  }
+  return true;
+}
+
+bool CountSnapshot::merge(charstring Filename) {
+  File = fopen(Filename, "rb");
+  if (File == nullptr)
+    return false;
+  uint64_t Magic;
+  uint64_t Version;
+  bool Okay = readUint(Magic) && Magic == SnapshotMagic &&
+              readUint(Version) && Version == SnapshotVersion &&
+              mergeCount(Root) && mergeCount(Root->getBlockEnter()) &&
+              mergeCount(Root->getBlockExit()) &&
+              mergeCount(Root->getDefaultSingle()) &&
+              mergeCount(Root->getDefaultMultiple()) &&
+              mergeCount(Root->getAlign()) &&
+              mergeSuccs(CountNode::IntPtr(), 0) && fgetc(File) == EOF;
+  fclose(File);
+  File = nullptr;
+  return Okay;
+}
+
+}  // end of namespace intcomp
+
+}  // end of namespace wasm
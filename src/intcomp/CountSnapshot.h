@@ -0,0 +1,66 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines snapshots of a count trie. Snapshots are written to (compact)
+// files so that counts collected by separate processes can be merged, and
+// then used to drive abbreviation assignment.
+//
+// A snapshot file consists of a magic number and version, followed by the
+// counts of the (non-integer) root nodes, followed by the integer trie. Each
+// trie node is written as the number of successors, followed by (value,
+// count, successors) of each successor. All integers are written as LEB128.
+
+#ifndef DECOMPRESSOR_SRC_INTCOMP_COUNTSNAPSHOT_H
+#define DECOMPRESSOR_SRC_INTCOMP_COUNTSNAPSHOT_H
+
+#include "intcomp/CountNode.h"
+
+namespace wasm {
+
+namespace intcomp {
+
+class CountSnapshot {
+  CountSnapshot() = delete;
+  CountSnapshot(const CountSnapshot&) = delete;
+  CountSnapshot& operator=(const CountSnapshot&) = delete;
+
+ public:
+  explicit CountSnapshot(CountNode::RootPtr Root);
+  ~CountSnapshot();
+
+  // Writes the trie to the given file. Returns false if unable to.
+  bool write(charstring Filename);
+
+  // Adds the counts in the snapshot file into the trie. Returns false
+  // if the file is malformed.
+  bool merge(charstring Filename);
+
+ private:
+  CountNode::RootPtr Root;
+  FILE* File;
+
+  void writeUint(uint64_t Value);
+  void writeSuccs(const CountNodeWithSuccs* Nd);
+  bool readUint(uint64_t& Value);
+  bool mergeSuccs(CountNode::IntPtr Nd, size_t Depth);
+  bool mergeCount(CountNode::Ptr Nd);
+};
+
+}  // end of namespace intcomp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTCOMP_COUNTSNAPSHOT_H
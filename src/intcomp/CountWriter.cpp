@@ -26,8 +26,21 @@ namespace intcomp {
 using namespace decode;
 using namespace filt;
 
+namespace {
+
+// Number of integers to count between budget checks.
+constexpr size_t BudgetCheckInterval = 4096;
+
+}  // end of anonymous namespace
+
 CountWriter::CountWriter(CountNode::RootPtr Root)
-    : Writer(true), Root(Root), CountCutoff(1), UpToSize(0) {}
+    : Writer(true),
+      Root(Root),
+      CountCutoff(1),
+      UpToSize(0),
+      Budget(nullptr),
+      NextBudgetCheck(BudgetCheckInterval),
+      StoppedEarly(false) {}
 
 CountWriter::~CountWriter() {}
 
@@ -36,6 +49,16 @@ StreamType CountWriter::getStreamType() const {
 }
 
 void CountWriter::addToUsageMap(IntType Value) {
+  if (StoppedEarly)
+    return;
+  if (Budget && --NextBudgetCheck == 0) {
+    NextBudgetCheck = BudgetCheckInterval;
+    if (Budget->isOverMemory() || Budget->isPhaseOverTime()) {
+      StoppedEarly = true;
+      Frontier.clear();
+      return;
+    }
+  }
   CountNode::IntPtr TopNd = lookup(Root, Value);
   if (UpToSize == 1) {
     TopNd->increment();
@@ -20,6 +20,7 @@
 #ifndef DECOMPRESSOR_SRC_INTCOMP_COUNTWRITER_H
 #define DECOMPRESSOR_SRC_INTCOMP_COUNTWRITER_H
 
+#include "intcomp/CompressionBudget.h"
 #include "intcomp/CountNode.h"
 #include "interp/Writer.h"
 
@@ -55,6 +56,11 @@ class CountWriter : public interp::Writer {
   void resetUpToSize() { UpToSize = 0; }
   size_t getUpToSize() const { return UpToSize; }
 
+  // When set, stops collecting integer sequences once the budget (memory,
+  // or time allotted to the current phase) is used up.
+  void setBudget(CompressionBudget* NewBudget) { Budget = NewBudget; }
+  bool stoppedEarly() const { return StoppedEarly; }
+
   void addToUsageMap(decode::IntType Value);
 
   decode::StreamType getStreamType() const OVERRIDE;
@@ -69,6 +75,9 @@ class CountWriter : public interp::Writer {
   IntFrontier Frontier;
   uint64_t CountCutoff;
   size_t UpToSize;
+  CompressionBudget* Budget;
+  size_t NextBudgetCheck;
+  bool StoppedEarly;
 };
 
 }  // end of namespace intcomp
@@ -22,7 +22,9 @@
 #include "intcomp/AbbrevAssignWriter.h"
 #include "intcomp/AbbreviationCodegen.h"
 #include "intcomp/AbbreviationsCollector.h"
+#include "intcomp/CountSnapshot.h"
 #include "intcomp/CountWriter.h"
+#include "intcomp/ParallelInputReader.h"
 #include "intcomp/RemoveNodesVisitor.h"
 #include "interp/ByteReader.h"
 #include "interp/ByteWriter.h"
@@ -30,7 +32,10 @@
 #include "interp/IntReader.h"
 #include "interp/Interpreter.h"
 #include "sexp/TextWriter.h"
+#include "stream/ArrayReader.h"
+#include "stream/ReadBackedQueue.h"
 #include "utils/ArgsParse.h"
+#include "utils/TraceEvents.h"
 
 namespace wasm {
 
@@ -49,7 +54,9 @@ IntCompressor::IntCompressor(std::shared_ptr<decode::Queue> Input,
     : Input(Input),
       Output(Output),
       MyFlags(MyFlags),
+      Budget(MyFlags.TimeBudget, MyFlags.MemoryBudget),
       Symtab(Symtab),
+      SnapshotOutput(nullptr),
       ErrorsFound(false) {
   if (MyFlags.TraceCompression)
     setTraceProgress(true);
@@ -73,6 +80,29 @@ CountNode::RootPtr IntCompressor::getRoot() {
 
 void IntCompressor::readInput() {
   Contents = std::make_shared<IntStream>();
+  // Note: Bytes must outlive the (buffered) input.
+  std::vector<uint8_t> Bytes;
+  if (MyFlags.NumReadThreads != 1 && !MyFlags.TraceReadingInput &&
+      !MyFlags.MyInterpFlags.TraceProgress) {
+    // Buffer the input, since it is split before being read.
+    AddressType Address = 0;
+    uint8_t Buffer[4096];
+    while (AddressType Count = Input->read(Address, Buffer, sizeof(Buffer)))
+      Bytes.insert(Bytes.end(), Buffer, Buffer + Count);
+    ParallelInputReader Reader(Symtab, MyFlags.MyInterpFlags,
+                               MyFlags.NumReadThreads);
+    if (Reader.split(Bytes)) {
+      TRACE(size_t, "Function bodies read in parallel",
+            Reader.getNumFunctionBodies());
+      if (!Reader.read(Contents))
+        ErrorsFound = true;
+      Input.reset();
+      return;
+    }
+    // Not a layout that can be split, read sequentially.
+    Input = std::make_shared<ReadBackedQueue>(
+        std::make_shared<ArrayReader>(Bytes.data(), Bytes.size()));
+  }
   auto MyWriter = std::make_shared<IntWriter>(Contents);
   Interpreter MyReader(std::make_shared<ByteReader>(Input), MyWriter,
                        MyFlags.MyInterpFlags, Symtab);
@@ -89,6 +119,7 @@ void IntCompressor::readInput() {
 const BitWriteCursor IntCompressor::writeCodeOutput(
     std::shared_ptr<SymbolTable> Symtab) {
   TRACE_METHOD("writeCodeOutput");
+  TraceEventSpan Span("compress", "CasmWriter output");
   CasmWriter Writer;
   return Writer.setTraceWriter(MyFlags.TraceWritingCodeOutput)
       .setTraceTree(MyFlags.TraceWritingCodeOutput)
@@ -101,6 +132,7 @@ const BitWriteCursor IntCompressor::writeCodeOutput(
 void IntCompressor::writeDataOutput(const BitWriteCursor& StartPos,
                                     std::shared_ptr<SymbolTable> Symtab) {
   TRACE_METHOD("writeDataOutput");
+  TraceEventSpan Span("compress", "data output");
   auto Writer = std::make_shared<ByteWriter>(Output);
   Writer->setPos(StartPos);
   InterpreterFlags InterpFlags = MyFlags.MyInterpFlags;
@@ -130,12 +162,16 @@ bool IntCompressor::compressUpToSize(size_t Size) {
   auto Writer = std::make_shared<CountWriter>(getRoot());
   Writer->setCountCutoff(MyFlags.CountCutoff);
   Writer->setUpToSize(Size);
+  if (Size > 1 && Budget.hasLimits())
+    Writer->setBudget(&Budget);
 
   IntInterpreter Reader(std::make_shared<IntReader>(Contents), Writer,
                         MyFlags.MyInterpFlags, Symtab);
   if (MyFlags.TraceReadingIntStream)
     Reader.getTrace().setTraceProgress(true);
   Reader.structuralRead();
+  if (Writer->stoppedEarly())
+    Budget.noteLimit("collecting integer sequences stopped early");
   return !Reader.errorsFound();
 }
 
@@ -153,6 +189,7 @@ void IntCompressor::removeSmallUsageCounts(bool KeepSingletonsUsingCount,
 void IntCompressor::compress() {
   TRACE_METHOD("compress");
   TRACE_MESSAGE("Reading input");
+  Budget.startPhase("read input");
   readInput();
   if (errorsFound()) {
     fprintf(stderr, "Unable to decompress, input malformed");
@@ -161,31 +198,27 @@ void IntCompressor::compress() {
   TRACE(size_t, "Number of integers in input", Contents->getNumIntegers());
   if (MyFlags.TraceInputIntStream)
     Contents->describe(stderr, "Input int stream");
-  // Start by collecting number of occurrences of each integer, so
-  // that we can use as a filter on integer sequence inclusion into the
-  // trie.
-  if (!compressUpToSize(1))
-    return;
-  removeSmallSingletonUsageCounts();
-  if (MyFlags.TraceIntCounts)
-    describeCutoff(stderr, MyFlags.CountCutoff,
-                   makeFlags(CollectionFlag::TopLevel),
-                   MyFlags.TraceIntCountsCollection);
-  if (MyFlags.PatternLengthLimit > 1) {
-    if (!compressUpToSize(MyFlags.PatternLengthLimit))
+  if (SnapshotInputs.empty()) {
+    if (!collectCounts())
       return;
-    removeAllSmallUsageCounts();
-    if (MyFlags.TraceSequenceCounts)
-      describeCutoff(stderr, MyFlags.WeightCutoff,
-                     makeFlags(CollectionFlag::IntPaths),
-                     MyFlags.TraceSequenceCountsCollection);
+  } else if (!mergeCountSnapshots()) {
+    return;
+  }
+  if (SnapshotOutput != nullptr) {
+    TRACE_MESSAGE("Writing count snapshot");
+    if (!CountSnapshot(getRoot()).write(SnapshotOutput)) {
+      fprintf(stderr, "Unable to write count snapshot: %s\n", SnapshotOutput);
+      ErrorsFound = true;
+    }
+    return;
   }
   TRACE_MESSAGE("Assigning (initial) abbreviations to integer sequences");
+  Budget.startPhase("assign abbreviations");
   // SInce we don't actually know the number of times default patterns will
   // be used, assume a large number.
   Root->getDefaultSingle()->setCount(100);
   Root->getDefaultMultiple()->setCount(100);
-  if (MyFlags.UseHuffmanEncoding)
+  if (MyFlags.UseHuffmanEncoding || MyFlags.UseAdaptiveEncoding)
     // Assume an alignment added at end of file.
     Root->getAlign()->setCount(1);
   CountNode::PtrSet AbbrevAssignments;
@@ -196,6 +229,7 @@ void IntCompressor::compress() {
                           MyFlags.TraceAbbreviationAssignmentsCollection);
   IntOutput = std::make_shared<IntStream>();
   TRACE_MESSAGE("Generating compressed integer stream");
+  Budget.startPhase("select abbreviations");
   if (!generateIntOutput(AbbrevAssignments))
     return;
   TRACE(size_t, "Number of integers in compressed output",
@@ -203,6 +237,7 @@ void IntCompressor::compress() {
   if (MyFlags.TraceCompressedIntOutput)
     IntOutput->describe(stderr, "Output int stream");
   TRACE_MESSAGE("Appending compression algorithm to output");
+  Budget.startPhase("write output");
   const BitWriteCursor Pos =
       writeCodeOutput(generateCodeForReading(AbbrevAssignments));
   if (errorsFound()) {
@@ -212,12 +247,91 @@ void IntCompressor::compress() {
   TRACE(size_t, "Pos after code", Pos.getAddress());
   TRACE_MESSAGE("Appending compressed WASM file to output");
   writeDataOutput(Pos, generateCodeForWriting(AbbrevAssignments));
+  Budget.endPhase();
   if (errorsFound()) {
     fprintf(stderr, "Unable to compress, output malformed\n");
     return;
   }
 }
 
+bool IntCompressor::collectCounts() {
+  // Start by collecting number of occurrences of each integer, so
+  // that we can use as a filter on integer sequence inclusion into the
+  // trie.
+  Budget.startPhase("count integers");
+  if (!compressUpToSize(1))
+    return false;
+  removeSmallSingletonUsageCounts();
+  limitPatternLength();
+  if (MyFlags.TraceIntCounts)
+    describeCutoff(stderr, MyFlags.CountCutoff,
+                   makeFlags(CollectionFlag::TopLevel),
+                   MyFlags.TraceIntCountsCollection);
+  if (MyFlags.PatternLengthLimit > 1) {
+    // Leave (at least) half of the remaining time for the later phases.
+    Budget.startPhase("count sequences", 0.5);
+    if (!compressUpToSize(MyFlags.PatternLengthLimit))
+      return false;
+    Budget.startPhase("prune counts");
+    raiseCutoffsIfTight();
+    removeAllSmallUsageCounts();
+    if (MyFlags.TraceSequenceCounts)
+      describeCutoff(stderr, MyFlags.WeightCutoff,
+                     makeFlags(CollectionFlag::IntPaths),
+                     MyFlags.TraceSequenceCountsCollection);
+  }
+  return true;
+}
+
+void IntCompressor::limitPatternLength() {
+  if (!Budget.hasLimits() || MyFlags.PatternLengthLimit <= 1)
+    return;
+  size_t Limit = MyFlags.PatternLengthLimit;
+  if (Budget.isOverMemory()) {
+    Limit = 1;
+  } else if (Budget.hasTimeLimit()) {
+    // Collecting sequences of (up to) length N costs roughly N times
+    // collecting integers. Fit it into half of the remaining time.
+    double PerInt = Budget.getPhaseTimeUsed();
+    double Available = 0.5 * Budget.getTimeLeft();
+    while (Limit > 1 && double(Limit) * PerInt > Available)
+      --Limit;
+  }
+  if (Limit == MyFlags.PatternLengthLimit)
+    return;
+  Budget.noteLimit("pattern length limit reduced from " +
+                   std::to_string(MyFlags.PatternLengthLimit) + " to " +
+                   std::to_string(Limit));
+  MyFlags.PatternLengthLimit = Limit;
+}
+
+void IntCompressor::raiseCutoffsIfTight() {
+  if (!Budget.hasLimits() || !Budget.isTight())
+    return;
+  // Fewer (trie) nodes means less memory, and less effort when assigning
+  // and selecting abbreviations.
+  MyFlags.CountCutoff = std::max(MyFlags.CountCutoff * 2, size_t(2));
+  MyFlags.WeightCutoff = std::max(MyFlags.WeightCutoff * 2, size_t(2));
+  Budget.noteLimit("count/weight cutoffs raised to " +
+                   std::to_string(MyFlags.CountCutoff) + "/" +
+                   std::to_string(MyFlags.WeightCutoff));
+}
+
+bool IntCompressor::mergeCountSnapshots() {
+  TRACE_METHOD("mergeCountSnapshots");
+  CountSnapshot Snapshot(getRoot());
+  for (charstring Filename : SnapshotInputs) {
+    TRACE(string, "Snapshot", Filename);
+    if (!Snapshot.merge(Filename)) {
+      fprintf(stderr, "Unable to read count snapshot: %s\n", Filename);
+      ErrorsFound = true;
+      return false;
+    }
+  }
+  removeAllSmallUsageCounts();
+  return true;
+}
+
 void IntCompressor::assignInitialAbbreviations(CountNode::PtrSet& Assignments) {
   AbbreviationsCollector Collector(getRoot(), Assignments, MyFlags);
   if (MyFlags.TraceAssigningAbbreviations && hasTrace())
@@ -232,7 +346,11 @@ bool IntCompressor::generateIntOutput(CountNode::PtrSet& Assignments) {
   auto Writer = std::make_shared<AbbrevAssignWriter>(
       Root, Assignments, EncodingRoot, IntOutput,
       MyFlags.PatternLengthLimit * MyFlags.PatternLengthMultiplier,
-      !MyFlags.UseHuffmanEncoding, MyFlags);
+      !MyFlags.UseHuffmanEncoding && !MyFlags.UseAdaptiveEncoding, MyFlags);
+  if (AbbrevUsage)
+    Writer->setReport(AbbrevUsage);
+  if (Budget.hasTimeLimit())
+    Writer->setBudget(&Budget);
   IntInterpreter Interp(std::make_shared<IntReader>(Contents), Writer,
                         MyFlags.MyInterpFlags, Symtab);
   if (MyFlags.TraceIntStreamGeneration)
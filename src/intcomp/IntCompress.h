@@ -20,6 +20,7 @@
 #define DECOMPRESSOR_SRC_INTCOMP_INTCOMPRESS_H
 
 #include "intcomp/AbbrevAssignWriter.h"
+#include "intcomp/CompressionBudget.h"
 #include "intcomp/CompressionFlags.h"
 #include "intcomp/CountNode.h"
 #include "interp/IntFormats.h"
@@ -90,18 +91,50 @@ class IntCompressor FINAL {
 
   void describeAbbreviations(FILE* Out, bool Trace = false);
 
+  // When set, the (pruned) count trie is written to Filename, instead of
+  // compressing the input.
+  void setCountSnapshotOutput(charstring Filename) {
+    SnapshotOutput = Filename;
+  }
+
+  // When added, counts are merged from the snapshot files rather than
+  // collected from the input.
+  void addCountSnapshotInput(charstring Filename) {
+    SnapshotInputs.push_back(Filename);
+  }
+
+  // When set, collects usage of the assigned abbreviations in the
+  // compressed output.
+  void setAbbrevReport(std::shared_ptr<AbbrevReport> Report) {
+    AbbrevUsage = Report;
+  }
+
+  // Describes the resources used by each phase, and the limits applied to
+  // stay within the time/memory budget.
+  void describeBudget(FILE* Out) const { Budget.describe(Out); }
+
  private:
   std::shared_ptr<RootCountNode> Root;
   utils::HuffmanEncoder::NodePtr EncodingRoot;
   std::shared_ptr<decode::Queue> Input;
   std::shared_ptr<decode::Queue> Output;
-  const CompressionFlags& MyFlags;
+  // Note: A copy, since knobs are adjusted to stay within Budget.
+  CompressionFlags MyFlags;
+  CompressionBudget Budget;
   std::shared_ptr<filt::SymbolTable> Symtab;
   std::shared_ptr<interp::IntStream> Contents;
   std::shared_ptr<interp::IntStream> IntOutput;
   std::shared_ptr<utils::TraceClass> Trace;
+  std::shared_ptr<AbbrevReport> AbbrevUsage;
+  charstring SnapshotOutput;
+  std::vector<charstring> SnapshotInputs;
   bool ErrorsFound;
   void readInput();
+  bool collectCounts();
+  // Adjust knobs (in MyFlags) to stay within the budget.
+  void limitPatternLength();
+  void raiseCutoffsIfTight();
+  bool mergeCountSnapshots();
   const decode::BitWriteCursor writeCodeOutput(
       std::shared_ptr<filt::SymbolTable> Symtab);
   void writeDataOutput(const decode::BitWriteCursor& StartPos,
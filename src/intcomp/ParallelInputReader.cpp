@@ -0,0 +1,274 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a reader that builds the integer stream of a WASM file, reading
+// the function bodies of the code section on multiple threads.
+
+#include "intcomp/ParallelInputReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "interp/ByteReader.h"
+#include "interp/IntWriter.h"
+#include "interp/Interpreter.h"
+#include "sexp/Ast.h"
+#include "stream/ArrayReader.h"
+#include "stream/ReadBackedQueue.h"
+#include "utils/TraceEvents.h"
+
+namespace wasm {
+
+using namespace decode;
+using namespace filt;
+using namespace interp;
+using namespace utils;
+
+namespace intcomp {
+
+namespace {
+
+// Note: The read header of the WASM algorithm is two u32 constants.
+constexpr size_t WasmHeaderSize = 8;
+constexpr uint32_t WasmHeader[] = {WasmBinaryMagic, WasmBinaryVersionD};
+
+constexpr uint32_t CodeSectionCode =
+    uint32_t(Interpreter::SectionCode::Code);
+
+bool readVaruint32(const std::vector<uint8_t>& Bytes,
+                   size_t& Pos,
+                   size_t End,
+                   uint32_t& Value) {
+  Value = 0;
+  for (uint32_t Shift = 0; Shift < 35; Shift += 7) {
+    if (Pos >= End)
+      return false;
+    uint8_t Byte = Bytes[Pos++];
+    Value |= uint32_t(Byte & 0x7f) << Shift;
+    if ((Byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+uint32_t readUint32(const std::vector<uint8_t>& Bytes, size_t Pos) {
+  uint32_t Value = 0;
+  for (size_t i = sizeof(uint32_t); i > 0; --i)
+    Value = (Value << 8) | Bytes[Pos + i - 1];
+  return Value;
+}
+
+// Returns true if Symtab reads WASM 0xd files. The section and function
+// body framing used to split the input is only known for this version.
+bool readsWasm0xd(const SymbolTable& Symtab) {
+  const Header* ReadHeader = Symtab.getReadHeader();
+  if (ReadHeader == nullptr ||
+      size_t(ReadHeader->getNumKids()) != size(WasmHeader))
+    return false;
+  for (size_t i = 0; i < size(WasmHeader); ++i) {
+    const Node* Kid = ReadHeader->getKid(i);
+    if (Kid->getType() != NodeType::U32Const ||
+        cast<U32Const>(Kid)->getValue() != WasmHeader[i])
+      return false;
+  }
+  return true;
+}
+
+// Installs the deferred defines of Symtab (and its enclosing scopes), so
+// that all define frames exist, and all call sites are bound.
+bool installDeferredDefines(SymbolTable& Symtab) {
+  for (SymbolTable* Scope = &Symtab; Scope != nullptr;
+       Scope = Scope->getEnclosingScope().get()) {
+    const Algorithm* Alg = Scope->getAlgorithm();
+    if (Alg == nullptr)
+      continue;
+    for (const Node* Kid : *Alg) {
+      const auto* Def = dyn_cast<Define>(Kid);
+      if (Def != nullptr && Def->needsInstall() &&
+          !Scope->installDefinition(Def))
+        return false;
+    }
+  }
+  return true;
+}
+
+}  // end of anonymous namespace
+
+ParallelInputReader::ParallelInputReader(std::shared_ptr<SymbolTable> Symtab,
+                                         const InterpreterFlags& Flags,
+                                         size_t NumThreads)
+    : Symtab(Symtab),
+      Flags(Flags),
+      NumThreads(NumThreads),
+      Bytes(nullptr),
+      FileDefn(nullptr),
+      BodyDefn(nullptr),
+      Prefix(0, 0),
+      Suffix(0, 0) {
+  if (this->NumThreads == 0)
+    this->NumThreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+ParallelInputReader::~ParallelInputReader() {}
+
+bool ParallelInputReader::split(const std::vector<uint8_t>& Input) {
+  Bytes = &Input;
+  Bodies.clear();
+  if (!readsWasm0xd(*Symtab) || Input.size() < WasmHeaderSize ||
+      readUint32(Input, 0) != WasmHeader[0] ||
+      readUint32(Input, sizeof(uint32_t)) != WasmHeader[1])
+    return false;
+  Symbol* File = Symtab->getPredefined(PredefinedSymbol::File);
+  FileDefn = File ? Symtab->getSymbolDefn(File)->getDefineDefinition()
+                  : nullptr;
+  Symbol* Body = Symtab->getSymbol("function.body");
+  BodyDefn =
+      Body ? Symtab->getSymbolDefn(Body)->getDefineDefinition() : nullptr;
+  // The interpreters share the symbol table, so complete the install now
+  // rather than when the interpreters first evaluate a define.
+  if (FileDefn == nullptr || BodyDefn == nullptr ||
+      !installDeferredDefines(*Symtab))
+    return false;
+
+  // Find the code section.
+  size_t End = Input.size();
+  size_t Pos = WasmHeaderSize;
+  while (Pos < End) {
+    size_t SectionBegin = Pos;
+    uint32_t Code;
+    uint32_t Size;
+    if (!readVaruint32(Input, Pos, End, Code) ||
+        !readVaruint32(Input, Pos, End, Size) || Size > End - Pos)
+      return false;
+    if (Code != CodeSectionCode) {
+      Pos += Size;
+      continue;
+    }
+    size_t SectionEnd = Pos + Size;
+    uint32_t NumBodies;
+    if (!readVaruint32(Input, Pos, SectionEnd, NumBodies))
+      return false;
+    Bodies.reserve(NumBodies);
+    for (uint32_t i = 0; i < NumBodies; ++i) {
+      // Note: Each body includes its size, since it is read by the block of
+      // 'function.body'.
+      size_t BodyBegin = Pos;
+      uint32_t BodySize;
+      if (!readVaruint32(Input, Pos, SectionEnd, BodySize) ||
+          BodySize > SectionEnd - Pos)
+        return false;
+      Pos += BodySize;
+      Bodies.emplace_back(BodyBegin, Pos);
+    }
+    if (Pos != SectionEnd)
+      return false;
+    Prefix = Range(0, SectionBegin);
+    Suffix = Range(SectionEnd, End);
+    return true;
+  }
+  return false;
+}
+
+std::unique_ptr<Interpreter> ParallelInputReader::createReader() {
+  // Note: The input and output are set for each part read, so that the
+  // interpreter (and its stacks) can be reused.
+  return make_unique<Interpreter>(std::shared_ptr<Reader>(),
+                                  std::shared_ptr<Writer>(), Flags, Symtab);
+}
+
+bool ParallelInputReader::readRange(Interpreter& MyReader,
+                                    const Range& R,
+                                    const Define* Defn,
+                                    std::shared_ptr<IntStream> Contents) {
+  auto Input = std::make_shared<ReadBackedQueue>(
+      std::make_shared<ArrayReader>(Bytes->data() + R.Begin, R.End - R.Begin));
+  MyReader.setInput(std::make_shared<ByteReader>(Input));
+  MyReader.setWriter(std::make_shared<IntWriter>(Contents));
+  if (Defn == nullptr) {
+    // Note: Eof is frozen after splicing.
+    MyReader.setFreezeEofAtExit(false);
+    MyReader.algorithmRead();
+  } else {
+    MyReader.algorithmReadDefine(Defn);
+  }
+  return MyReader.isFinished() && MyReader.isSuccessful();
+}
+
+bool ParallelInputReader::read(std::shared_ptr<IntStream> Contents) {
+  TraceEventSpan Span("compress", "parallel read");
+  std::vector<std::shared_ptr<IntStream>> BodyContents;
+  BodyContents.reserve(Bodies.size());
+  for (size_t i = 0; i < Bodies.size(); ++i)
+    BodyContents.push_back(std::make_shared<IntStream>());
+  std::atomic<size_t> NextBody(0);
+  std::atomic<bool> BodiesRead(true);
+  auto ReadBodies = [&]() {
+    TraceEvents::setThreadName("function body reader");
+    std::unique_ptr<Interpreter> MyReader = createReader();
+    size_t Index;
+    while ((Index = NextBody.fetch_add(1)) < Bodies.size()) {
+      if (!BodiesRead.load(std::memory_order_relaxed))
+        return;
+      TraceEventSpan BodySpan("compress", "read function body");
+      if (!readRange(*MyReader, Bodies[Index], BodyDefn,
+                     BodyContents[Index]))
+        BodiesRead = false;
+    }
+  };
+  std::vector<std::thread> Threads;
+  size_t NumWorkers = std::min(NumThreads, Bodies.size());
+  for (size_t i = 0; i < NumWorkers; ++i)
+    Threads.emplace_back(ReadBodies);
+
+  // Read the remaining sections while the function bodies are being read.
+  auto PrefixContents = std::make_shared<IntStream>();
+  auto SuffixContents = std::make_shared<IntStream>();
+  std::unique_ptr<Interpreter> MyReader = createReader();
+  bool Successful =
+      readRange(*MyReader, Prefix, nullptr, PrefixContents) &&
+      readRange(*MyReader, Suffix, FileDefn, SuffixContents);
+  if (!Successful)
+    BodiesRead = false;
+  for (std::thread& Thread : Threads)
+    Thread.join();
+  if (!Successful || !BodiesRead)
+    return false;
+
+  // Splice together the parts, adding the values and block of the code
+  // section not in the parts.
+  TraceEventSpan SpliceSpan("compress", "splice function bodies");
+  Contents->reset();
+  for (const auto& Pair : PrefixContents->getHeader())
+    Contents->appendHeader(Pair.first, Pair.second);
+  if (PrefixContents->getIsHeaderClosed())
+    Contents->closeHeader();
+  IntStream::WriteCursor Pos(Contents);
+  Successful = Pos.writeStream(*PrefixContents) &&
+               Pos.write(CodeSectionCode) && Pos.openBlock() &&
+               Pos.write(Bodies.size());
+  for (size_t i = 0; Successful && i < BodyContents.size(); ++i) {
+    Successful = Pos.writeStream(*BodyContents[i]);
+    // Free the memory of the part as soon as it is copied.
+    BodyContents[i].reset();
+  }
+  return Successful && Pos.closeBlock() &&
+         Pos.writeStream(*SuffixContents) && Pos.freezeEof();
+}
+
+}  // end of namespace intcomp
+
+}  // end of namespace wasm
@@ -0,0 +1,108 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a reader that builds the integer stream of a WASM file, reading
+// the function bodies of the code section on multiple threads.
+//
+// Using the section and function body sizes, the file is split into the
+// sections before the code section, the function bodies, and the sections
+// after the code section. Each part is read by its own interpreter, into its
+// own integer stream. The streams are then spliced together (adding the
+// section code, block, and function count of the code section, as read by
+// 'section' and 'code.section'), giving the same integer stream as reading
+// the file with a single interpreter.
+//
+// The interpreters share the symbol table of the algorithm, and hence must
+// not modify it. Installing an algorithm fills the caches of its symbol
+// table, and split() installs any deferred defines. Hence each define frame
+// exists, and each call site is bound, before the interpreters start, and
+// the interpreters only read the symbol table.
+
+#ifndef DECOMPRESSOR_SRC_INTCOMP_PARALLELINPUTREADER_H
+#define DECOMPRESSOR_SRC_INTCOMP_PARALLELINPUTREADER_H
+
+#include "interp/IntStream.h"
+#include "interp/InterpreterFlags.h"
+#include "utils/Defs.h"
+
+#include <vector>
+
+namespace wasm {
+
+namespace filt {
+class Define;
+class SymbolTable;
+}  // end of namespace filt
+
+namespace interp {
+class Interpreter;
+}  // end of namespace interp
+
+namespace intcomp {
+
+class ParallelInputReader {
+  ParallelInputReader() = delete;
+  ParallelInputReader(const ParallelInputReader&) = delete;
+  ParallelInputReader& operator=(const ParallelInputReader&) = delete;
+
+ public:
+  // Note: NumThreads == 0 implies use the number of hardware threads.
+  ParallelInputReader(std::shared_ptr<filt::SymbolTable> Symtab,
+                      const interp::InterpreterFlags& Flags,
+                      size_t NumThreads);
+  ~ParallelInputReader();
+
+  // Finds the function bodies of the WASM file in Bytes, and completes the
+  // install of the algorithm. Returns false if Input doesn't have the
+  // expected layout (or the algorithm doesn't read WASM 0xd files, or
+  // define 'function.body'), in which case it must be read sequentially.
+  bool split(const std::vector<uint8_t>& Input);
+
+  // Reads the (split) file into Contents. Returns false if unable to.
+  bool read(std::shared_ptr<interp::IntStream> Contents);
+
+  size_t getNumFunctionBodies() const { return Bodies.size(); }
+
+ private:
+  struct Range {
+    size_t Begin;
+    size_t End;
+    Range(size_t Begin, size_t End) : Begin(Begin), End(End) {}
+  };
+  std::shared_ptr<filt::SymbolTable> Symtab;
+  interp::InterpreterFlags Flags;
+  size_t NumThreads;
+  const std::vector<uint8_t>* Bytes;
+  const filt::Define* FileDefn;
+  const filt::Define* BodyDefn;
+  // The header and sections before the code section.
+  Range Prefix;
+  // The sections after the code section.
+  Range Suffix;
+  std::vector<Range> Bodies;
+
+  std::unique_ptr<interp::Interpreter> createReader();
+  bool readRange(interp::Interpreter& MyReader,
+                 const Range& R,
+                 const filt::Define* Defn,
+                 std::shared_ptr<interp::IntStream> Contents);
+};
+
+}  // end of namespace intcomp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTCOMP_PARALLELINPUTREADER_H
@@ -19,6 +19,7 @@
 #include "interp/ByteReader.h"
 
 #include "interp/ByteReadStream.h"
+#include "interp/FormatHelpers-templates.h"
 #include "interp/ReadStream.h"
 #include "sexp/Ast.h"
 #include "utils/Casting.h"
@@ -126,7 +127,7 @@ bool ByteReader::atInputEob() {
 }
 
 bool ByteReader::atInputEof() {
-  return ReadPos.atEof();
+  return ReadPos.atReadEof();
 }
 
 bool ByteReader::pushPeekPos() {
@@ -147,7 +148,7 @@ decode::StreamType ByteReader::getStreamType() {
 }
 
 bool ByteReader::processedInputCorrectly(bool CheckForEof) {
-  return (!CheckForEof || ReadPos.atEof()) && ReadPos.isQueueGood();
+  return (!CheckForEof || ReadPos.atReadEof()) && ReadPos.isQueueGood();
 }
 
 bool ByteReader::readBlockEnter() {
@@ -167,8 +168,14 @@ bool ByteReader::readBlockExit() {
   return true;
 }
 
+void ByteReader::reset() {
+  AdaptiveModels.clear();
+}
+
 bool ByteReader::readBinary(const Node* Eval, IntType& Value) {
   Value = 0;
+  if (isa<BinaryAdaptive>(Eval))
+    return readAdaptive(Eval, Value);
   if (!isa<BinaryEval>(Eval))
     return false;
   const Node* Encoding = cast<BinaryEval>(Eval)->getKid(0);
@@ -187,12 +194,28 @@ bool ByteReader::readBinary(const Node* Eval, IntType& Value) {
   return false;
 }
 
+bool ByteReader::readAdaptive(const Node* Format, IntType& Value) {
+  std::unique_ptr<AdaptiveHuffman>& Model = AdaptiveModels[Format];
+  if (!Model) {
+    IntType NumSymbols = cast<BinaryAdaptive>(Format)->getValue();
+    if (NumSymbols == 0 || NumSymbols > AdaptiveHuffman::MaxNumSymbols)
+      return false;
+    Model.reset(new AdaptiveHuffman(NumSymbols));
+  }
+  Value = Model->decode(ReadPos);
+  // Note: Peeked values are read again, and hence should only be counted
+  // once.
+  if (SavedPosStack.empty())
+    Model->update(Value);
+  return true;
+}
+
 void ByteReader::readFillStart() {
   FillCursor = ReadPos;
 }
 
 void ByteReader::readFillMoreInput() {
-  if (FillCursor.atEof())
+  if (FillCursor.atReadEof())
     return;
   FillCursor.advance(PageSize);
 }
@@ -202,36 +225,47 @@ bool ByteReader::alignToByte() {
   return true;
 }
 
+// Reads using a non-virtual byte cursor when the read position is byte
+// aligned (i.e. outside of bit-level encodings).
+#define BYTEREADER_READ(Method)            \
+  do {                                     \
+    if (ReadPos.isByteAligned()) {         \
+      AlignedReadCursor Pos(ReadPos);      \
+      return fmt::Method(Pos);             \
+    }                                      \
+    return Input->Method(ReadPos);         \
+  } while (false)
+
 uint8_t ByteReader::readBit() {
   return Input->readBit(ReadPos);
 }
 
 uint8_t ByteReader::readUint8() {
-  return Input->readUint8(ReadPos);
+  BYTEREADER_READ(readUint8);
 }
 
 uint32_t ByteReader::readUint32() {
-  return Input->readUint32(ReadPos);
+  BYTEREADER_READ(readUint32);
 }
 
 uint64_t ByteReader::readUint64() {
-  return Input->readUint64(ReadPos);
+  BYTEREADER_READ(readUint64);
 }
 
 int32_t ByteReader::readVarint32() {
-  return Input->readVarint32(ReadPos);
+  BYTEREADER_READ(readVarint32);
 }
 
 int64_t ByteReader::readVarint64() {
-  return Input->readVarint64(ReadPos);
+  BYTEREADER_READ(readVarint64);
 }
 
 uint32_t ByteReader::readVaruint32() {
-  return Input->readVaruint32(ReadPos);
+  BYTEREADER_READ(readVaruint32);
 }
 
 uint64_t ByteReader::readVaruint64() {
-  return Input->readVaruint64(ReadPos);
+  BYTEREADER_READ(readVaruint64);
 }
 
 bool ByteReader::tablePush(IntType Value) {
@@ -246,6 +280,8 @@ bool ByteReader::tablePop() {
   return TblHandler->tablePop();
 }
 
+#undef BYTEREADER_READ
+
 void ByteReader::describePeekPosStack(FILE* File) {
   if (SavedPosStack.empty())
     return;
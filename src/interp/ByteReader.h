@@ -20,9 +20,12 @@
 #define DECOMPRESSOR_SRC_INTERP_BYTEREADER_H
 
 #include <map>
+#include <memory>
+#include <unordered_map>
 
 #include "interp/Reader.h"
 #include "stream/BitReadCursor.h"
+#include "utils/AdaptiveHuffman.h"
 
 namespace wasm {
 
@@ -41,6 +44,7 @@ class ByteReader : public Reader {
   void setReadPos(const decode::BitReadCursor& ReadPos);
   decode::BitReadCursor& getPos();
 
+  void reset() OVERRIDE;
   void describePeekPosStack(FILE* Out) OVERRIDE;
   bool canProcessMoreInputNow() OVERRIDE;
   bool stillMoreInputToProcessNow() OVERRIDE;
@@ -82,6 +86,11 @@ class ByteReader : public Reader {
   decode::BitReadCursor SavedPos;
   utils::ValueStack<decode::BitReadCursor> SavedPosStack;
   TableHandler* TblHandler;
+  // The adaptive (Huffman) models, one for each adaptive format node.
+  std::unordered_map<const filt::Node*, std::unique_ptr<utils::AdaptiveHuffman>>
+      AdaptiveModels;
+
+  bool readAdaptive(const filt::Node* Format, decode::IntType& Value);
 };
 
 }  // end of namespace interp
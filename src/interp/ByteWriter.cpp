@@ -108,6 +108,7 @@ ByteWriter::~ByteWriter() {
 void ByteWriter::reset() {
   BlockStart = BitWriteCursor();
   BlockStartStack.clear();
+  AdaptiveModels.clear();
 }
 
 void ByteWriter::setPos(const decode::BitWriteCursor& NewPos) {
@@ -176,6 +177,8 @@ bool ByteWriter::writeFreezeEof() {
 }
 
 bool ByteWriter::writeBinary(IntType Value, const Node* Encoding) {
+  if (isa<BinaryAdaptive>(Encoding))
+    return writeAdaptive(Value, Encoding);
   if (!isa<BinaryEval>(Encoding))
     return false;
   const auto* Eval = cast<BinaryEval>(Encoding);
@@ -193,6 +196,27 @@ bool ByteWriter::writeBinary(IntType Value, const Node* Encoding) {
   return true;
 }
 
+bool ByteWriter::writeAdaptive(IntType Value, const Node* Format) {
+  std::unique_ptr<AdaptiveHuffman>& Model = AdaptiveModels[Format];
+  if (!Model) {
+    IntType NumSymbols = cast<BinaryAdaptive>(Format)->getValue();
+    if (NumSymbols == 0 || NumSymbols > AdaptiveHuffman::MaxNumSymbols)
+      return false;
+    Model.reset(new AdaptiveHuffman(NumSymbols));
+  }
+  if (Value >= Model->getNumSymbols())
+    return false;
+  unsigned NumBits = Model->getNumBits(Value);
+  AdaptiveHuffman::PathType Bits = Model->getPath(Value);
+  while (NumBits) {
+    --NumBits;
+    WritePos.writeBit(uint8_t(Bits & 0x1));
+    Bits >>= 1;
+  }
+  Model->update(Value);
+  return WritePos.isQueueGood();
+}
+
 bool ByteWriter::alignToByte() {
   WritePos.alignToByte();
   return true;
@@ -20,9 +20,12 @@
 #define DECOMPRESSOR_SRC_INTERP_BYTEWRITER_H
 
 #include <map>
+#include <memory>
+#include <unordered_map>
 
 #include "interp/Writer.h"
 #include "stream/BitWriteCursor.h"
+#include "utils/AdaptiveHuffman.h"
 #include "utils/ValueStack.h"
 
 namespace wasm {
@@ -74,6 +77,11 @@ class ByteWriter : public Writer {
   void describeBlockStartStack(FILE* File);
   const char* getDefaultTraceName() const OVERRIDE;
   TableHandler* TblHandler;
+  // The adaptive (Huffman) models, one for each adaptive format node.
+  std::unordered_map<const filt::Node*, std::unique_ptr<utils::AdaptiveHuffman>>
+      AdaptiveModels;
+
+  bool writeAdaptive(decode::IntType Value, const filt::Node* Format);
 };
 
 }  // end of namespace interp
@@ -21,11 +21,13 @@
 #include "algorithms/wasm0xd.h"
 #include "interp/ByteReader.h"
 #include "interp/ByteWriter.h"
+#include "interp/DecompressCache.h"
 #include "interp/DecompressSelector.h"
 #include "interp/Interpreter.h"
 #include "stream/Pipe.h"
 #include "stream/Queue.h"
 #include "stream/WriteCursor2ReadQueue.h"
+#include "utils/TraceEvents.h"
 
 namespace wasm {
 
@@ -55,12 +57,32 @@ struct Decompressor {
   std::shared_ptr<DecompAlgState> AlgState;
   State MyState;
   InterpreterFlags Flags;
+  // True if this decompressor started the trace-event timeline.
+  bool RecordingTraceEvents;
+  // The result cache, if applicable. Input is buffered in CacheInput until
+  // all input is available, and then CacheKey is computed. On a hit, the
+  // output is served from CacheOutput. Otherwise, CacheOutput collects the
+  // fetched output, so that it can be added to the cache on success.
+  std::unique_ptr<DecompressCache> Cache;
+  std::vector<uint8_t> CacheInput;
+  std::string CacheKey;
+  std::vector<uint8_t> CacheOutput;
+  size_t CacheOutputPos;
+  bool UsingCachedOutput;
+  // When non-zero, pauses once this many output bytes are available.
+  int32_t MaxOutputBytes;
   Decompressor();
   uint8_t* getBuffer(int32_t Size);
   int32_t resume(int32_t Size);
+  int32_t continueResume();
+  bool isPending() const {
+    return MyState == State::NeedsMoreInput && MyReader->isPaused();
+  }
   void closeInput();
   bool fetchOutput(int32_t Size);
   int32_t getOutputSize() {
+    if (UsingCachedOutput)
+      return CacheOutput.size() - CacheOutputPos;
     return OutputPipe.getOutput()->fillSize() - OutputPos->getCurAddress();
   }
   TraceClass& getTrace() { return MyReader->getTrace(); }
@@ -68,6 +90,9 @@ struct Decompressor {
 
  private:
   int32_t flushOutput();
+  int32_t runInterpreter();
+  int32_t bufferForCache(int32_t Size);
+  bool lookupCache();
   int32_t fail() {
     MyState = State::Failed;
     return DECOMPRESSOR_ERROR;
@@ -78,7 +103,11 @@ Decompressor::Decompressor()
     : BufferSize(0),
       Input(std::make_shared<Queue>()),
       AlgState(std::make_shared<DecompAlgState>()),
-      MyState(State::NeedsMoreInput) {
+      MyState(State::NeedsMoreInput),
+      RecordingTraceEvents(false),
+      CacheOutputPos(0),
+      UsingCachedOutput(false),
+      MaxOutputBytes(0) {
   InputPos = std::make_shared<WriteCursor2ReadQueue>(Input);
   OutputPos = std::make_shared<ReadCursor>(OutputPipe.getOutput());
 }
@@ -98,13 +127,76 @@ int32_t Decompressor::flushOutput() {
   if (int32_t OutputSize = getOutputSize())
     return OutputSize;
   MyState = State::Succeeded;
+  if (Cache && !UsingCachedOutput && !CacheKey.empty()) {
+    Cache->insert(CacheKey, CacheOutput);
+    std::vector<uint8_t>().swap(CacheOutput);
+  }
   return DECOMPRESSOR_SUCCESS;
 }
 
+int32_t Decompressor::bufferForCache(int32_t Size) {
+  if (Size > BufferSize) {
+    MyReader->throwMessage("resume_decompression(" + std::to_string(Size) +
+                           "): illegal size");
+    return fail();
+  }
+  uint8_t* Buf = Buffer.get();
+  CacheInput.insert(CacheInput.end(), Buf, Buf + Size);
+  return 0;
+}
+
+bool Decompressor::lookupCache() {
+  TRACE_METHOD("lookupCache");
+  CacheKey = Cache->getKey(CacheInput.data(), CacheInput.size());
+  if (Cache->lookup(CacheKey, CacheOutput)) {
+    TRACE_MESSAGE("Using cached output");
+    std::vector<uint8_t>().swap(CacheInput);
+    UsingCachedOutput = true;
+    MyState = State::FlushingOutput;
+    return true;
+  }
+  for (uint8_t Byte : CacheInput)
+    InputPos->writeByte(Byte);
+  std::vector<uint8_t>().swap(CacheInput);
+  return false;
+}
+
+int32_t Decompressor::runInterpreter() {
+  MyReader->algorithmResume();
+  if (MyReader->errorsFound())
+    return fail();
+  if (!MyReader->isFinished())
+    return getOutputSize();
+  OutputPipe.getInput()->close();
+  if (!MyReader->isSuccessful())
+    return fail();
+  MyState = State::FlushingOutput;
+  return flushOutput();
+}
+
+int32_t Decompressor::continueResume() {
+  TRACE_METHOD("continue_decompression");
+  if (MyReader->isCancelled())
+    return fail();
+  if (MyState != State::NeedsMoreInput)
+    return resume(0);
+  // Note: Without more input, nothing can be done unless paused.
+  return isPending() ? runInterpreter() : getOutputSize();
+}
+
 int32_t Decompressor::resume(int32_t Size) {
   TRACE_METHOD("resume_decompression");
+  if (MyReader->isCancelled())
+    return fail();
   switch (MyState) {
     case State::NeedsMoreInput:
+      if (Cache && CacheKey.empty()) {
+        if (Size != 0)
+          return bufferForCache(Size);
+        if (lookupCache())
+          return flushOutput();
+        // Cache miss, so decompress the buffered input.
+      }
       if (Size == 0) {
         if (!InputPos->atEof()) {
           TRACE_MESSAGE("Closing input");
@@ -128,16 +220,7 @@ int32_t Decompressor::resume(int32_t Size) {
         for (int32_t i = 0; i < Size; ++i)
           InputPos->writeByte(Buf[i]);
       }
-      MyReader->algorithmResume();
-      if (MyReader->errorsFound())
-        return fail();
-      if (!MyReader->isFinished())
-        return getOutputSize();
-      OutputPipe.getInput()->close();
-      if (!MyReader->isSuccessful())
-        return fail();
-      MyState = State::FlushingOutput;
-      return flushOutput();
+      return runInterpreter();
     case State::FlushingOutput:
       return flushOutput();
     case State::Succeeded:
@@ -165,10 +248,17 @@ bool Decompressor::fetchOutput(int32_t Size) {
     fail();
     return false;
   }
-  // TODO(karlschimpf): Do this more efficiently.
   uint8_t* Buf = Buffer.get();
+  if (UsingCachedOutput) {
+    memcpy(Buf, CacheOutput.data() + CacheOutputPos, Size);
+    CacheOutputPos += Size;
+    return Size;
+  }
+  // TODO(karlschimpf): Do this more efficiently.
   for (int32_t i = 0; i < Size; ++i)
     Buf[i] = OutputPos->readByte();
+  if (Cache)
+    CacheOutput.insert(CacheOutput.end(), Buf, Buf + Size);
   return Size;
 }
 
@@ -196,6 +286,52 @@ void set_trace_decompression(void* Dptr, bool NewValue) {
   D->setTraceProgress(NewValue);
 }
 
+void set_decompressor_coroutines(void* Dptr, bool NewValue) {
+  Decompressor* D = (Decompressor*)Dptr;
+  D->Flags.UseCoroutines = NewValue;
+}
+
+bool set_decompressor_trace_events(void* Dptr, const char* Filename) {
+  Decompressor* D = (Decompressor*)Dptr;
+  if (!TraceEvents::start(Filename))
+    return false;
+  D->RecordingTraceEvents = true;
+  return true;
+}
+
+void set_decompressor_limits(void* Dptr,
+                             int64_t MaxSteps,
+                             int64_t MaxMicroseconds,
+                             int32_t MaxOutputBytes) {
+  Decompressor* D = (Decompressor*)Dptr;
+  D->MyReader->setResumeLimits(MaxSteps > 0 ? uint64_t(MaxSteps) : 0,
+                               MaxMicroseconds > 0 ? uint64_t(MaxMicroseconds)
+                                                   : 0);
+  D->MaxOutputBytes = MaxOutputBytes > 0 ? MaxOutputBytes : 0;
+  if (D->MaxOutputBytes == 0) {
+    D->MyReader->setResumePauseCheck(std::function<bool()>());
+    return;
+  }
+  D->MyReader->setResumePauseCheck(
+      [D]() { return D->getOutputSize() >= D->MaxOutputBytes; });
+}
+
+bool set_decompressor_cache(void* Dptr,
+                            const char* Directory,
+                            int64_t MaxSize) {
+  Decompressor* D = (Decompressor*)Dptr;
+  std::unique_ptr<DecompressCache> Cache(new DecompressCache(
+      Directory,
+      MaxSize > 0 ? size_t(MaxSize) : DecompressCache::DefaultMaxSize));
+  if (!Cache->isValid())
+    return false;
+  Cache->addOption(false);  // i.e. doesn't minimize block size.
+  Cache->addAlgorithm(getAlgcasm0x0Symtab());
+  Cache->addAlgorithm(getAlgwasm0xdSymtab());
+  D->Cache = std::move(Cache);
+  return true;
+}
+
 uint8_t* get_decompressor_buffer(void* Dptr, int32_t Size) {
   Decompressor* D = (Decompressor*)Dptr;
   return D->getBuffer(Size);
@@ -206,6 +342,21 @@ int32_t resume_decompression(void* Dptr, int32_t Size) {
   return D->resume(Size);
 }
 
+int32_t continue_decompression(void* Dptr) {
+  Decompressor* D = (Decompressor*)Dptr;
+  return D->continueResume();
+}
+
+bool decompression_pending(void* Dptr) {
+  Decompressor* D = (Decompressor*)Dptr;
+  return D->isPending();
+}
+
+void cancel_decompression(void* Dptr) {
+  Decompressor* D = (Decompressor*)Dptr;
+  D->MyReader->cancel();
+}
+
 bool fetch_decompressor_output(void* Dptr, int32_t Size) {
   Decompressor* D = (Decompressor*)Dptr;
   return D->fetchOutput(Size);
@@ -213,6 +364,8 @@ bool fetch_decompressor_output(void* Dptr, int32_t Size) {
 
 void destroy_decompressor(void* Dptr) {
   Decompressor* D = (Decompressor*)Dptr;
+  if (D->RecordingTraceEvents)
+    TraceEvents::stop();
   delete D;
 }
 
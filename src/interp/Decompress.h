@@ -38,6 +38,40 @@ extern uint8_t* get_decompressor_buffer(void* D, int32_t Size);
 /* Turns on verbose tracing. */
 extern void set_trace_decompression(void* D, bool NewValue);
 
+/* Evaluates using the coroutine engine (rather than the state machine). Must
+ * be called before the first call to resume_decompression().
+ */
+extern void set_decompressor_coroutines(void* D, bool NewValue);
+
+/* Records a trace-event timeline (in Chrome's JSON trace format) of the
+ * decompression, written to Filename when D is destroyed. Returns false if
+ * a timeline is already being recorded.
+ */
+extern bool set_decompressor_trace_events(void* D, const char* Filename);
+
+/* Serves decompressions from (and adds them to) the on-disk cache in
+ * Directory, limited to MaxSize bytes (or a default limit if MaxSize <= 0).
+ * Input is then buffered until resume_decompression() is called with
+ * Size == 0, so that cache hits don't need to run the interpreter. Must be
+ * called before the first call to resume_decompression(). Returns false if
+ * the cache directory can't be used.
+ */
+extern bool set_decompressor_cache(void* D,
+                                   const char* Directory,
+                                   int64_t MaxSize);
+
+/* Limits the work done by each call to resume_decompression() (and
+ * continue_decompression()) to MaxSteps interpreter steps, MaxMicroseconds of
+ * elapsed time, and MaxOutputBytes of output available to fetch. A value <= 0
+ * implies no limit. When a limit is reached, the call returns early (with the
+ * number of output bytes available), and decompression_pending() returns
+ * true.
+ */
+extern void set_decompressor_limits(void* D,
+                                    int64_t MaxSteps,
+                                    int64_t MaxMicroseconds,
+                                    int32_t MaxOutputBytes);
+
 /* Resume decopmression, assuming the buffer contains Size bytes to read.  If
  * non-negative, returns the number of output bytes available to fetch using
  * fetch_decompressor_output().  If negative, either DECOMPRESSOR_SUCCESS or
@@ -46,6 +80,23 @@ extern void set_trace_decompression(void* D, bool NewValue);
  */
 extern int32_t resume_decompression(void* D, int32_t Size);
 
+/* Returns true if the last call to resume_decompression() (or
+ * continue_decompression()) stopped at a limit, leaving input to process.
+ */
+extern bool decompression_pending(void* D);
+
+/* Continues processing the input already provided, without adding input.
+ * Returns the same values as resume_decompression().
+ */
+extern int32_t continue_decompression(void* D);
+
+/* Cancels the decompression. May be called from another thread, while
+ * resume_decompression() (or continue_decompression()) is running, in which
+ * case that call returns DECOMPRESSOR_ERROR shortly after. All subsequent
+ * calls return DECOMPRESSOR_ERROR. D must still be destroyed.
+ */
+extern void cancel_decompression(void* D);
+
 /* Fetch the next Size output bytes and put into the decompression buffer.
  * Returns true if successful.
  */
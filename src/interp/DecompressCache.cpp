@@ -0,0 +1,267 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements an on-disk cache of decompression results.
+
+#include "interp/DecompressCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "sexp/Ast.h"
+#include "utils/Casting.h"
+
+namespace wasm {
+
+using namespace filt;
+
+namespace interp {
+
+namespace {
+
+constexpr char Magic[8] = {'w', 'c', 'a', 'c', 'h', 'e', '0', '2'};
+constexpr charstring EntrySuffix = ".wcache";
+constexpr charstring TempTemplate = "/.tmp-XXXXXX";
+constexpr size_t HeaderSize = sizeof(Magic) + 2 * sizeof(uint64_t);
+
+constexpr uint64_t FnvOffset = 0xcbf29ce484222325ULL;
+constexpr uint64_t FnvPrime = 0x100000001b3ULL;
+
+// Note: Only detects corrupt entries, since entries are found by key.
+uint64_t checksum(const std::vector<uint8_t>& Bytes) {
+  uint64_t Hash = FnvOffset;
+  for (uint8_t Byte : Bytes) {
+    Hash ^= Byte;
+    Hash *= FnvPrime;
+  }
+  uint64_t Size = Bytes.size();
+  for (size_t i = 0; i < sizeof(Size); ++i) {
+    Hash ^= uint8_t(Size >> (8 * i));
+    Hash *= FnvPrime;
+  }
+  return Hash;
+}
+
+void writeValue(uint8_t* Buffer, uint64_t Value) {
+  for (size_t i = 0; i < sizeof(Value); ++i) {
+    Buffer[i] = uint8_t(Value);
+    Value >>= 8;
+  }
+}
+
+uint64_t readValue(const uint8_t* Buffer) {
+  uint64_t Value = 0;
+  for (size_t i = sizeof(Value); i > 0; --i)
+    Value = (Value << 8) | Buffer[i - 1];
+  return Value;
+}
+
+bool hasSuffix(const std::string& Name, charstring Suffix) {
+  size_t Size = strlen(Suffix);
+  return Name.size() > Size &&
+         Name.compare(Name.size() - Size, Size, Suffix) == 0;
+}
+
+struct EntryInfo {
+  std::string Filename;
+  time_t LastUsed;
+  size_t Size;
+  EntryInfo(const std::string& Filename, time_t LastUsed, size_t Size)
+      : Filename(Filename), LastUsed(LastUsed), Size(Size) {}
+};
+
+}  // end of anonymous namespace
+
+constexpr size_t DecompressCache::DefaultMaxSize;
+constexpr uint64_t DecompressCache::DecoderVersion;
+
+DecompressCache::DecompressCache(const std::string& Directory, size_t MaxSize)
+    : Directory(Directory),
+      MaxSize(MaxSize),
+      IsValid(false),
+      TotalSize(0),
+      IsTotalSizeKnown(false) {
+  Fingerprint.add(reinterpret_cast<const uint8_t*>(Magic), sizeof(Magic));
+  Fingerprint.addValue(DecoderVersion);
+  if (mkdir(Directory.c_str(), 0755) != 0 && errno != EEXIST)
+    return;
+  struct stat Info;
+  IsValid = stat(Directory.c_str(), &Info) == 0 && S_ISDIR(Info.st_mode);
+}
+
+DecompressCache::~DecompressCache() {}
+
+void DecompressCache::addAlgorithm(std::shared_ptr<SymbolTable> Symtab) {
+  // Note: Enclosing scopes are added first, since they are installed first.
+  if (Symtab->getEnclosingScope())
+    addAlgorithm(Symtab->getEnclosingScope());
+  std::vector<const Node*> ToVisit;
+  ToVisit.push_back(Symtab->getAlgorithm());
+  while (!ToVisit.empty()) {
+    const Node* Nd = ToVisit.back();
+    ToVisit.pop_back();
+    if (Nd == nullptr) {
+      Fingerprint.addValue(0);
+      continue;
+    }
+    Fingerprint.addValue(uint64_t(Nd->getType()) + 1);
+    if (const auto* IntNd = dyn_cast<IntegerNode>(Nd))
+      Fingerprint.addValue(IntNd->getValue());
+    else if (const auto* Sym = dyn_cast<Symbol>(Nd))
+      Fingerprint.addString(Sym->getName());
+    Fingerprint.addValue(Nd->getNumKids());
+    for (int i = Nd->getNumKids(); i > 0; --i)
+      ToVisit.push_back(Nd->getKid(i - 1));
+  }
+}
+
+void DecompressCache::addOption(uint64_t Value) {
+  Fingerprint.addValue(Value);
+}
+
+std::string DecompressCache::getKey(const uint8_t* Input, size_t Size) const {
+  utils::Sha256 Hash(Fingerprint);
+  Hash.addValue(Size);
+  Hash.add(Input, Size);
+  return Hash.getHexDigest();
+}
+
+std::string DecompressCache::getEntryFilename(const std::string& Key) const {
+  return Directory + "/" + Key + EntrySuffix;
+}
+
+bool DecompressCache::lookup(const std::string& Key,
+                             std::vector<uint8_t>& Output) {
+  if (!IsValid)
+    return false;
+  std::string Filename = getEntryFilename(Key);
+  FILE* In = fopen(Filename.c_str(), "rb");
+  if (In == nullptr)
+    return false;
+  uint8_t Header[HeaderSize];
+  bool Success = fread(Header, 1, HeaderSize, In) == HeaderSize &&
+                 memcmp(Header, Magic, sizeof(Magic)) == 0;
+  if (Success) {
+    uint64_t Size = readValue(Header + sizeof(Magic));
+    Success = Size <= MaxSize;
+    if (Success) {
+      Output.resize(Size);
+      Success = fread(Output.data(), 1, Size, In) == Size &&
+                fgetc(In) == EOF &&
+                checksum(Output) ==
+                    readValue(Header + sizeof(Magic) + sizeof(uint64_t));
+    }
+  }
+  fclose(In);
+  if (!Success) {
+    fprintf(stderr, "Removing corrupt decompression cache entry: %s\n",
+            Filename.c_str());
+    unlink(Filename.c_str());
+    Output.clear();
+    return false;
+  }
+  // Mark as recently used.
+  utime(Filename.c_str(), nullptr);
+  return true;
+}
+
+bool DecompressCache::insert(const std::string& Key,
+                             const std::vector<uint8_t>& Output) {
+  if (!IsValid || HeaderSize + Output.size() > MaxSize)
+    return false;
+  std::string Filename = getEntryFilename(Key);
+  // Write to a (uniquely named) temporary file, and then rename, so that
+  // concurrent readers never see a partial entry.
+  std::string TempFilename = Directory + TempTemplate;
+  int Fd = mkstemp(&TempFilename[0]);
+  if (Fd < 0)
+    return false;
+  FILE* Out = fchmod(Fd, 0644) == 0 ? fdopen(Fd, "wb") : nullptr;
+  if (Out == nullptr) {
+    close(Fd);
+    unlink(TempFilename.c_str());
+    return false;
+  }
+  uint8_t Header[HeaderSize];
+  memcpy(Header, Magic, sizeof(Magic));
+  writeValue(Header + sizeof(Magic), Output.size());
+  writeValue(Header + sizeof(Magic) + sizeof(uint64_t), checksum(Output));
+  bool Success =
+      fwrite(Header, 1, HeaderSize, Out) == HeaderSize &&
+      fwrite(Output.data(), 1, Output.size(), Out) == Output.size();
+  if (fclose(Out) != 0)
+    Success = false;
+  struct stat Info;
+  size_t ReplacedSize =
+      stat(Filename.c_str(), &Info) == 0 ? size_t(Info.st_size) : 0;
+  if (!Success || rename(TempFilename.c_str(), Filename.c_str()) != 0) {
+    unlink(TempFilename.c_str());
+    return false;
+  }
+  TotalSize -= std::min(TotalSize, ReplacedSize);
+  TotalSize += HeaderSize + Output.size();
+  if (!IsTotalSizeKnown || TotalSize > MaxSize)
+    evict(Filename);
+  return true;
+}
+
+void DecompressCache::evict(const std::string& Keep) {
+  DIR* Dir = opendir(Directory.c_str());
+  if (Dir == nullptr)
+    return;
+  std::vector<EntryInfo> Entries;
+  TotalSize = 0;
+  while (struct dirent* Ent = readdir(Dir)) {
+    std::string Name(Ent->d_name);
+    if (!hasSuffix(Name, EntrySuffix))
+      continue;
+    std::string Filename = Directory + "/" + Name;
+    struct stat Info;
+    if (stat(Filename.c_str(), &Info) != 0 || !S_ISREG(Info.st_mode))
+      continue;
+    Entries.emplace_back(Filename, Info.st_mtime, size_t(Info.st_size));
+    TotalSize += size_t(Info.st_size);
+  }
+  closedir(Dir);
+  IsTotalSizeKnown = true;
+  if (TotalSize <= MaxSize)
+    return;
+  // Remove down to a fraction of the bound, so that the directory is only
+  // scanned again after several inserts.
+  size_t TargetSize = MaxSize - MaxSize / 4;
+  std::sort(Entries.begin(), Entries.end(),
+            [](const EntryInfo& E1, const EntryInfo& E2) {
+              return E1.LastUsed < E2.LastUsed;
+            });
+  for (const EntryInfo& Entry : Entries) {
+    if (TotalSize <= TargetSize)
+      break;
+    if (Entry.Filename == Keep)
+      continue;
+    if (unlink(Entry.Filename.c_str()) == 0)
+      TotalSize -= Entry.Size;
+  }
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
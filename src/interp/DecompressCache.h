@@ -0,0 +1,102 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines an on-disk cache of decompression results.
+//
+// Entries are keyed by a SHA-256 hash of the decoder version, the algorithms
+// (and options) used to decompress, and the compressed input. Each entry is
+// a file in the cache directory, holding the decompressed output and a
+// checksum of it. Entries that fail the checksum are removed, and treated as
+// misses.
+//
+// The cache is bounded by the total size of its entries. The modification
+// time of an entry is updated on each hit, so that when the bound is
+// exceeded, the least recently used entries are removed first.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_DECOMPRESSCACHE_H
+#define DECOMPRESSOR_SRC_INTERP_DECOMPRESSCACHE_H
+
+#include "utils/Defs.h"
+#include "utils/Sha256.h"
+
+#include <string>
+#include <vector>
+
+namespace wasm {
+
+namespace filt {
+class SymbolTable;
+}  // end of namespace filt
+
+namespace interp {
+
+class DecompressCache {
+  DecompressCache() = delete;
+  DecompressCache(const DecompressCache&) = delete;
+  DecompressCache& operator=(const DecompressCache&) = delete;
+
+ public:
+  static constexpr size_t DefaultMaxSize = size_t(256) * 1024 * 1024;
+  // Must be incremented when a change to the decoder changes the output for
+  // the same algorithms and input, so that stale entries are not used.
+  static constexpr uint64_t DecoderVersion = 1;
+
+  // Note: Creates Directory if it doesn't exist.
+  DecompressCache(const std::string& Directory,
+                  size_t MaxSize = DefaultMaxSize);
+  ~DecompressCache();
+
+  // Adds the algorithm in Symtab (and its enclosing scopes) to the
+  // fingerprint of the decompressor. Must be called (in selector order)
+  // for each algorithm used, before computing keys.
+  void addAlgorithm(std::shared_ptr<filt::SymbolTable> Symtab);
+
+  // Adds an option that changes the decompressed output to the fingerprint.
+  void addOption(uint64_t Value);
+
+  // Returns the key for decompressing Input (of Size bytes).
+  std::string getKey(const uint8_t* Input, size_t Size) const;
+
+  // Returns true (and fills Output) if there is a valid entry for Key.
+  bool lookup(const std::string& Key, std::vector<uint8_t>& Output);
+
+  // Adds the entry Key -> Output, removing least recently used entries if
+  // the cache gets too big. Returns true if successful.
+  bool insert(const std::string& Key, const std::vector<uint8_t>& Output);
+
+  const std::string& getDirectory() const { return Directory; }
+  size_t getMaxSize() const { return MaxSize; }
+  bool isValid() const { return IsValid; }
+
+ private:
+  std::string Directory;
+  size_t MaxSize;
+  bool IsValid;
+  utils::Sha256 Fingerprint;
+  // Total size of the entries. Only an estimate, since other decompressors
+  // may share the directory. Recomputed whenever entries are evicted.
+  size_t TotalSize;
+  bool IsTotalSizeKnown;
+
+  std::string getEntryFilename(const std::string& Key) const;
+  void evict(const std::string& Keep);
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_DECOMPRESSCACHE_H
@@ -36,6 +36,7 @@
 #include "interp/Interpreter.h"
 #include "sexp/Ast.h"
 #include "utils/Trace.h"
+#include "utils/TraceEvents.h"
 
 namespace wasm {
 
@@ -44,7 +45,7 @@ using namespace filt;
 namespace interp {
 
 DecompAlgState::DecompAlgState(Interpreter* MyInterpreter)
-    : MyInterpreter(MyInterpreter) {}
+    : MyInterpreter(MyInterpreter), InStage(false) {}
 
 DecompAlgState::~DecompAlgState() {}
 
@@ -62,11 +63,27 @@ std::shared_ptr<SymbolTable> DecompressSelector::getSymtab() {
   return Symtab;
 }
 
+void DecompressSelector::beginStage(charstring Name) {
+  endStage();
+  if (!utils::TraceEvents::isRecording())
+    return;
+  utils::TraceEvents::begin("decompress", Name);
+  State->InStage = true;
+}
+
+void DecompressSelector::endStage() {
+  if (!State->InStage)
+    return;
+  utils::TraceEvents::end("decompress");
+  State->InStage = false;
+}
+
 bool DecompressSelector::configure(Interpreter* R) {
   return IsAlgorithm ? configureAlgorithm(R) : configureData(R);
 }
 
 bool DecompressSelector::configureAlgorithm(Interpreter* R) {
+  beginStage("read algorithm");
   R->setSymbolTable(Symtab);
   State->OrigWriter = R->getWriter();
   State->Inflator = std::make_shared<InflateAst>();
@@ -76,11 +93,13 @@ bool DecompressSelector::configureAlgorithm(Interpreter* R) {
 }
 
 bool DecompressSelector::applyDataAlgorithm(Interpreter* R) {
+  beginStage("apply data algorithm");
   R->setSymbolTable(Symtab);
   return true;
 }
 
 bool DecompressSelector::applyNextQueuedAlgorithm(Interpreter* R) {
+  beginStage("decompress to integer stream");
   SymbolTable::SharedPtr NextSymtab = State->AlgQueue.front();
   R->setSymbolTable(NextSymtab);
   State->AlgQueue.pop();
@@ -108,6 +127,7 @@ bool DecompressSelector::reset(Interpreter* R) {
 }
 
 bool DecompressSelector::resetAlgorithm(Interpreter* R) {
+  endStage();
   R->setWriter(State->OrigWriter);
   State->OrigWriter->reset();
   if (!State->Inflator)
@@ -120,15 +140,18 @@ bool DecompressSelector::resetAlgorithm(Interpreter* R) {
   constexpr bool UseEnclosing = true;
   Algorithm->setEnclosingScope(State->MyInterpreter->getDefaultAlgorithm(
       Root->getReadHeader(!UseEnclosing)));
+  Algorithm->setLazyInstall(true);
   Algorithm->install();
   State->AlgQueue.push(Algorithm);
   return true;
 }
 
 bool DecompressSelector::resetData(Interpreter* R) {
+  endStage();
   if (!State->IntermediateStream)
     // No decompression applied, just did copy of input. so done!
     return true;
+  beginStage("write integer stream");
   // Convert intermediate stream back to binary using final symbol table.
   R->setWriter(State->OrigWriter);
   State->OrigWriter.reset();
@@ -56,6 +56,8 @@ class DecompAlgState : public std::enable_shared_from_this<DecompAlgState> {
 
  private:
   Interpreter* MyInterpreter;
+  // True if a stage span is open in the trace-event timeline.
+  bool InStage;
   std::queue<std::shared_ptr<filt::SymbolTable>> AlgQueue;
   std::shared_ptr<filt::SymbolTable> FinalSymtab;
   std::shared_ptr<filt::InflateAst> Inflator;
@@ -87,6 +89,8 @@ class DecompressSelector : public AlgorithmSelector {
   bool resetData(Interpreter* R);
   bool applyDataAlgorithm(Interpreter* R);
   bool applyNextQueuedAlgorithm(Interpreter* R);
+  void beginStage(charstring Name);
+  void endStage();
 };
 
 }  // end of namespace interp
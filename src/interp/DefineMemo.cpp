@@ -0,0 +1,92 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a (bounded) cache of the results of pure defines.
+
+#include "interp/DefineMemo.h"
+
+namespace wasm {
+
+using namespace decode;
+using namespace filt;
+
+namespace interp {
+
+constexpr size_t DefineMemo::DefaultMaxEntries;
+
+size_t DefineMemo::KeyHash::operator()(const KeyType& Key) const {
+  size_t Hash = Key.size();
+  for (IntType Value : Key)
+    Hash = (Hash * 31) ^ size_t(Value ^ (Value >> 32));
+  return Hash;
+}
+
+DefineMemo::DefineMemo(size_t MaxEntries)
+    : MaxEntries(MaxEntries), NumHits(0), NumMisses(0) {}
+
+DefineMemo::~DefineMemo() {}
+
+void DefineMemo::setKey(const SymbolTable* Scope,
+                        const Define* Def,
+                        uint32_t Modifier,
+                        IntType LastRead,
+                        const IntType* Values,
+                        size_t NumValues) {
+  Key.clear();
+  Key.push_back(IntType(uintptr_t(Scope)));
+  Key.push_back(IntType(uintptr_t(Def)));
+  Key.push_back(Modifier);
+  Key.push_back(LastRead);
+  Key.insert(Key.end(), Values, Values + NumValues);
+}
+
+bool DefineMemo::lookup(const SymbolTable* Scope,
+                        const Define* Def,
+                        uint32_t Modifier,
+                        IntType LastRead,
+                        const IntType* Values,
+                        size_t NumValues,
+                        IntType& Result) {
+  setKey(Scope, Def, Modifier, LastRead, Values, NumValues);
+  auto Iter = Results.find(Key);
+  if (Iter == Results.end()) {
+    ++NumMisses;
+    return false;
+  }
+  ++NumHits;
+  Result = Iter->second;
+  return true;
+}
+
+void DefineMemo::insert(std::shared_ptr<SymbolTable> Scope,
+                        const Define* Def,
+                        uint32_t Modifier,
+                        IntType LastRead,
+                        const IntType* Values,
+                        size_t NumValues,
+                        IntType Result) {
+  if (Results.size() >= MaxEntries) {
+    Results.clear();
+    Scopes.clear();
+  }
+  setKey(Scope.get(), Def, Modifier, LastRead, Values, NumValues);
+  Scopes.insert(Scope);
+  Results[Key] = Result;
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
@@ -0,0 +1,99 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a (bounded) cache of the results of pure defines (see
+// SymbolTable::isPureDefine()).
+//
+// Results are keyed by the scope the define was resolved in, the define,
+// the method modifier, the last read value on entry, and the values of the
+// arguments. When the cache reaches its maximum number of entries, it is
+// cleared. Scopes with cached results are kept alive until then, so that the
+// (pointer) keys can't be reused by other algorithms.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_DEFINEMEMO_H_
+#define DECOMPRESSOR_SRC_INTERP_DEFINEMEMO_H_
+
+#include "utils/Defs.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace wasm {
+
+namespace filt {
+class Define;
+class SymbolTable;
+}  // end of namespace filt
+
+namespace interp {
+
+class DefineMemo {
+  DefineMemo(const DefineMemo&) = delete;
+  DefineMemo& operator=(const DefineMemo&) = delete;
+
+ public:
+  static constexpr size_t DefaultMaxEntries = size_t(1) << 16;
+
+  explicit DefineMemo(size_t MaxEntries = DefaultMaxEntries);
+  ~DefineMemo();
+
+  // Returns true (and sets Result) if the call is cached.
+  bool lookup(const filt::SymbolTable* Scope,
+              const filt::Define* Def,
+              uint32_t Modifier,
+              decode::IntType LastRead,
+              const decode::IntType* Values,
+              size_t NumValues,
+              decode::IntType& Result);
+
+  void insert(std::shared_ptr<filt::SymbolTable> Scope,
+              const filt::Define* Def,
+              uint32_t Modifier,
+              decode::IntType LastRead,
+              const decode::IntType* Values,
+              size_t NumValues,
+              decode::IntType Result);
+
+  uint64_t getNumHits() const { return NumHits; }
+  uint64_t getNumMisses() const { return NumMisses; }
+
+ private:
+  typedef std::vector<decode::IntType> KeyType;
+  struct KeyHash {
+    size_t operator()(const KeyType& Key) const;
+  };
+  std::unordered_map<KeyType, decode::IntType, KeyHash> Results;
+  std::unordered_set<std::shared_ptr<filt::SymbolTable>> Scopes;
+  size_t MaxEntries;
+  uint64_t NumHits;
+  uint64_t NumMisses;
+  // Reused to build keys, to avoid allocating on each lookup.
+  KeyType Key;
+
+  void setKey(const filt::SymbolTable* Scope,
+              const filt::Define* Def,
+              uint32_t Modifier,
+              decode::IntType LastRead,
+              const decode::IntType* Values,
+              size_t NumValues);
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_DEFINEMEMO_H_
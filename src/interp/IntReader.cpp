@@ -154,8 +154,36 @@ decode::IntType IntReader::read() {
   return Pos.read();
 }
 
+uint8_t IntReader::readBit() {
+  return Pos.read() & 0x1;
+}
+
+uint8_t IntReader::readUint8() {
+  return uint8_t(Pos.read());
+}
+
+uint32_t IntReader::readUint32() {
+  return uint32_t(Pos.read());
+}
+
+uint64_t IntReader::readUint64() {
+  return uint64_t(Pos.read());
+}
+
+int32_t IntReader::readVarint32() {
+  return int32_t(Pos.read());
+}
+
+int64_t IntReader::readVarint64() {
+  return int64_t(Pos.read());
+}
+
+uint32_t IntReader::readVaruint32() {
+  return uint32_t(Pos.read());
+}
+
 uint64_t IntReader::readVaruint64() {
-  return read();
+  return Pos.read();
 }
 
 bool IntReader::readHeaderValue(IntTypeFormat Format, IntType& Value) {
@@ -54,6 +54,15 @@ class IntReader : public Reader {
   bool processedInputCorrectly(bool CheckForEof) OVERRIDE;
   void readFillStart() OVERRIDE;
   void readFillMoreInput() OVERRIDE;
+  // Note: All formats are read directly from the integer stream, rather
+  // than through readVaruint64().
+  uint8_t readBit() OVERRIDE;
+  uint8_t readUint8() OVERRIDE;
+  uint32_t readUint32() OVERRIDE;
+  uint64_t readUint64() OVERRIDE;
+  int32_t readVarint32() OVERRIDE;
+  int64_t readVarint64() OVERRIDE;
+  uint32_t readVaruint32() OVERRIDE;
   uint64_t readVaruint64() OVERRIDE;
   bool readBlockEnter() OVERRIDE;
   bool readBlockExit() OVERRIDE;
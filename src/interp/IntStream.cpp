@@ -175,6 +175,36 @@ bool IntStream::WriteCursor::closeBlock() {
   return true;
 }
 
+bool IntStream::WriteCursor::writeStream(const IntStream& Src) {
+  assert(!EnclosingBlocks.empty());
+  assert(Index == Stream->Values.size());
+  size_t Offset = Index;
+  Stream->Values.insert(Stream->Values.end(), Src.Values.begin(),
+                        Src.Values.end());
+  Index += Src.Values.size();
+  return appendSubblocks(*Src.TopBlock, Offset);
+}
+
+bool IntStream::WriteCursor::appendSubblocks(const Block& SrcParent,
+                                             size_t Offset) {
+  // Note: Blocks are added in the order they were opened, so that the
+  // sequence of written blocks is preserved.
+  for (const BlockPtr& SrcBlk : SrcParent.Subblocks) {
+    if (SrcBlk->EndIndex == std::numeric_limits<size_t>::max())
+      return false;
+    auto Blk = std::make_shared<Block>(SrcBlk->BeginIndex + Offset,
+                                       SrcBlk->EndIndex + Offset);
+    EnclosingBlocks.back()->Subblocks.push_back(Blk);
+    Stream->Blocks.push_back(Blk);
+    EnclosingBlocks.push_back(Blk);
+    bool Success = appendSubblocks(*SrcBlk, Offset);
+    EnclosingBlocks.pop_back();
+    if (!Success)
+      return false;
+  }
+  return true;
+}
+
 IntStream::ReadCursor::ReadCursor() : Cursor() {}
 
 IntStream::ReadCursor::ReadCursor(Ptr Stream)
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "interp/IntFormats.h"
+#include "utils/HugePages.h"
 #include "utils/TraceAPI.h"
 
 namespace wasm {
@@ -36,7 +37,9 @@ class IntStream : public std::enable_shared_from_this<IntStream> {
   class Block;
   class Cursor;
   class WriteCursor;
-  typedef std::vector<decode::IntType> IntVector;
+  typedef std::vector<decode::IntType,
+                      alloc::HugePageAllocator<decode::IntType>>
+      IntVector;
   typedef std::vector<std::pair<decode::IntType, IntTypeFormat>> HeaderVector;
   typedef std::shared_ptr<Block> BlockPtr;
   typedef std::vector<BlockPtr> BlockVector;
@@ -105,6 +108,12 @@ class IntStream : public std::enable_shared_from_this<IntStream> {
     bool freezeEof();
     bool openBlock();
     bool closeBlock();
+    // Appends the values (and blocks) of Src, as if they were written
+    // using this cursor. Src must not have open blocks.
+    bool writeStream(const IntStream& Src);
+
+   private:
+    bool appendSubblocks(const Block& SrcParent, size_t Offset);
   };
 
   class ReadCursor : public Cursor {
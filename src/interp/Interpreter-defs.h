@@ -39,6 +39,7 @@
   X(CopyBlock)                    \
   X(Eval)                         \
   X(EvalBlock)                    \
+  X(EvalCoroutine)                \
   X(EvalInCallingContext)         \
   X(Finished)                     \
   X(GetAlgorithm)                 \
@@ -20,12 +20,16 @@
 #include "interp/Interpreter.h"
 
 #include "interp/AlgorithmSelector.h"
+#include "interp/DefineMemo.h"
 #include "interp/Reader.h"
+#include "interp/SourceProfile.h"
 #include "interp/Writer.h"
 #include "sexp/Ast.h"
 #include "sexp/TextWriter.h"
 #include "utils/Casting.h"
+#include "utils/Coroutine.h"
 #include "utils/Trace.h"
+#include "utils/TraceEvents.h"
 
 #define LOG_TRUE_VALUE 1
 #define LOG_FALSE_VALUE 0
@@ -99,13 +103,32 @@ struct {
 #undef X
     {"NO_SUCH_METHOD_MODIFIER", 0}};
 
+// Stops charging profile time while the interpreter isn't running.
+class PauseProfileAtExit {
+  PauseProfileAtExit() = delete;
+  PauseProfileAtExit(const PauseProfileAtExit&) = delete;
+  PauseProfileAtExit& operator=(const PauseProfileAtExit&) = delete;
+
+ public:
+  explicit PauseProfileAtExit(SourceProfile* Profile) : Profile(Profile) {}
+  ~PauseProfileAtExit() {
+    if (Profile)
+      Profile->pause();
+  }
+
+ private:
+  SourceProfile* Profile;
+};
+
 }  // end of anonymous namespace
 
 InterpreterFlags::InterpreterFlags()
     : MacroContext(MacroDirective::Expand),
       TraceProgress(false),
       TraceIntermediateStreams(false),
-      TraceAppliedAlgorithms(false) {}
+      TraceAppliedAlgorithms(false),
+      UseCoroutines(false),
+      MemoizePureDefines(false) {}
 
 Interpreter::CallFrame::CallFrame() {
   reset();
@@ -149,19 +172,25 @@ Interpreter::EvalFrame::EvalFrame(const Eval* Caller,
     : Caller(Caller),
       DefinedFrame(DefinedFrame),
       CallingEvalIndex(CallingEvalIndex),
-      Values(DefinedFrame->getNumValues(), 0) {}
+      Values(DefinedFrame->getNumValues(), 0),
+      IsMemoized(false),
+      MemoLastRead(0) {}
 
 Interpreter::EvalFrame::EvalFrame(const EvalFrame& F)
     : Caller(F.Caller),
       DefinedFrame(F.DefinedFrame),
       CallingEvalIndex(F.CallingEvalIndex),
-      Values(F.Values) {}
+      Values(F.Values),
+      IsMemoized(F.IsMemoized),
+      MemoLastRead(F.MemoLastRead) {}
 
 Interpreter::EvalFrame& Interpreter::EvalFrame::operator=(const EvalFrame& F) {
   Caller = F.Caller;
   DefinedFrame = F.DefinedFrame;
   CallingEvalIndex = F.CallingEvalIndex;
   Values = F.Values;
+  IsMemoized = F.IsMemoized;
+  MemoLastRead = F.MemoLastRead;
   return *this;
 }
 
@@ -197,6 +226,19 @@ void Interpreter::EvalFrame::reset() {
   DefinedFrame = nullptr;
   CallingEvalIndex = 0;
   Values.clear();
+  IsMemoized = false;
+  MemoLastRead = 0;
+}
+
+void Interpreter::EvalFrame::init(const Eval* NewCaller,
+                                  const DefineFrame* NewDefinedFrame,
+                                  size_t NewCallingEvalIndex) {
+  Caller = NewCaller;
+  DefinedFrame = NewDefinedFrame;
+  CallingEvalIndex = NewCallingEvalIndex;
+  Values.assign(DefinedFrame->getNumValues(), 0);
+  IsMemoized = false;
+  MemoLastRead = 0;
 }
 
 void Interpreter::setInput(std::shared_ptr<Reader> Value) {
@@ -330,19 +372,65 @@ Interpreter::Interpreter(std::shared_ptr<Reader> Input,
 
 void Interpreter::init() {
   LastReadValue = 0;
+  BlockDepth = 0;
   CurSectionName.reserve(MaxExpectedSectionNameSize);
   FrameStack.reserve(DefaultStackSize);
   EvalFrameStack.reserve(DefaultStackSize);
   CurEvalFrameStack.reserve(DefaultStackSize);
   CurEvalFrameStack.push_back(0);
+  Memo = make_unique<DefineMemo>();
   LoopCounterStack.reserve(DefaultStackSize);
   LocalsBaseStack.reserve(DefaultStackSize);
   LocalValues.reserve(DefaultStackSize * DefaultExpectedLocals);
   OpcodeLocalsStack.reserve(DefaultStackSize);
+  CoCurFrame = nullptr;
+  CoTailFrame = nullptr;
+  CoTailCaller = nullptr;
+  CoTailCallee = nullptr;
+  CoTailValuesBase = 0;
+  CoDepth = 0;
+  CoReturnValue = 0;
+  CoSucceeded = true;
+  CoIsFatal = false;
+  ResumeStepLimit = 0;
+  ResumeTimeLimit = 0;
+  ResumeSteps = 0;
+  Paused = false;
+  Cancelled = false;
 }
 
 Interpreter::~Interpreter() {}
 
+void Interpreter::setResumeLimits(uint64_t MaxSteps,
+                                  uint64_t MaxMicroseconds) {
+  ResumeStepLimit = MaxSteps;
+  ResumeTimeLimit = MaxMicroseconds;
+}
+
+bool Interpreter::pauseResume() {
+  if (Paused)
+    return true;
+  if (Cancelled) {
+    Paused = true;
+    return true;
+  }
+  ++ResumeSteps;
+  if (ResumeStepLimit != 0 && ResumeSteps > ResumeStepLimit) {
+    Paused = true;
+    return true;
+  }
+  // Note: Only check the clock (and pause check) periodically, since they
+  // are expensive compared to a step.
+  constexpr uint64_t CheckPeriod = 256;
+  if (ResumeSteps % CheckPeriod != 0)
+    return false;
+  if ((ResumeTimeLimit != 0 &&
+       std::chrono::steady_clock::now() >= ResumeDeadline) ||
+      (ResumePauseCheck && ResumePauseCheck()))
+    Paused = true;
+  return Paused;
+}
+
 void Interpreter::traceEnterFrameInternal() {
   // Note: Enclosed in TRACE_BLOCK so that g++ will not complain when
   // compiled in release mode.
@@ -473,11 +561,13 @@ void Interpreter::reset() {
   CurEvalFrameStack.push_back(0);
   LoopCounter = 0;
   LoopCounterStack.clear();
+  BlockDepth = 0;
   LocalsBase = 0;
   LocalsBaseStack.clear();
   LocalValues.clear();
   OpcodeLocals.reset();
   OpcodeLocalsStack.clear();
+  resetCoroutine();
   Input->reset();
   Output->reset();
 }
@@ -503,6 +593,22 @@ void Interpreter::popAndReturn(decode::IntType Value) {
   Frame.ReturnValue = Value;
 }
 
+void Interpreter::traceEnterBlock() {
+  if (TraceEvents::isRecording()) {
+    if (BlockDepth == 0)
+      TraceEvents::begin("wasm", "section " + std::to_string(LastReadValue));
+    else
+      TraceEvents::begin("wasm", "block");
+  }
+  ++BlockDepth;
+}
+
+void Interpreter::traceExitBlock() {
+  if (BlockDepth > 0)
+    --BlockDepth;
+  TraceEvents::end("wasm");
+}
+
 void Interpreter::callTopLevel(Method Method, const filt::Node* Nd) {
   reset();
   Frame.reset();
@@ -515,6 +621,146 @@ Interpreter::EvalFrame* Interpreter::getCurrentEvalFrame() {
   return EvalFrameStack[CurEvalFrameStack.back()].get();
 }
 
+void Interpreter::pushEvalFrame(const Eval* Caller,
+                                const DefineFrame* DefinedFrame) {
+  size_t CallingEvalIndex = EvalFrameStack.size();
+  CurEvalFrameStack.push_back(CallingEvalIndex);
+  if (FreeEvalFrames.empty()) {
+    EvalFrameStack.push_back(
+        make_unique<EvalFrame>(Caller, DefinedFrame, CallingEvalIndex));
+    return;
+  }
+  EvalFrameStack.push_back(std::move(FreeEvalFrames.back()));
+  FreeEvalFrames.pop_back();
+  EvalFrameStack.back()->init(Caller, DefinedFrame, CallingEvalIndex);
+}
+
+void Interpreter::popEvalFrame() {
+  CurEvalFrameStack.pop_back();
+  FreeEvalFrames.push_back(std::move(EvalFrameStack.back()));
+  EvalFrameStack.pop_back();
+}
+
+bool Interpreter::reuseFrameForTailCall() {
+  // Only the value arguments are evaluated in the calling context. Hence,
+  // the calling frames can't be removed if the called define has expression
+  // arguments.
+  // Also, only apply if the eval frames are not being accessed from a
+  // calling context.
+  size_t NumEvalFrames = EvalFrameStack.size();
+  if (NumEvalFrames < 2 || CurEvalFrameStack.size() != NumEvalFrames + 1 ||
+      CurEvalFrameStack[NumEvalFrames] != NumEvalFrames - 1 ||
+      CurEvalFrameStack[NumEvalFrames - 1] != NumEvalFrames - 2)
+    return false;
+  EvalFrame* CalledFrame = EvalFrameStack.back().get();
+  if (CalledFrame->DefinedFrame->getNumExprArgs() != 0)
+    return false;
+
+  // Verify that the frames between the enclosing eval and this eval do
+  // nothing more than return.
+  const Node* Called = Frame.Nd;
+  size_t NumSequences = 0;
+  size_t Index = FrameStack.size();
+  const Define* Caller = nullptr;
+  while (Caller == nullptr) {
+    if (Index == 0)
+      return false;
+    const CallFrame& F = FrameStack.at(--Index);
+    if (F.CallMethod != Method::Eval || F.CallModifier != Frame.CallModifier)
+      return false;
+    switch (F.Nd->getType()) {
+      case NodeType::Sequence:
+        if (F.CallState != State::Loop ||
+            F.Nd->getKid(F.Nd->getNumKids() - 1) != Called)
+          return false;
+        ++NumSequences;
+        break;
+      case NodeType::IfThenElse:
+        if (F.CallState != State::Exit ||
+            (F.Nd->getKid(1) != Called && F.Nd->getKid(2) != Called))
+          return false;
+        break;
+      case NodeType::Switch:
+        if (F.CallState != State::Exit ||
+            (F.Nd->getKid(1) != Called && !isa<Case>(Called)))
+          return false;
+        break;
+      case NodeType::Case:
+        if (F.CallState != State::Exit ||
+            cast<Case>(F.Nd)->getCaseBody() != Called)
+          return false;
+        break;
+      case NodeType::Define:
+        if (F.CallState != State::Exit ||
+            cast<Define>(F.Nd)->getBody() != Called)
+          return false;
+        Caller = cast<Define>(F.Nd);
+        break;
+      default:
+        return false;
+    }
+    Called = F.Nd;
+  }
+  if (Index == 0)
+    return false;
+  const CallFrame& CallerEval = FrameStack.at(Index - 1);
+  if (CallerEval.Nd->getType() != NodeType::EvalVirtual ||
+      CallerEval.CallState != State::Exit ||
+      CallerEval.CallModifier != Frame.CallModifier)
+    return false;
+
+  // Remove locals of the caller.
+  if (Caller->getNumLocals()) {
+    while (LocalValues.size() > LocalsBase)
+      LocalValues.pop_back();
+    LocalsBaseStack.pop();
+  }
+  // Remove loop counters of this eval, and the enclosing sequences.
+  for (size_t i = 0; i <= NumSequences; ++i)
+    LoopCounterStack.pop();
+  LoopSizeStack.pop_back();
+  LoopSizeStack.back() = CalledFrame->DefinedFrame->getNumValueArgs();
+  // Replace eval frame of caller.
+  CalledFrame->CallingEvalIndex =
+      EvalFrameStack[NumEvalFrames - 2]->CallingEvalIndex;
+  std::swap(EvalFrameStack[NumEvalFrames - 2], EvalFrameStack.back());
+  popEvalFrame();
+  // Replace the call frames, reusing the frame of the enclosing eval.
+  const Node* CalledEval = Frame.Nd;
+  while (FrameStack.size() >= Index)
+    popAndReturn();
+  Frame.Nd = CalledEval;
+  return true;
+}
+
+bool Interpreter::reuseFrameForLoop() {
+  // Note: Only check for the end of the loop when the input can be
+  // processed, as the loop would.
+  if (FrameStack.empty() || !Input->stillMoreInputToProcessNow())
+    return false;
+  const CallFrame& Loop = FrameStack.at(FrameStack.size() - 1);
+  if (Loop.CallMethod != Method::Eval || Loop.CallState != State::Loop ||
+      Loop.CallModifier != Frame.CallModifier ||
+      Loop.Nd->getType() != NodeType::LoopUnbounded ||
+      Loop.Nd->getKid(0) != Frame.Nd || Input->atInputEob())
+    return false;
+  EvalFrame* CalledFrame = getCurrentEvalFrame();
+  if (CalledFrame == nullptr || CalledFrame->Caller != Frame.Nd)
+    return false;
+  traceExitFrame();
+  CalledFrame->init(CalledFrame->Caller, CalledFrame->DefinedFrame,
+                    CalledFrame->CallingEvalIndex);
+  LoopCounter = 0;
+  Frame.CallState = State::Enter;
+  Frame.ReturnValue = 0;
+  traceEnterFrame();
+  // Skip finding the called define, since it doesn't change.
+  Frame.CallState = State::Loop;
+  if (Profile)
+    Profile->step(Frame.Nd, true);
+  return true;
+}
+
 void Interpreter::catchOrElseFail() {
   TRACE_MESSAGE("method failed");
   TRACE(string, "Catch method", getName(Catch));
@@ -560,6 +806,9 @@ void Interpreter::throwMessage(const std::string& Message) {
     // Fail not throw, show context.
     TextWriter Writer;
     for (const auto& F : FrameStack.riterRange(1)) {
+      // Note: Top level frames don't have a node.
+      if (F.Nd == nullptr)
+        continue;
       fprintf(stderr, "In: ");
       Writer.writeAbbrev(stderr, F.Nd);
     }
@@ -576,6 +825,9 @@ void Interpreter::throwMessage(const std::string& Message, IntType Value) {
     // Fail not throw, show context.
     TextWriter Writer;
     for (const auto& F : FrameStack.riterRange(1)) {
+      // Note: Top level frames don't have a node.
+      if (F.Nd == nullptr)
+        continue;
       fprintf(stderr, "In: ");
       Writer.writeAbbrev(stderr, F.Nd);
     }
@@ -602,6 +854,12 @@ void Interpreter::throwCantWrite() {
   fail("Unable to write value");
 }
 
+void Interpreter::returnFormatValue() {
+  if (hasWriteMode() && !Output->writeValue(LastReadValue, Frame.Nd))
+    return throwCantWrite();
+  popAndReturn(LastReadValue);
+}
+
 void Interpreter::throwCantFreezeEof() {
   fail("Unable to set eof on output");
 }
@@ -698,6 +956,13 @@ void Interpreter::algorithmRead() {
   algorithmReadBackFilled();
 }
 
+void Interpreter::algorithmReadDefine(const Define* Defn) {
+  CheckForEof = true;
+  callTopLevel(Flags.UseCoroutines ? Method::EvalCoroutine : Method::Eval,
+               Defn);
+  algorithmReadBackFilled();
+}
+
 void Interpreter::algorithmResume() {
 // TODO(karlschimpf) Add catches for methods that modify local statcks, so
 // that state is correctly cleaned up on a throw.
@@ -705,14 +970,33 @@ void Interpreter::algorithmResume() {
   TRACE_METHOD("resume");
   TRACE_BLOCK({ describeState(tracE.getFile()); });
 #endif
+  if (Cancelled)
+    return fail("Evaluation cancelled");
+  Paused = false;
+  ResumeSteps = 0;
+  if (ResumeTimeLimit != 0)
+    ResumeDeadline = std::chrono::steady_clock::now() +
+                     std::chrono::microseconds(ResumeTimeLimit);
   if (!Input->canProcessMoreInputNow())
     return;
+  PauseProfileAtExit PauseProfile(Profile.get());
   while (Input->stillMoreInputToProcessNow()) {
     if (errorsFound())
       break;
+    if (pauseResume()) {
+      if (Cancelled)
+        return fail("Evaluation cancelled");
+      break;
+    }
 #if LOG_CALLSTACKS
     TRACE_BLOCK({ describeState(tracE.getFile()); });
 #endif
+    if (Profile) {
+      // Note: Only Method::Eval frames are guaranteed to have a node.
+      bool IsEval = Frame.CallMethod == Method::Eval;
+      Profile->step(IsEval ? Frame.Nd : nullptr,
+                    IsEval && Frame.CallState == State::Enter);
+    }
     switch (Frame.CallMethod) {
       default:
         return handleOtherMethods();
@@ -976,24 +1260,49 @@ void Interpreter::algorithmResume() {
                 return failBadState();
             }
             break;
+          // Note: Each format calls its own read method, so that the
+          // reader doesn't need to dispatch on the format node again.
           case NodeType::Bit:
+            if (hasReadMode())
+              LastReadValue = Input->readBit();
+            returnFormatValue();
+            break;
           case NodeType::Uint32:
+            if (hasReadMode())
+              LastReadValue = Input->readUint32();
+            returnFormatValue();
+            break;
           case NodeType::Uint64:
+            if (hasReadMode())
+              LastReadValue = Input->readUint64();
+            returnFormatValue();
+            break;
           case NodeType::Uint8:
+            if (hasReadMode())
+              LastReadValue = Input->readUint8();
+            returnFormatValue();
+            break;
           case NodeType::Varint32:
+            if (hasReadMode())
+              LastReadValue = Input->readVarint32();
+            returnFormatValue();
+            break;
           case NodeType::Varint64:
+            if (hasReadMode())
+              LastReadValue = Input->readVarint64();
+            returnFormatValue();
+            break;
           case NodeType::Varuint32:
-          case NodeType::Varuint64: {
             if (hasReadMode())
-              if (!Input->readValue(Frame.Nd, LastReadValue))
-                return throwCantRead();
-            if (hasWriteMode()) {
-              if (!Output->writeValue(LastReadValue, Frame.Nd))
-                return throwCantWrite();
-            }
-            popAndReturn(LastReadValue);
+              LastReadValue = Input->readVaruint32();
+            returnFormatValue();
             break;
-          }
+          case NodeType::Varuint64:
+            if (hasReadMode())
+              LastReadValue = Input->readVaruint64();
+            returnFormatValue();
+            break;
+          case NodeType::BinaryAdaptive:
           case NodeType::BinaryEval:
             if (hasReadMode()) {
               if (!Input->readBinary(Frame.Nd, LastReadValue))
@@ -1453,30 +1762,31 @@ void Interpreter::algorithmResume() {
             switch (Frame.CallState) {
               case State::Enter: {
                 const Eval* EvalNd = cast<Eval>(Frame.Nd);
-                const Symbol* Sym = EvalNd->getCallName();
-                const Define* Defn =
-                    Symtab->getSymbolDefn(Sym)->getDefineDefinition();
+                const Define* Defn = Symtab->getBoundDefine(EvalNd);
                 if (Defn == nullptr) {
-                  fprintf(stderr, "Eval can't find definition: %s\n",
-                          Sym->getName().c_str());
-                  return throwMessage("Unable to evaluate call");
+                  // Not bound when installed, lookup and check call.
+                  const Symbol* Sym = EvalNd->getCallName();
+                  Defn = Symtab->getSymbolDefn(Sym)->getDefineDefinition();
+                  if (Defn == nullptr) {
+                    fprintf(stderr, "Eval can't find definition: %s\n",
+                            Sym->getName().c_str());
+                    return throwMessage("Unable to evaluate call");
+                  }
+                  size_t NumParams = Defn->getNumArgs();
+                  int NumCallArgs = Frame.Nd->getNumKids() - 1;
+                  if (NumParams != size_t(NumCallArgs)) {
+                    fprintf(stderr,
+                            "Definition %s expects %" PRIuMAX
+                            "parameters, found: %" PRIuMAX "\n",
+                            Sym->getName().c_str(), uintmax_t(NumParams),
+                            uintmax_t(NumCallArgs));
+                    return throwMessage("Unable to evaluate call");
+                  }
                 }
+                if (Defn->needsInstall() && !Symtab->installDefinition(Defn))
+                  return throwMessage("Unable to install definition");
                 DefineFrame* DefFrame = Defn->getDefineFrame();
-                size_t NumParams = DefFrame->getNumArgs();
-                int NumCallArgs = Frame.Nd->getNumKids() - 1;
-                if (NumParams != size_t(NumCallArgs)) {
-                  fprintf(stderr,
-                          "Definition %s expects %" PRIuMAX
-                          "parameters, found: %" PRIuMAX "\n",
-                          Sym->getName().c_str(), uintmax_t(NumParams),
-                          uintmax_t(NumCallArgs));
-                  return throwMessage("Unable to evaluate call");
-                }
-                size_t CallingEvalIndex = EvalFrameStack.size();
-                CurEvalFrameStack.push_back(CallingEvalIndex);
-                std::unique_ptr<EvalFrame> CalledFrame = make_unique<EvalFrame>(
-                    cast<Eval>(Frame.Nd), DefFrame, CallingEvalIndex);
-                EvalFrameStack.push_back(std::move(CalledFrame));
+                pushEvalFrame(EvalNd, DefFrame);
                 LoopCounterStack.push(0);
                 LoopSizeStack.push_back(DefFrame->getNumValueArgs());
                 Frame.CallState = State::Loop;
@@ -1506,17 +1816,37 @@ void Interpreter::algorithmResume() {
                 break;
               }
               case State::Step3: {
-                const Eval* EvalNd = cast<Eval>(Frame.Nd);
-                const Symbol* Sym = EvalNd->getCallName();
-                const Define* Defn =
-                    Symtab->getSymbolDefn(Sym)->getDefineDefinition();
+                if (cast<Eval>(Frame.Nd)->isTailCall())
+                  reuseFrameForTailCall();
+                EvalFrame* CalledFrame = getCurrentEvalFrame();
+                const Define* Defn = CalledFrame->DefinedFrame->getDefine();
                 Frame.CallState = State::Exit;
+                if (Flags.MemoizePureDefines && Symtab->isPureDefine(Defn)) {
+                  // Note: Exit returns the last read value.
+                  if (Memo->lookup(Symtab.get(), Defn,
+                                   uint32_t(Frame.CallModifier),
+                                   LastReadValue, CalledFrame->Values.data(),
+                                   CalledFrame->Values.size(), LastReadValue))
+                    break;
+                  CalledFrame->IsMemoized = true;
+                  CalledFrame->MemoLastRead = LastReadValue;
+                }
                 call(Method::Eval, Frame.CallModifier, Defn);
                 break;
               }
               case State::Exit:
-                CurEvalFrameStack.pop_back();
-                EvalFrameStack.pop_back();
+                if (const EvalFrame* CalledFrame = getCurrentEvalFrame()) {
+                  if (CalledFrame->IsMemoized)
+                    Memo->insert(Symtab,
+                                 CalledFrame->DefinedFrame->getDefine(),
+                                 uint32_t(Frame.CallModifier),
+                                 CalledFrame->MemoLastRead,
+                                 CalledFrame->Values.data(),
+                                 CalledFrame->Values.size(), LastReadValue);
+                }
+                if (reuseFrameForLoop())
+                  break;
+                popEvalFrame();
                 LoopCounterStack.pop();
                 LoopSizeStack.pop_back();
                 popAndReturn(LastReadValue);
@@ -1572,6 +1902,7 @@ void Interpreter::algorithmResume() {
             if (!Input->readAction(EnterBlock) ||
                 !Output->writeAction(EnterBlock))
               return fatal("Unable to enter block");
+            traceEnterBlock();
             Frame.CallState = State::Exit;
             call(DispatchedMethod, Frame.CallModifier, Frame.Nd);
             break;
@@ -1581,6 +1912,7 @@ void Interpreter::algorithmResume() {
             if (!Input->readAction(ExitBlock) ||
                 !Output->writeAction(ExitBlock))
               return fatal("unable to close block");
+            traceExitBlock();
             popAndReturn();
             break;
           }
@@ -1588,6 +1920,9 @@ void Interpreter::algorithmResume() {
             return failBadState();
         }
         break;
+      case Method::EvalCoroutine:
+        resumeCoroutine();
+        break;
       case Method::EvalInCallingContext:
         switch (Frame.CallState) {
           case State::Enter: {
@@ -1740,10 +2075,14 @@ void Interpreter::algorithmResume() {
             Symbol* File = Symtab->getPredefined(PredefinedSymbol::File);
             if (File == nullptr)
               throwMessage("Can't find sexpression to process file");
-            const Node* FileDefn = File->getDefineDefinition();
+            const Define* FileDefn = File->getDefineDefinition();
             if (FileDefn == nullptr)
-              throwMessage("Can't find sexpression to process file");
-            call(Method::Eval, Frame.CallModifier, FileDefn);
+              return throwMessage("Can't find sexpression to process file");
+            if (FileDefn->needsInstall() &&
+                !Symtab->installDefinition(FileDefn))
+              return throwMessage("Unable to install definition");
+            call(Flags.UseCoroutines ? Method::EvalCoroutine : Method::Eval,
+                 Frame.CallModifier, FileDefn);
             break;
           }
           case State::Exit:
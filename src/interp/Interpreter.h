@@ -20,6 +20,10 @@
 #ifndef DECOMPRESSOR_SRC_INTERP_INTERPRETER_H_
 #define DECOMPRESSOR_SRC_INTERP_INTERPRETER_H_
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+
 #include "interp/Interpreter-defs.h"
 #include "interp/InterpreterFlags.h"
 #include "stream/ValueFormat.h"
@@ -31,6 +35,7 @@ namespace wasm {
 namespace filt {
 
 class Case;
+class Define;
 class DefineFrame;
 class Eval;
 class Header;
@@ -40,11 +45,19 @@ class TextWriter;
 
 }  // end of namespace filt.
 
+namespace utils {
+
+class Coroutine;
+
+}  // end of namespace utils.
+
 namespace interp {
 
 class AlgorithmSelector;
+class DefineMemo;
 class Interpreter;
 class Reader;
+class SourceProfile;
 class Writer;
 
 class Interpreter {
@@ -103,11 +116,33 @@ class Interpreter {
   // Resume should be called until isFinished() is true.
   void algorithmResume();
 
+  // Limits the work done by each call to algorithmResume(), to MaxSteps
+  // evaluation steps and MaxMicroseconds of elapsed time. Zero implies no
+  // limit. When reached, algorithmResume() returns with isPaused() true, and
+  // the next call continues where it left off (even if no input was added).
+  void setResumeLimits(uint64_t MaxSteps, uint64_t MaxMicroseconds);
+  // Adds a check, called periodically by algorithmResume(), that pauses
+  // when it returns true.
+  void setResumePauseCheck(std::function<bool()> Check) {
+    ResumePauseCheck = Check;
+  }
+  // Returns true if the last call to algorithmResume() stopped at a limit.
+  bool isPaused() const { return Paused; }
+
+  // Cancels evaluation. May be called from another thread, in which case
+  // the running (or next) call to algorithmResume() fails.
+  void cancel() { Cancelled = true; }
+  bool isCancelled() const { return Cancelled; }
+
   // Reads from backfilled input stream.
   void algorithmReadBackFilled();
 
   void algorithmRead();
 
+  // Reads the (backfilled) input by evaluating Defn, without reading (or
+  // writing) a file header. Used to read parts of a file separately.
+  void algorithmReadDefine(const filt::Define* Defn);
+
   // Check status of read.
   bool isFinished() const { return Frame.CallMethod == Method::Finished; }
   bool isSuccessful() const { return Frame.CallState == State::Succeeded; }
@@ -146,6 +181,11 @@ class Interpreter {
   std::shared_ptr<utils::TraceClass> getTracePtr();
   utils::TraceClass& getTrace() { return *getTracePtr(); }
 
+  // When set, evaluation is profiled by source line.
+  void setSourceProfile(std::shared_ptr<SourceProfile> NewValue) {
+    Profile = NewValue;
+  }
+
   enum class SectionCode : uint32_t {
 #define X(code, value) code = value,
     SECTION_CODES_TABLE
@@ -206,6 +246,9 @@ class Interpreter {
     EvalFrame(const EvalFrame& F);
     bool isDefined() const;
     void reset();
+    void init(const filt::Eval* Caller,
+              const filt::DefineFrame* DefinedFrame,
+              size_t CallingEvalIndex);
     decode::IntType getValueParam(size_t Index) const;
     void setValueParam(size_t Index, decode::IntType Value);
     decode::IntType getLocal(size_t Index) const;
@@ -215,6 +258,10 @@ class Interpreter {
     const filt::DefineFrame* DefinedFrame;
     size_t CallingEvalIndex;
     std::vector<decode::IntType> Values;
+    // True if the result of the call should be memoized on exit, using the
+    // last read value on entry.
+    bool IsMemoized;
+    decode::IntType MemoLastRead;
   };
 
   std::shared_ptr<Reader> Input;
@@ -235,6 +282,21 @@ class Interpreter {
   // Trace object to use, if applicable.
   std::shared_ptr<utils::TraceClass> Trace;
 
+  // Source line profile, if applicable.
+  std::shared_ptr<SourceProfile> Profile;
+
+  // Cached results of pure defines (used if Flags.MemoizePureDefines).
+  std::unique_ptr<DefineMemo> Memo;
+
+  // Limits on the work done by each call to algorithmResume().
+  uint64_t ResumeStepLimit;
+  uint64_t ResumeTimeLimit;
+  std::function<bool()> ResumePauseCheck;
+  uint64_t ResumeSteps;
+  std::chrono::steady_clock::time_point ResumeDeadline;
+  bool Paused;
+  std::atomic<bool> Cancelled;
+
   // Defines method to fail back to (defaults to
   // NO_SUCH_METHOD). Allows equivalent of simple throws.
   Method Catch;
@@ -245,12 +307,16 @@ class Interpreter {
   // catches.
   bool IsFatalFailure;
   bool CheckForEof;
+  // The number of enclosing blocks (top-level blocks are sections).
+  size_t BlockDepth;
   // The stack of called methods.
   CallFrame Frame;
   utils::ValueStack<CallFrame> FrameStack;
   // The stack of (eval) calls.
   std::vector<std::unique_ptr<EvalFrame>> EvalFrameStack;
   std::vector<size_t> CurEvalFrameStack;
+  // Popped eval frames, reused by later calls.
+  std::vector<std::unique_ptr<EvalFrame>> FreeEvalFrames;
   // The stack of loop counters.
   size_t LoopCounter;
   utils::ValueStack<size_t> LoopCounterStack;
@@ -280,6 +346,34 @@ class Interpreter {
   const filt::Header* HeaderOverride;
   bool FreezeEofAtExit;
 
+  // State of the coroutine engine (see InterpreterCoroutine.cpp). Eval frames
+  // live on the coroutine stack, and refer to their parameter values
+  // (starting at ValuesBase) in CoValues.
+  struct CoEvalFrame {
+    const filt::Eval* Caller;
+    const filt::DefineFrame* DefinedFrame;
+    size_t ValuesBase;
+    const CoEvalFrame* CallingFrame;
+  };
+  std::unique_ptr<utils::Coroutine> Coro;
+  const CoEvalFrame* CoCurFrame;
+  // The frame of the innermost eval whose (non-memoized) define is running.
+  // A call in tail position of the define reuses the frame: it only
+  // evaluates its value arguments (starting at CoTailValuesBase), and then
+  // returns, so that the eval calls CoTailCallee instead.
+  CoEvalFrame* CoTailFrame;
+  const filt::Eval* CoTailCaller;
+  const filt::Define* CoTailCallee;
+  size_t CoTailValuesBase;
+  // Number of nested coEval() calls, bounded so that deep recursion fails
+  // rather than overflowing the coroutine stack.
+  size_t CoDepth;
+  std::vector<decode::IntType> CoValues;
+  decode::IntType CoReturnValue;
+  bool CoSucceeded;
+  bool CoIsFatal;
+  std::string CoMessage;
+
   void reset();
   void algorithmStart(Method M) { callTopLevel(M, nullptr); }
   void handleOtherMethods();
@@ -292,7 +386,54 @@ class Interpreter {
 
   void popAndReturn(decode::IntType Value = 0);
 
+  // Counts an evaluation step of algorithmResume(), and returns true if it
+  // should pause (or has been cancelled).
+  bool pauseResume();
+  // Writes (if in write mode) and returns LastReadValue, using the format
+  // node of the current frame.
+  void returnFormatValue();
+
+  // Records block spans in the trace-event timeline (if recording).
+  void traceEnterBlock();
+  void traceExitBlock();
+
   EvalFrame* getCurrentEvalFrame();
+  void pushEvalFrame(const filt::Eval* Caller,
+                     const filt::DefineFrame* DefinedFrame);
+  void popEvalFrame();
+
+  // Handles Method::EvalCoroutine, which evaluates Frame.Nd on a coroutine.
+  void resumeCoroutine();
+  void resetCoroutine();
+
+  // The recursive evaluator run by the coroutine. Returns false (after
+  // recording the error in CoMessage) if unable to evaluate.
+  bool coEval(MethodModifier Modifier,
+              const filt::Node* Nd,
+              decode::IntType& Value);
+  bool coEvalInCallingContext(MethodModifier Modifier,
+                              const filt::Node* Nd,
+                              decode::IntType& Value);
+  bool coEvalBlock(MethodModifier Modifier, const filt::Node* Nd);
+  bool coPeek(const filt::Node* Nd, decode::IntType& Value);
+  bool coThrow(const std::string& Message);
+  bool coFail(const std::string& Message);
+  // Writes (if a write modifier) and returns LastReadValue, using format Nd.
+  bool coReturnFormatValue(MethodModifier Modifier,
+                           const filt::Node* Nd,
+                           decode::IntType& Value);
+  // Suspends the coroutine until the input can be processed (and
+  // algorithmResume() isn't paused). Called before reading the input.
+  void coWaitForInput();
+
+  // Called when the (top) eval frame is a tail call, and its arguments have
+  // been evaluated. If the frames of the enclosing call are no longer needed,
+  // replaces them with the called frames and returns true.
+  bool reuseFrameForTailCall();
+  // Called when the (top) eval frame exits. If the eval is the body of an
+  // unbounded loop that continues, restarts the call (reusing its frames)
+  // and returns true.
+  bool reuseFrameForLoop();
 
   // For debugging only.
   void traceEnterFrame();
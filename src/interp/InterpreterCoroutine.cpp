@@ -0,0 +1,680 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements the coroutine engine of the interpreter.
+//
+// Rather than splitting each construct into explicit states, the coroutine
+// engine evaluates nodes with ordinary recursive code, running on its own
+// (coroutine) stack. When the input can't be processed (i.e. more input
+// must be added), the coroutine yields back to algorithmResume(), and is
+// resumed when algorithmResume() is called again.
+//
+// The semantics (including values returned by each construct) follow
+// Method::Eval of the state machine in Interpreter.cpp. Errors are recorded
+// and returned as false, and then thrown (using the normal throw mechanism)
+// once the coroutine has returned.
+
+#include "interp/Interpreter.h"
+
+#include "interp/DefineMemo.h"
+#include "interp/Reader.h"
+#include "interp/SourceProfile.h"
+#include "interp/Writer.h"
+#include "sexp/Ast.h"
+#include "utils/Casting.h"
+#include "utils/Coroutine.h"
+
+#include <cinttypes>
+
+namespace wasm {
+
+using namespace decode;
+using namespace filt;
+using namespace utils;
+
+namespace interp {
+
+namespace {
+
+// Note: Assumes that each nested coEval() uses at most 1K bytes of the
+// coroutine stack (it uses about 320 bytes when optimized).
+constexpr size_t MaxCoDepth = Coroutine::DefaultStackSize / 1024;
+
+class CoDepthScope {
+  CoDepthScope() = delete;
+  CoDepthScope(const CoDepthScope&) = delete;
+  CoDepthScope& operator=(const CoDepthScope&) = delete;
+
+ public:
+  explicit CoDepthScope(size_t& Depth) : Depth(Depth) { ++Depth; }
+  ~CoDepthScope() { --Depth; }
+
+ private:
+  size_t& Depth;
+};
+
+}  // end of anonymous namespace
+
+void Interpreter::resumeCoroutine() {
+  switch (Frame.CallState) {
+    case State::Enter: {
+      resetCoroutine();
+      const Node* Nd = Frame.Nd;
+      MethodModifier Modifier = Frame.CallModifier;
+      CoSucceeded = true;
+      CoIsFatal = false;
+      CoReturnValue = 0;
+      Coro = make_unique<Coroutine>([this, Modifier, Nd]() {
+        CoSucceeded = coEval(Modifier, Nd, CoReturnValue);
+      });
+      Frame.CallState = State::Loop;
+      break;
+    }
+    case State::Loop:
+      Coro->resume();
+      if (!Coro->isDone())
+        // Waiting for more input.
+        break;
+      resetCoroutine();
+      if (!CoSucceeded) {
+        if (CoIsFatal)
+          return fail(CoMessage);
+        return throwMessage(CoMessage);
+      }
+      popAndReturn(CoReturnValue);
+      break;
+    default:
+      return failBadState();
+  }
+}
+
+void Interpreter::resetCoroutine() {
+  Coro.reset();
+  CoCurFrame = nullptr;
+  CoTailFrame = nullptr;
+  CoTailCaller = nullptr;
+  CoTailCallee = nullptr;
+  CoDepth = 0;
+  CoValues.clear();
+}
+
+void Interpreter::coWaitForInput() {
+  while (!Input->stillMoreInputToProcessNow() || pauseResume())
+    Coro->yield();
+}
+
+bool Interpreter::coThrow(const std::string& Message) {
+  CoMessage = Message;
+  CoIsFatal = false;
+  return false;
+}
+
+bool Interpreter::coFail(const std::string& Message) {
+  CoMessage = Message;
+  CoIsFatal = true;
+  return false;
+}
+
+bool Interpreter::coReturnFormatValue(MethodModifier Modifier,
+                                      const Node* Nd,
+                                      IntType& Value) {
+  if (isWriteModifier(Modifier) && !Output->writeValue(LastReadValue, Nd))
+    return coFail("Unable to write value");
+  Value = LastReadValue;
+  return true;
+}
+
+bool Interpreter::coEvalInCallingContext(MethodModifier Modifier,
+                                         const Node* Nd,
+                                         IntType& Value) {
+  const CoEvalFrame* Frame = CoCurFrame;
+  CoCurFrame = Frame ? Frame->CallingFrame : nullptr;
+  if (!coEval(Modifier, Nd, Value))
+    return false;
+  CoCurFrame = Frame;
+  return true;
+}
+
+bool Interpreter::coPeek(const Node* Nd, IntType& Value) {
+  if (!Input->pushPeekPos())
+    return coFail("Bad internal decompressor state: peek");
+  if (!coEval(MethodModifier::ReadOnly, Nd, Value))
+    return false;
+  if (!Input->popPeekPos())
+    return coFail("Bad internal decompressor state: peek");
+  return true;
+}
+
+bool Interpreter::coEvalBlock(MethodModifier Modifier, const Node* Nd) {
+  IntType EnterBlock = IntType(PredefinedSymbol::Block_enter);
+  coWaitForInput();
+  if (!Input->readAction(EnterBlock) || !Output->writeAction(EnterBlock))
+    fatal("Unable to enter block");
+  traceEnterBlock();
+  IntType Ignored;
+  if (!coEval(Modifier, Nd, Ignored))
+    return false;
+  coWaitForInput();
+  IntType ExitBlock = IntType(PredefinedSymbol::Block_exit);
+  if (!Input->readAction(ExitBlock) || !Output->writeAction(ExitBlock))
+    fatal("unable to close block");
+  traceExitBlock();
+  return true;
+}
+
+bool Interpreter::coEval(MethodModifier Modifier,
+                         const Node* Nd,
+                         IntType& Value) {
+  CoDepthScope Scope(CoDepth);
+  if (CoDepth > MaxCoDepth)
+    return coFail("Nesting too deep, unable to evaluate algorithm");
+  if (Profile)
+    Profile->step(Nd, true);
+  Value = 0;
+  switch (Nd->getType()) {
+    case NodeType::NO_SUCH_NODETYPE:
+    case NodeType::Algorithm:
+    case NodeType::AlgorithmFlag:
+    case NodeType::AlgorithmName:
+    case NodeType::BinaryAccept:
+    case NodeType::BinaryEvalBits:
+    case NodeType::BinarySelect:
+    case NodeType::EnclosingAlgorithms:
+    case NodeType::IntLookup:
+    case NodeType::NoLocals:
+    case NodeType::NoParams:
+    case NodeType::ParamArgs:
+    case NodeType::ParamCached:
+    case NodeType::ParamExprs:
+    case NodeType::ParamExprsCached:
+    case NodeType::ParamValues:
+    case NodeType::LastSymbolIs:
+    case NodeType::LiteralActionBase:
+    case NodeType::LiteralActionDef:
+    case NodeType::LiteralDef:
+    case NodeType::Locals:
+    case NodeType::Rename:
+    case NodeType::Symbol:
+    case NodeType::SymbolDefn:
+    case NodeType::Undefine:
+    case NodeType::UnknownSection:
+      return coFail("Method not implemented!");
+    case NodeType::Error:
+      return coThrow("Algorithm error!");
+    case NodeType::ReadHeader:
+    case NodeType::SourceHeader:
+    case NodeType::WriteHeader:
+      for (int i = 0, NumKids = Nd->getNumKids(); i < NumKids; ++i) {
+        auto Lit = dyn_cast<IntegerNode>(Nd->getKid(i));
+        if (Lit == nullptr)
+          return coThrow("Literal header value expected, but not found");
+        IntType WantedValue = Lit->getValue();
+        if (!Lit->definesIntTypeFormat())
+          return coThrow("Format header contains badly formed constant");
+        IntTypeFormat TypeFormat = Lit->getIntTypeFormat();
+        if (isReadModifier(Modifier)) {
+          coWaitForInput();
+          IntType FoundValue;
+          if (!Input->readHeaderValue(TypeFormat, FoundValue))
+            return coThrow("Unable to read header value");
+          if (WantedValue != FoundValue)
+            return coThrow("Wanted header value " +
+                           std::to_string(WantedValue) + " but found " +
+                           std::to_string(FoundValue));
+        }
+        if (isWriteModifier(Modifier))
+          Output->writeHeaderValue(WantedValue, TypeFormat);
+      }
+      return true;
+    case NodeType::BitwiseAnd:
+    case NodeType::BitwiseOr:
+    case NodeType::BitwiseXor: {
+      if (!isReadModifier(Modifier))
+        return coFail("Method can only be processed in read mode");
+      IntType Arg1;
+      IntType Arg2;
+      if (!coEval(Modifier, Nd->getKid(0), Arg1) ||
+          !coEval(Modifier, Nd->getKid(1), Arg2))
+        return false;
+      switch (Nd->getType()) {
+        case NodeType::BitwiseAnd:
+          Value = Arg1 & Arg2;
+          break;
+        case NodeType::BitwiseOr:
+          Value = Arg1 | Arg2;
+          break;
+        default:
+          Value = Arg1 ^ Arg2;
+          break;
+      }
+      return true;
+    }
+    case NodeType::BitwiseNegate:
+      if (!isReadModifier(Modifier))
+        return coFail("Method can only be processed in read mode");
+      if (!coEval(Modifier, Nd->getKid(0), Value))
+        return false;
+      Value = ~Value;
+      return true;
+    case NodeType::Callback: {
+      IntType Action = cast<Callback>(Nd)->getIntNode()->getValue();
+      coWaitForInput();
+      if (!Input->readAction(Action))
+        return coThrow("Unable to read value");
+      if (!Output->writeAction(Action))
+        return coFail("Unable to write value");
+      Value = LastReadValue;
+      return true;
+    }
+    case NodeType::I32Const:
+    case NodeType::I64Const:
+    case NodeType::One:
+    case NodeType::U8Const:
+    case NodeType::U32Const:
+    case NodeType::U64Const:
+    case NodeType::Zero:
+      Value = cast<IntegerNode>(Nd)->getValue();
+      if (isReadModifier(Modifier))
+        LastReadValue = Value;
+      return true;
+    case NodeType::LastRead:
+      Value = LastReadValue;
+      return true;
+    case NodeType::Local: {
+      size_t Index = cast<Local>(Nd)->getValue();
+      if (LocalsBase + Index >= LocalValues.size())
+        return coThrow("Local variable index out of range!");
+      Value = LocalValues[LocalsBase + Index];
+      return true;
+    }
+    case NodeType::Peek:
+      return coPeek(Nd->getKid(0), Value);
+    case NodeType::Read:
+      return coEval(MethodModifier::ReadOnly, Nd->getKid(0), Value);
+    // Note: Each format calls its own read method, so that the reader
+    // doesn't need to dispatch on the format node again.
+    case NodeType::Bit:
+      if (isReadModifier(Modifier)) {
+        coWaitForInput();
+        LastReadValue = Input->readBit();
+      }
+      return coReturnFormatValue(Modifier, Nd, Value);
+    case NodeType::Uint32:
+      if (isReadModifier(Modifier)) {
+        coWaitForInput();
+        LastReadValue = Input->readUint32();
+      }
+      return coReturnFormatValue(Modifier, Nd, Value);
+    case NodeType::Uint64:
+      if (isReadModifier(Modifier)) {
+        coWaitForInput();
+        LastReadValue = Input->readUint64();
+      }
+      return coReturnFormatValue(Modifier, Nd, Value);
+    case NodeType::Uint8:
+      if (isReadModifier(Modifier)) {
+        coWaitForInput();
+        LastReadValue = Input->readUint8();
+      }
+      return coReturnFormatValue(Modifier, Nd, Value);
+    case NodeType::Varint32:
+      if (isReadModifier(Modifier)) {
+        coWaitForInput();
+        LastReadValue = Input->readVarint32();
+      }
+      return coReturnFormatValue(Modifier, Nd, Value);
+    case NodeType::Varint64:
+      if (isReadModifier(Modifier)) {
+        coWaitForInput();
+        LastReadValue = Input->readVarint64();
+      }
+      return coReturnFormatValue(Modifier, Nd, Value);
+    case NodeType::Varuint32:
+      if (isReadModifier(Modifier)) {
+        coWaitForInput();
+        LastReadValue = Input->readVaruint32();
+      }
+      return coReturnFormatValue(Modifier, Nd, Value);
+    case NodeType::Varuint64:
+      if (isReadModifier(Modifier)) {
+        coWaitForInput();
+        LastReadValue = Input->readVaruint64();
+      }
+      return coReturnFormatValue(Modifier, Nd, Value);
+    case NodeType::BinaryAdaptive:
+    case NodeType::BinaryEval:
+      if (isReadModifier(Modifier)) {
+        coWaitForInput();
+        if (!Input->readBinary(Nd, LastReadValue))
+          return coThrow("Unable to read value");
+      }
+      if (isWriteModifier(Modifier) &&
+          !Output->writeBinary(LastReadValue, Nd))
+        return coFail("Unable to write value");
+      Value = LastReadValue;
+      return true;
+    case NodeType::Map: {
+      if (!coEval(Modifier, Nd->getKid(0), Value))
+        return false;
+      LastReadValue = Value;
+      if (const Node* Cse = cast<Map>(Nd)->getCase(Value)) {
+        if (!coPeek(Cse, Value))
+          return false;
+        LastReadValue = Value;
+      }
+      return true;
+    }
+    case NodeType::Opcode:
+      return coThrow("Multibyte opcodes broken!");
+    case NodeType::Set: {
+      IntType NewValue;
+      if (!coEval(Modifier, Nd->getKid(1), NewValue))
+        return false;
+      size_t Index = cast<Local>(Nd->getKid(0))->getValue();
+      if (LocalsBase + Index >= LocalValues.size())
+        return coThrow("Local variable index out of range, can't set!");
+      LocalValues[LocalsBase + Index] = NewValue;
+      Value = LastReadValue;
+      return true;
+    }
+    case NodeType::Write: {
+      IntType Ignored;
+      for (int i = 1, NumKids = Nd->getNumKids(); i < NumKids; ++i) {
+        if (!coEval(MethodModifier::ReadOnly, Nd->getKid(i), Ignored) ||
+            !coEval(MethodModifier::WriteOnly, Nd->getKid(0), Value))
+          return false;
+      }
+      return true;
+    }
+    case NodeType::Not:
+      // Note: Matches Method::Eval, which returns the value of the argument.
+      if (!isReadModifier(Modifier))
+        return coFail("Method can only be processed in read mode");
+      return coEval(Modifier, Nd->getKid(0), Value);
+    case NodeType::And:
+    case NodeType::Or:
+      if (!isReadModifier(Modifier))
+        return coFail("Method can only be processed in read mode");
+      if (!coEval(Modifier, Nd->getKid(0), Value))
+        return false;
+      if ((Value != 0) == (Nd->getType() == NodeType::And))
+        return coEval(Modifier, Nd->getKid(1), Value);
+      return true;
+    case NodeType::Sequence: {
+      IntType Ignored;
+      for (const Node* Kid : *Nd)
+        if (!coEval(Modifier, Kid, Ignored))
+          return false;
+      Value = LastReadValue;
+      return true;
+    }
+    case NodeType::Table: {
+      IntType Key;
+      if (!coEval(Modifier, Nd->getKid(0), Key))
+        return false;
+      switch (Flags.MacroContext) {
+        case MacroDirective::Expand:
+          if (isReadModifier(Modifier) && !Input->tablePush(Key))
+            return coThrow("Unable to read value");
+          break;
+        case MacroDirective::Contract:
+          if (isWriteModifier(Modifier) && !Output->tablePush(Key))
+            return coFail("Unable to write value");
+          break;
+      }
+      IntType Ignored;
+      if (!coEval(Modifier, Nd->getKid(1), Ignored))
+        return false;
+      switch (Flags.MacroContext) {
+        case MacroDirective::Expand:
+          if (isReadModifier(Modifier) && !Input->tablePop())
+            return coThrow("Unable to read value");
+          break;
+        case MacroDirective::Contract:
+          if (isWriteModifier(Modifier) && !Output->tablePop())
+            return coFail("Unable to write value");
+          break;
+      }
+      Value = LastReadValue;
+      return true;
+    }
+    case NodeType::Loop: {
+      IntType Count;
+      if (!coEval(Modifier, Nd->getKid(0), Count))
+        return false;
+      const Node* Body = Nd->getKid(1);
+      IntType Ignored;
+      for (; Count != 0; --Count)
+        if (!coEval(Modifier, Body, Ignored))
+          return false;
+      return true;
+    }
+    case NodeType::LoopUnbounded: {
+      const Node* Body = Nd->getKid(0);
+      IntType Ignored;
+      while (true) {
+        coWaitForInput();
+        if (Input->atInputEob())
+          return true;
+        if (!coEval(Modifier, Body, Ignored))
+          return false;
+      }
+    }
+    case NodeType::IfThen: {
+      IntType Cond;
+      IntType Ignored;
+      if (!coEval(Modifier, Nd->getKid(0), Cond))
+        return false;
+      return Cond == 0 || coEval(Modifier, Nd->getKid(1), Ignored);
+    }
+    case NodeType::IfThenElse: {
+      IntType Cond;
+      IntType Ignored;
+      if (!coEval(Modifier, Nd->getKid(0), Cond))
+        return false;
+      return coEval(Modifier, Nd->getKid(Cond ? 1 : 2), Ignored);
+    }
+    case NodeType::Switch: {
+      IntType Selector;
+      IntType Ignored;
+      if (!coEval(Modifier, Nd->getKid(0), Selector))
+        return false;
+      const auto* Sel = cast<Switch>(Nd);
+      if (const auto* Case = Sel->getCase(Selector))
+        return coEval(Modifier, Case, Ignored);
+      return coEval(Modifier, Sel->getKid(1), Ignored);
+    }
+    case NodeType::Case:
+      if (!coEval(Modifier, cast<Case>(Nd)->getCaseBody(), Value))
+        return false;
+      LastReadValue = Value;
+      return true;
+    case NodeType::Define: {
+      const Define* Def = cast<Define>(Nd);
+      size_t NumLocals = Def->getNumLocals();
+      if (NumLocals) {
+        LocalsBaseStack.push(LocalValues.size());
+        LocalValues.resize(LocalValues.size() + NumLocals, 0);
+      }
+      IntType Ignored;
+      if (!coEval(Modifier, Def->getBody(), Ignored))
+        return false;
+      if (NumLocals) {
+        LocalValues.resize(LocalsBase);
+        LocalsBaseStack.pop();
+      }
+      return true;
+    }
+    case NodeType::Param: {
+      const CoEvalFrame* CallingFrame = CoCurFrame;
+      if (CallingFrame == nullptr)
+        return coThrow("Parameter reference not in called method");
+      IntType ParamIndex = cast<Param>(Nd)->getValue();
+      const DefineFrame* DefFrame = CallingFrame->DefinedFrame;
+      if (ParamIndex >= DefFrame->getNumArgs())
+        return coThrow("Parameter reference doesn't match callling context!");
+      NodeType ParamTy = DefFrame->getArgType(ParamIndex);
+      switch (ParamTy) {
+        case NodeType::ParamValues:
+          Value = CoValues[CallingFrame->ValuesBase +
+                           DefFrame->getValueArgIndex(ParamIndex)];
+          return true;
+        case NodeType::ParamExprs:
+          return coEvalInCallingContext(
+              Modifier, CallingFrame->Caller->getKid(ParamIndex + 1), Value);
+        default:
+          return coThrow(std::string("Parameter type '") +
+                         getNodeSexpName(ParamTy) + "' not implemented");
+      }
+    }
+    case NodeType::LiteralActionUse: {
+      const auto* Sym = cast<Symbol>(Nd->getKid(0));
+      // Note: Use the definition of the current algorithm (see
+      // Method::Eval).
+      const LiteralActionDef* Defn =
+          Symtab->getSymbolDefn(Sym)->getLiteralActionDefinition();
+      if (Defn == nullptr) {
+        fprintf(stderr, "Eval can't find literal action: %s\n",
+                Sym->getName().c_str());
+        return coThrow("Unable to evaluate literal action");
+      }
+      IntType Ignored;
+      return coEval(Modifier, Defn, Ignored);
+    }
+    case NodeType::LiteralUse: {
+      const auto* Sym = cast<Symbol>(Nd->getKid(0));
+      const LiteralDef* Defn =
+          Symtab->getSymbolDefn(Sym)->getLiteralDefinition();
+      if (Defn == nullptr) {
+        fprintf(stderr, "Eval can't find literal: %s\n",
+                Sym->getName().c_str());
+        return coThrow("Unable to evaluate literal");
+      }
+      IntType Ignored;
+      return coEval(Modifier, Defn, Ignored);
+    }
+    case NodeType::EvalVirtual: {
+      const Eval* EvalNd = cast<Eval>(Nd);
+      const Define* Defn = Symtab->getBoundDefine(EvalNd);
+      if (Defn == nullptr) {
+        // Not bound when installed, lookup and check call.
+        const Symbol* Sym = EvalNd->getCallName();
+        Defn = Symtab->getSymbolDefn(Sym)->getDefineDefinition();
+        if (Defn == nullptr) {
+          fprintf(stderr, "Eval can't find definition: %s\n",
+                  Sym->getName().c_str());
+          return coThrow("Unable to evaluate call");
+        }
+        size_t NumParams = Defn->getNumArgs();
+        int NumCallArgs = Nd->getNumKids() - 1;
+        if (NumParams != size_t(NumCallArgs)) {
+          fprintf(stderr, "Definition %s expects %" PRIuMAX
+                          "parameters, found: %" PRIuMAX "\n",
+                  Sym->getName().c_str(), uintmax_t(NumParams),
+                  uintmax_t(NumCallArgs));
+          return coThrow("Unable to evaluate call");
+        }
+      }
+      if (Defn->needsInstall() && !Symtab->installDefinition(Defn))
+        return coThrow("Unable to install definition");
+      const DefineFrame* DefFrame = Defn->getDefineFrame();
+      // Note: Expression arguments are evaluated in the calling context, and
+      // hence need the frame of the caller.
+      if (CoTailFrame != nullptr && CoTailFrame == CoCurFrame &&
+          DefFrame->getNumExprArgs() == 0 && EvalNd->isTailCall()) {
+        CoTailValuesBase = CoValues.size();
+        CoValues.resize(CoTailValuesBase + DefFrame->getNumValues(), 0);
+        for (size_t i = 0, NumValueArgs = DefFrame->getNumValueArgs();
+             i < NumValueArgs; ++i) {
+          size_t ValArg = DefFrame->getValueArgIndex(i);
+          IntType ArgValue;
+          if (!coEval(Modifier, Nd->getKid(ValArg + 1), ArgValue))
+            return false;
+          CoValues[CoTailValuesBase + ValArg] = ArgValue;
+        }
+        CoTailCaller = EvalNd;
+        CoTailCallee = Defn;
+        Value = LastReadValue;
+        return true;
+      }
+      CoEvalFrame CalledFrame;
+      CalledFrame.Caller = EvalNd;
+      CalledFrame.DefinedFrame = DefFrame;
+      CalledFrame.ValuesBase = CoValues.size();
+      CalledFrame.CallingFrame = CoCurFrame;
+      CoValues.resize(CalledFrame.ValuesBase + DefFrame->getNumValues(), 0);
+      CoCurFrame = &CalledFrame;
+      for (size_t i = 0, NumValueArgs = DefFrame->getNumValueArgs();
+           i < NumValueArgs; ++i) {
+        size_t ValArg = DefFrame->getValueArgIndex(i);
+        IntType ArgValue;
+        if (!coEvalInCallingContext(Modifier, Nd->getKid(ValArg + 1),
+                                    ArgValue))
+          return false;
+        CoValues[CalledFrame.ValuesBase + ValArg] = ArgValue;
+      }
+      CoEvalFrame* EnclosingTailFrame = CoTailFrame;
+      while (true) {
+        const bool IsMemoized =
+            Flags.MemoizePureDefines && Symtab->isPureDefine(Defn);
+        const IntType EntryLastRead = LastReadValue;
+        if (!IsMemoized ||
+            !Memo->lookup(Symtab.get(), Defn, uint32_t(Modifier),
+                          EntryLastRead,
+                          CoValues.data() + CalledFrame.ValuesBase,
+                          DefFrame->getNumValues(), LastReadValue)) {
+          // Note: Memoized results are keyed by the arguments, and hence the
+          // frame can't be reused.
+          CoTailFrame = IsMemoized ? nullptr : &CalledFrame;
+          IntType Ignored;
+          if (!coEval(Modifier, Defn, Ignored))
+            return false;
+          CoTailFrame = EnclosingTailFrame;
+          if (IsMemoized)
+            Memo->insert(Symtab, Defn, uint32_t(Modifier), EntryLastRead,
+                         CoValues.data() + CalledFrame.ValuesBase,
+                         DefFrame->getNumValues(), LastReadValue);
+        }
+        if (CoTailCallee == nullptr)
+          break;
+        // Reuse the frame for the call in tail position.
+        Defn = CoTailCallee;
+        DefFrame = Defn->getDefineFrame();
+        CalledFrame.Caller = CoTailCaller;
+        CalledFrame.DefinedFrame = DefFrame;
+        CoTailCallee = nullptr;
+        CoTailCaller = nullptr;
+        std::copy(CoValues.begin() + CoTailValuesBase, CoValues.end(),
+                  CoValues.begin() + CalledFrame.ValuesBase);
+        CoValues.resize(CalledFrame.ValuesBase + DefFrame->getNumValues());
+      }
+      CoCurFrame = CalledFrame.CallingFrame;
+      CoValues.resize(CalledFrame.ValuesBase);
+      Value = LastReadValue;
+      return true;
+    }
+    case NodeType::Block:
+      return coEvalBlock(Modifier, Nd->getKid(0));
+    case NodeType::Void:
+      Value = LastReadValue;
+      return true;
+  }
+  return coFail("Method not implemented!");
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
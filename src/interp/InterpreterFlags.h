@@ -36,6 +36,11 @@ struct InterpreterFlags {
   bool TraceProgress;
   bool TraceIntermediateStreams;
   bool TraceAppliedAlgorithms;
+  // Evaluate the 'file' define as recursive code on a coroutine, rather than
+  // with the (explicit) state machine.
+  bool UseCoroutines;
+  // Cache the results of pure defines (see filt::SymbolTable::isPureDefine()).
+  bool MemoizePureDefines;
 };
 
 }  // end of namespace interp
@@ -0,0 +1,137 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a profile of the interpreter, by source line.
+
+#include "interp/SourceProfile.h"
+
+#include "sexp/Ast.h"
+
+namespace wasm {
+
+using namespace filt;
+
+namespace interp {
+
+namespace {
+
+double toMillis(std::chrono::steady_clock::duration Time) {
+  return std::chrono::duration<double, std::milli>(Time).count();
+}
+
+void writeStats(FILE* Out, double Millis, double TotalTime, uint64_t Count) {
+  if (Millis == 0 && Count == 0) {
+    fprintf(Out, "%10s %6s %11s", "", "", "");
+    return;
+  }
+  fprintf(Out, "%10.3f %5.1f%% %11" PRIuMAX, Millis,
+          TotalTime > 0 ? 100.0 * Millis / TotalTime : 0.0, uintmax_t(Count));
+}
+
+}  // end of anonymous namespace
+
+SourceProfile::SourceProfile()
+    : LastSymtab(nullptr), LastFile(nullptr), Current(nullptr) {}
+
+SourceProfile::~SourceProfile() {}
+
+SourceProfile::LineStats& SourceProfile::getStats(const Node* Nd) {
+  if (Nd == nullptr || Nd->getSourceLine() == 0)
+    return Unattributed;
+  const SymbolTable* Symtab = &Nd->getSymtab();
+  if (Symtab != LastSymtab) {
+    LastSymtab = Symtab;
+    const std::string& Filename = Symtab->getSourceFilename();
+    LastFile = Filename.empty() ? nullptr : &Files[Filename];
+  }
+  if (LastFile == nullptr)
+    return Unattributed;
+  size_t Line = Nd->getSourceLine();
+  if (Line >= LastFile->size())
+    LastFile->resize(Line + 1);
+  return (*LastFile)[Line];
+}
+
+void SourceProfile::step(const Node* Nd, bool Evaluated) {
+  ClockType::time_point Now = ClockType::now();
+  if (Current != nullptr)
+    Current->Time += Now - LastTime;
+  LastTime = Now;
+  Current = &getStats(Nd);
+  if (Evaluated)
+    ++Current->Evaluations;
+}
+
+void SourceProfile::pause() {
+  if (Current == nullptr)
+    return;
+  Current->Time += ClockType::now() - LastTime;
+  Current = nullptr;
+}
+
+void SourceProfile::writeListing(FILE* Out) {
+  pause();
+  double TotalTime = toMillis(Unattributed.Time);
+  for (const auto& Pair : Files)
+    for (const LineStats& Stats : Pair.second)
+      TotalTime += toMillis(Stats.Time);
+  for (const auto& Pair : Files)
+    writeFile(Out, Pair.first, Pair.second, TotalTime);
+  fprintf(Out, "Without source lines:\n");
+  writeStats(Out, toMillis(Unattributed.Time), TotalTime,
+             Unattributed.Evaluations);
+  fprintf(Out, "\nTotal: %.3f ms\n", TotalTime);
+}
+
+void SourceProfile::writeFile(FILE* Out,
+                              const std::string& Filename,
+                              const FileStats& Stats,
+                              double TotalTime) {
+  fprintf(Out, "Profile of %s:\n", Filename.c_str());
+  fprintf(Out, "%10s %6s %11s %5s  %s\n", "Time(ms)", "Time", "Evaluations",
+          "Line", "Source");
+  FILE* In = fopen(Filename.c_str(), "r");
+  if (In == nullptr)
+    fprintf(stderr, "Unable to open %s, listing lines without source\n",
+            Filename.c_str());
+  size_t Line = 1;
+  while (true) {
+    std::string Text;
+    bool AtEof = true;
+    if (In != nullptr) {
+      int Ch;
+      while ((Ch = fgetc(In)) != EOF && Ch != '\n')
+        Text.push_back(char(Ch));
+      AtEof = Ch == EOF && Text.empty();
+    }
+    if (AtEof && Line >= Stats.size())
+      break;
+    if (Line < Stats.size())
+      writeStats(Out, toMillis(Stats[Line].Time), TotalTime,
+                 Stats[Line].Evaluations);
+    else
+      writeStats(Out, 0, TotalTime, 0);
+    fprintf(Out, " %5" PRIuMAX "  %s\n", uintmax_t(Line), Text.c_str());
+    ++Line;
+  }
+  if (In != nullptr)
+    fclose(In);
+  fputc('\n', Out);
+}
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
@@ -0,0 +1,93 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a profile of the interpreter, by source line of the evaluated
+// algorithm(s).
+//
+// The interpreter calls step() each time it moves to a node. The time
+// since the previous step is charged to the source line of the previous
+// node, and evaluations of a node are counted against its source line.
+// Nodes without a source line (see Node::getSourceLine()) are charged to a
+// single "unattributed" bucket.
+
+#ifndef DECOMPRESSOR_SRC_INTERP_SOURCEPROFILE_H
+#define DECOMPRESSOR_SRC_INTERP_SOURCEPROFILE_H
+
+#include "utils/Defs.h"
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace wasm {
+
+namespace filt {
+class Node;
+class SymbolTable;
+}  // end of namespace filt
+
+namespace interp {
+
+class SourceProfile {
+  SourceProfile(const SourceProfile&) = delete;
+  SourceProfile& operator=(const SourceProfile&) = delete;
+
+ public:
+  SourceProfile();
+  ~SourceProfile();
+
+  // Charges the time since the previous step, and moves to Nd. Counts an
+  // evaluation of Nd if Evaluated.
+  void step(const filt::Node* Nd, bool Evaluated);
+
+  // Charges the time since the previous step, and stops the clock until the
+  // next step.
+  void pause();
+
+  // Writes each profiled source file, with each line annotated with its
+  // time and number of evaluations.
+  void writeListing(FILE* Out);
+
+ private:
+  typedef std::chrono::steady_clock ClockType;
+  struct LineStats {
+    LineStats() : Evaluations(0), Time(0) {}
+    uint64_t Evaluations;
+    ClockType::duration Time;
+  };
+  typedef std::vector<LineStats> FileStats;
+  std::map<std::string, FileStats> Files;
+  LineStats Unattributed;
+  // Caches the file of the last symbol table seen.
+  const filt::SymbolTable* LastSymtab;
+  FileStats* LastFile;
+  // The line being charged (null if paused).
+  LineStats* Current;
+  ClockType::time_point LastTime;
+
+  LineStats& getStats(const filt::Node* Nd);
+  void writeFile(FILE* Out,
+                 const std::string& Filename,
+                 const FileStats& Stats,
+                 double TotalTime);
+};
+
+}  // end of namespace interp
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_INTERP_SOURCEPROFILE_H
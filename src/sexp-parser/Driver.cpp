@@ -87,6 +87,8 @@ bool Driver::parse(const std::string& Filename) {
 
 bool Driver::parseOneFile(std::string& Filename) {
   this->Filename = Filename;
+  if (KeepSourceLines)
+    Table->setSourceFilename(Filename);
   Loc.initialize(&Filename);
   ParsedAst = nullptr;
   Begin();
@@ -40,6 +40,8 @@ class Driver {
         TraceLexing(false),
         TraceParsing(false),
         TraceFilesParsed(false),
+        KeepSourceLines(false),
+        RuleLine(0),
         ParsedAst(nullptr),
         ErrorsReported(false) {}
 
@@ -47,26 +49,26 @@ class Driver {
 
   template <typename T>
   T* create() {
-    return Table->create<T>();
+    return noteSourceLine(Table->create<T>());
   }
   template <typename T>
   T* create(Node* Nd) {
-    return Table->create<T>(Nd);
+    return noteSourceLine(Table->create<T>(Nd));
   }
   template <typename T>
   T* create(Node* Nd1, Node* Nd2) {
-    return Table->create<T>(Nd1, Nd2);
+    return noteSourceLine(Table->create<T>(Nd1, Nd2));
   }
   template <typename T>
   T* create(Node* Nd1, Node* Nd2, Node* Nd3) {
-    return Table->create<T>(Nd1, Nd2, Nd3);
+    return noteSourceLine(Table->create<T>(Nd1, Nd2, Nd3));
   }
   template <class T>
   T* create(decode::IntType Value, decode::ValueFormat Format) {
-    return Table->create<T>(Value, Format);
+    return noteSourceLine(Table->create<T>(Value, Format));
   }
   BinaryAccept* createBinaryAccept(decode::IntType Value, unsigned NumBits) {
-    return Table->createBinaryAccept(Value, NumBits);
+    return noteSourceLine(Table->createBinaryAccept(Value, NumBits));
   }
 
   IntegerNode* createLiteral(decode::IntType Value, decode::ValueFormat Format);
@@ -88,6 +90,12 @@ class Driver {
 
   void setTraceParsing(bool NewValue) { TraceParsing = NewValue; }
 
+  // When true, created nodes record the line they were parsed from.
+  void setKeepSourceLines(bool NewValue) { KeepSourceLines = NewValue; }
+
+  // Called by the parser with the location of the rule being reduced.
+  void setRuleLocation(const location& L) { RuleLine = L.begin.line; }
+
   const location& getLoc() const { return Loc; }
 
   void stepLocation() { Loc.step(); }
@@ -142,6 +150,9 @@ class Driver {
   bool TraceParsing;
   bool TraceFilesParsed;
   bool MaintainIntegerFormatting;
+  bool KeepSourceLines;
+  // The (first) line of the rule being reduced.
+  uint32_t RuleLine;
   // The location of the last token.
   location Loc;
   const Node* ParsedAst;
@@ -153,6 +164,14 @@ class Driver {
   void End();
 
   bool parseOneFile(std::string& Filename);
+
+  template <typename T>
+  T* noteSourceLine(T* Nd) {
+    // Note: Integer nodes are shared, so keep the first line seen.
+    if (KeepSourceLines && Nd->getSourceLine() == 0)
+      Nd->setSourceLine(RuleLine);
+    return Nd;
+  }
 };
 
 }  // end of namespace filt
@@ -65,6 +65,7 @@
 //   INIT: code to run in the body of the constructors to finish
 //         initialization
 #define AST_INTEGERNODE_TABLE                                \
+  X(BinaryAdaptive, Varuint32, 0, false, IntegerNode, , )    \
   X(I32Const, Varint32, 0, true, IntegerNode, , )            \
   X(I64Const, Varint64, 0, true, IntegerNode, , )            \
   X(Local, Varuint32, 0, true, IntegerNode, VALIDATENODE, )  \
@@ -256,6 +257,7 @@
   X(Bit, 0x2b, "bit", 0, 0, false, false)                                \
   /* Not an ast node, just for bit compression */                        \
   X(BinaryEvalBits, 0x2c, "opcode", 0, 0, false, false)                  \
+  X(BinaryAdaptive, 0x2d, "adaptive", 1, 0, false, false)                \
                                                                          \
   /* Boolean Expressions */                                              \
   X(And, 0x30, "and", 2, 0, false, false)                                \
@@ -351,9 +353,14 @@
     return Index < getDefineFrame()->getNumLocals();                           \
   }                                                                            \
   Node* getBody() const;                                                       \
+  /* True if validation was deferred until first evaluation. */                \
+  bool needsInstall() const { return NeedsInstall; }                           \
                                                                                \
  private:                                                                      \
   friend class SymbolTable;                                                    \
-  mutable std::unique_ptr<DefineFrame> MyDefineFrame;
+  mutable std::unique_ptr<DefineFrame> MyDefineFrame;                          \
+  mutable std::atomic<bool> NeedsInstall{false};                               \
+  /* Held while installing a deferred define. */                               \
+  mutable std::mutex InstallMutex;
 
 #endif  // DECOMPRESSOR_SRC_SEXP_AST_DEFS_H_
@@ -20,6 +20,7 @@
 #include "sexp/Ast.h"
 
 #include <algorithm>
+#include <mutex>
 
 #include "interp/IntFormats.h"
 #include "sexp/TextWriter.h"
@@ -133,6 +134,9 @@ bool compareSymbolNodesLt(const Symbol* S1, const Symbol* S2) {
   return S1->getName() < S2->getName();
 }
 
+// Algorithms are registered when read, which can happen on multiple threads.
+std::mutex AlgorithmRegistryMutex;
+
 }  // end of anonymous namespace
 
 PredefinedSymbol toPredefinedSymbol(uint32_t Value) {
@@ -242,7 +246,8 @@ Node* Node::Iterator::operator*() const {
 Node::Node(SymbolTable& Symtab, NodeType Type)
     : Type(Type),
       Symtab(Symtab),
-      CreationIndex(Symtab.getNextCreationIndex()) {}
+      CreationIndex(Symtab.getNextCreationIndex()),
+      SourceLine(0) {}
 
 Node::~Node() {}
 
@@ -627,6 +632,8 @@ SymbolTable::SymbolTable() {
 
 void SymbolTable::init() {
   Alg = nullptr;
+  IsAlgInstalled = false;
+  LazyInstall = false;
   setAlgorithm(nullptr);
   NextCreationIndex = 0;
   ActionBase = 0;
@@ -644,6 +651,7 @@ SymbolTable::~SymbolTable() {
 }
 
 SymbolTable::SharedPtr SymbolTable::getRegisteredAlgorithm(std::string Name) {
+  std::lock_guard<std::mutex> Lock(AlgorithmRegistryMutex);
   if (AlgorithmRegistry == nullptr)
     AlgorithmRegistry = new std::map<std::string, SharedPtr>();
   if (AlgorithmRegistry->count(Name) > 0)
@@ -652,6 +660,7 @@ SymbolTable::SharedPtr SymbolTable::getRegisteredAlgorithm(std::string Name) {
 }
 
 void SymbolTable::registerAlgorithm(SharedPtr Alg) {
+  std::lock_guard<std::mutex> Lock(AlgorithmRegistryMutex);
   if (AlgorithmRegistry == nullptr)
     AlgorithmRegistry = new std::map<std::string, SharedPtr>();
   std::string AlgName;
@@ -908,8 +917,8 @@ bool SymbolTable::areActionsConsistent() {
 }
 
 void SymbolTable::setEnclosingScope(SharedPtr Symtab) {
-  EnclosingScope = Symtab;
   clearCaches();
+  EnclosingScope = Symtab;
 }
 
 void SymbolTable::clearCaches() {
@@ -917,6 +926,13 @@ void SymbolTable::clearCaches() {
     Alg->clearCaches();
   IsAlgInstalled = false;
   CachedValue.clear();
+  OverriddenCalls.clear();
+  for (Node* Nd : Allocated)
+    if (auto* EvalNd = dyn_cast<Eval>(Nd)) {
+      EvalNd->BoundDefine = nullptr;
+      EvalNd->IsTailCall = false;
+    }
+  DefinePurity.clear();
   UndefinedCallbacks.clear();
   CallbackValues.clear();
   CallbackLiterals.clear();
@@ -1082,16 +1098,307 @@ bool SymbolTable::install() {
     return false;
   installPredefined();
   installDefinitions(Alg);
-  ConstNodeVectorType Parents;
-  bool IsValid = Alg->validateSubtree(Parents);
-  Parents.push_back(Alg);
+  bool IsValid;
+  if (LazyInstall) {
+    IsValid = validateGlobals();
+  } else {
+    ConstNodeVectorType Parents;
+    IsValid = Alg->validateSubtree(Parents);
+  }
   if (IsValid)
     IsValid = areActionsConsistent();
   if (!IsValid)
     fatal("Unable to install algorthms, validation failed!");
+  // Bind call sites of this and enclosing algorithms, since definitions are
+  // resolved with respect to this scope when this algorithm is run.
+  for (SymbolTable* Scope = this; Scope != nullptr;
+       Scope = Scope->getEnclosingScope().get())
+    bindCallSites(Scope->Alg);
+  // Fill caches now, so that running the installed algorithm (including
+  // installs of deferred defines) does not modify the symbol table. This
+  // allows several threads to run the algorithm.
+  for (SymbolTable* Scope = this; Scope != nullptr;
+       Scope = Scope->getEnclosingScope().get())
+    installCachedValues(Scope->Alg);
+  getSourceHeader();
+  getReadHeader();
+  getWriteHeader();
   return IsAlgInstalled = true;
 }
 
+bool SymbolTable::validateGlobals() {
+  TRACE_METHOD("validateGlobals");
+  ConstNodeVectorType Parents;
+  if (!Alg->validateNode(Parents))
+    return false;
+  Parents.push_back(Alg);
+  for (const Node* Kid : *Alg) {
+    const auto* Def = dyn_cast<Define>(Kid);
+    if (Def == nullptr) {
+      if (!Kid->validateSubtree(Parents))
+        return false;
+      continue;
+    }
+    Def->NeedsInstall = true;
+    // Actions are enumerated globally, so collect the callbacks used
+    // within the define now. Also add its frame, since it may be installed
+    // while other threads run the algorithm.
+    Def->getDefineFrame();
+    std::vector<const Node*> ToVisit;
+    ToVisit.push_back(Def);
+    while (!ToVisit.empty()) {
+      const Node* Nd = ToVisit.back();
+      ToVisit.pop_back();
+      if (isa<Callback>(Nd) || isa<LiteralActionUse>(Nd)) {
+        if (!Nd->validateNode(Parents))
+          return false;
+      }
+      for (const Node* Kid : *Nd)
+        ToVisit.push_back(Kid);
+    }
+  }
+  return true;
+}
+
+void SymbolTable::installCachedValues(const Node* Root) {
+  TRACE_METHOD("installCachedValues");
+  std::vector<const Node*> ToVisit;
+  ToVisit.push_back(Root);
+  while (!ToVisit.empty()) {
+    const Node* Nd = ToVisit.back();
+    ToVisit.pop_back();
+    if (const auto* Sym = dyn_cast<Symbol>(Nd)) {
+      SymbolDefn* Defn = getSymbolDefn(Sym);
+      Defn->getDefineDefinition();
+      Defn->getLiteralDefinition();
+      Defn->getLiteralActionDefinition();
+    } else if (const auto* Sel = dyn_cast<SelectBase>(Nd)) {
+      Sel->getIntLookup();
+    } else if (const auto* BinEval = dyn_cast<BinaryEval>(Nd)) {
+      BinEval->getIntLookup();
+    }
+    for (const Node* Kid : *Nd)
+      ToVisit.push_back(Kid);
+  }
+}
+
+bool SymbolTable::installDefinition(const Define* Def) {
+  TRACE_METHOD("installDefinition");
+  if (!Def->NeedsInstall)
+    return true;
+  std::lock_guard<std::mutex> Lock(Def->InstallMutex);
+  if (!Def->NeedsInstall)
+    return true;
+  // Note: Binds with respect to the scope of the define, since that is
+  // where its call sites are bound (see bindCallSites). Call sites of
+  // enclosed scopes were bound when the enclosed scopes were installed.
+  SymbolTable& DefSymtab = Def->getSymtab();
+  ConstNodeVectorType Parents;
+  Parents.push_back(DefSymtab.Alg);
+  // Note: Keeps the frame built by validateGlobals(), since other threads
+  // may be using it.
+  if (!Def->getDefineFrame()->isConsistent() || !Def->validateKids(Parents)) {
+    errorDescribeNode("Unable to install", Def);
+    return false;
+  }
+  DefSymtab.bindCallSites(Def);
+  Def->NeedsInstall = false;
+  return true;
+}
+
+void SymbolTable::bindCallSites(const Node* Root) {
+  if (Root == nullptr)
+    return;
+  // Note: The flag is true within deferred defines of enclosing scopes, whose
+  // call sites may not be bound yet.
+  std::vector<std::pair<const Node*, bool>> ToVisit;
+  ToVisit.emplace_back(Root, false);
+  while (!ToVisit.empty()) {
+    const Node* Nd = ToVisit.back().first;
+    bool InDeferred = ToVisit.back().second;
+    ToVisit.pop_back();
+    if (const auto* EvalNd = dyn_cast<Eval>(Nd)) {
+      // Only bind if the define (with respect to this scope) matches the
+      // call, so that the interpreter need not check the call at run time.
+      const Define* Defn =
+          getSymbolDefn(EvalNd->getCallName())->getDefineDefinition();
+      if (Defn != nullptr &&
+          Defn->getNumArgs() != size_t(Nd->getNumKids() - 1))
+        Defn = nullptr;
+      if (&EvalNd->getSymtab() == this)
+        EvalNd->BoundDefine = Defn;
+      else if (InDeferred || Defn != EvalNd->BoundDefine)
+        OverriddenCalls[EvalNd] = Defn;
+    } else if (const auto* Def = dyn_cast<Define>(Nd)) {
+      bool IsOwned = &Def->getSymtab() == this;
+      if (Nd != Root && Def->needsInstall()) {
+        // Deferred defines are bound by installDefinition.
+        if (IsOwned)
+          continue;
+        InDeferred = true;
+      }
+      if (IsOwned)
+        markTailCalls(Def->getBody());
+      // Note: Purity isn't updated when installing a deferred define, since
+      // other threads may be running this scope.
+      if (Nd != Root || !Def->needsInstall())
+        markPureDefines(Def);
+    }
+    for (const Node* Kid : *Nd)
+      ToVisit.emplace_back(Kid, InDeferred);
+  }
+}
+
+void SymbolTable::markTailCalls(const Node* Nd) {
+  if (Nd == nullptr)
+    return;
+  switch (Nd->getType()) {
+    default:
+      return;
+    case NodeType::EvalVirtual:
+      cast<Eval>(Nd)->IsTailCall = true;
+      return;
+    case NodeType::Sequence:
+      if (int NumKids = Nd->getNumKids())
+        markTailCalls(Nd->getKid(NumKids - 1));
+      return;
+    case NodeType::IfThenElse:
+      markTailCalls(Nd->getKid(1));
+      markTailCalls(Nd->getKid(2));
+      return;
+    case NodeType::Switch:
+      for (int i = 1, NumKids = Nd->getNumKids(); i < NumKids; ++i)
+        markTailCalls(Nd->getKid(i));
+      return;
+    case NodeType::Case:
+      markTailCalls(cast<Case>(Nd)->getCaseBody());
+      return;
+  }
+}
+
+void SymbolTable::markPureDefines(const Define* Root) {
+  if (DefinePurity.count(Root))
+    return;
+  // Collect the (not yet analyzed) defines reachable from Root, and then
+  // find the greatest fixed point, so that recursive defines can be pure.
+  std::vector<const Define*> Defines;
+  std::unordered_map<const Define*, size_t> DefineIndex;
+  std::vector<std::vector<size_t>> Calls;
+  std::vector<bool> Pure;
+  Defines.push_back(Root);
+  DefineIndex[Root] = 0;
+  for (size_t i = 0; i < Defines.size(); ++i) {
+    std::vector<const Define*> Callees;
+    bool IsPure = isLocallyPure(Defines[i], Callees);
+    Calls.emplace_back();
+    for (const Define* Callee : Callees) {
+      if (!IsPure)
+        break;
+      auto Analyzed = DefinePurity.find(Callee);
+      if (Analyzed != DefinePurity.end()) {
+        IsPure = Analyzed->second;
+        continue;
+      }
+      auto Iter = DefineIndex.find(Callee);
+      if (Iter == DefineIndex.end()) {
+        Iter = DefineIndex.emplace(Callee, Defines.size()).first;
+        Defines.push_back(Callee);
+      }
+      Calls[i].push_back(Iter->second);
+    }
+    Pure.push_back(IsPure);
+  }
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (size_t i = 0; i < Defines.size(); ++i) {
+      if (!Pure[i])
+        continue;
+      for (size_t Callee : Calls[i]) {
+        if (!Pure[Callee]) {
+          Pure[i] = false;
+          Changed = true;
+          break;
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < Defines.size(); ++i)
+    DefinePurity[Defines[i]] = Pure[i];
+}
+
+bool SymbolTable::isLocallyPure(const Define* Def,
+                                std::vector<const Define*>& Callees) {
+  const DefineFrame* Frame = Def->getDefineFrame();
+  if (Def->getBody() == nullptr || Frame->getNumExprArgs() != 0)
+    return false;
+  std::vector<const Node*> ToVisit;
+  ToVisit.push_back(Def->getBody());
+  while (!ToVisit.empty()) {
+    const Node* Nd = ToVisit.back();
+    ToVisit.pop_back();
+    switch (Nd->getType()) {
+      default:
+        // Uses streams, or state outside of the call.
+        return false;
+      case NodeType::I32Const:
+      case NodeType::I64Const:
+      case NodeType::LastRead:
+      case NodeType::One:
+      case NodeType::U8Const:
+      case NodeType::U32Const:
+      case NodeType::U64Const:
+      case NodeType::Void:
+      case NodeType::Zero:
+        continue;
+      case NodeType::And:
+      case NodeType::BitwiseAnd:
+      case NodeType::BitwiseNegate:
+      case NodeType::BitwiseOr:
+      case NodeType::BitwiseXor:
+      case NodeType::IfThen:
+      case NodeType::IfThenElse:
+      case NodeType::Loop:
+      case NodeType::Not:
+      case NodeType::Or:
+      case NodeType::Sequence:
+      case NodeType::Set:
+      case NodeType::Switch:
+        break;
+      case NodeType::Case:
+        ToVisit.push_back(cast<Case>(Nd)->getCaseBody());
+        continue;
+      case NodeType::Local:
+        // Note: Without locals, local references refer to the locals of
+        // the caller.
+        if (cast<Local>(Nd)->getValue() >= Frame->getNumLocals())
+          return false;
+        continue;
+      case NodeType::Param: {
+        IntType Index = cast<Param>(Nd)->getValue();
+        if (Index >= Frame->getNumArgs() ||
+            Frame->getArgType(Index) != NodeType::ParamValues)
+          return false;
+        continue;
+      }
+      case NodeType::EvalVirtual: {
+        const Define* Callee =
+            getSymbolDefn(cast<Eval>(Nd)->getCallName())->getDefineDefinition();
+        if (Callee == nullptr ||
+            Callee->getNumArgs() != size_t(Nd->getNumKids() - 1))
+          return false;
+        Callees.push_back(Callee);
+        for (int i = 1, NumKids = Nd->getNumKids(); i < NumKids; ++i)
+          ToVisit.push_back(Nd->getKid(i));
+        continue;
+      }
+    }
+    for (const Node* Kid : *Nd)
+      ToVisit.push_back(Kid);
+  }
+  return true;
+}
+
 const Header* SymbolTable::getSourceHeader() const {
   if (CachedSourceHeader != nullptr)
     return CachedSourceHeader;
@@ -1937,7 +2244,8 @@ AST_TERNARYNODE_TABLE
 #undef X
 
 DefineFrame::DefineFrame(const Define* Def)
-    : NumValueArgs(0),
+    : Def(Def),
+      NumValueArgs(0),
       NumExprArgs(0),
       NumLocals(0),
       NumCached(0),
@@ -19,7 +19,9 @@
 #ifndef DECOMPRESSOR_SRC_SEXP_AST_H_
 #define DECOMPRESSOR_SRC_SEXP_AST_H_
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -55,6 +57,7 @@ class SymbolDefn;
 class Symbol;
 class SymbolTable;
 class Callback;
+class Eval;
 class WriteHeader;
 
 #define X(NAME, FORMAT, DEFAULT, MERGE, BASE, DECLS, INIT) class NAME;
@@ -124,6 +127,7 @@ class DefineFrame {
   explicit DefineFrame(const Define* Def);
   ~DefineFrame();
   bool isConsistent() { return InitSuccessful; }
+  const Define* getDefine() const { return Def; }
   size_t getNumLocals() const { return NumLocals; }
   size_t getNumArgs() const { return ParamTypes.size(); }
   size_t getNumValueArgs() const { return NumValueArgs; }
@@ -133,6 +137,7 @@ class DefineFrame {
   NodeType getArgType(size_t Index) const;
 
  private:
+  const Define* Def;
   std::vector<NodeType> ParamTypes;
   mutable size_t NumValueArgs;
   mutable size_t NumExprArgs;
@@ -190,9 +195,34 @@ class SymbolTable FINAL : public std::enable_shared_from_this<SymbolTable> {
   const Callback* getBlockExitCallback();
   const Algorithm* getAlgorithm() const { return Alg; }
   void setAlgorithm(const Algorithm* Alg);
-  // Install current algorithm
+  // The source file the algorithm was parsed from (empty if unknown, or
+  // source locations were not kept).
+  const std::string& getSourceFilename() const { return SourceFilename; }
+  void setSourceFilename(const std::string& Name) { SourceFilename = Name; }
+  // Install current algorithm. Once installed, several threads can run it.
   bool install();
+  // When true, install only validates the global structure of the
+  // algorithm. Validation (and binding) of each define is deferred until the
+  // define is first evaluated (see installDefinition).
+  void setLazyInstall(bool NewValue) { LazyInstall = NewValue; }
+  bool getLazyInstall() const { return LazyInstall; }
+  // Completes the (deferred) install of the given define, with respect to
+  // the scope of the define. Returns false if the define is not valid.
+  // Thread safe, since install() already added the caches the install
+  // needs to the symbol table.
+  bool installDefinition(const Define* Def);
   bool isAlgorithmInstalled() const { return IsAlgInstalled; }
+  // Returns the define the call site is bound to when run in this scope.
+  // Returns nullptr if not bound.
+  const Define* getBoundDefine(const Eval* EvalNd) const;
+  // True if (when resolved with respect to this scope) the define neither
+  // reads nor writes streams, and only depends on its value arguments and the
+  // last read value. Computed when installed, and hence false for deferred
+  // defines not reachable from the other defines.
+  bool isPureDefine(const Define* Def) const {
+    auto Iter = DefinePurity.find(Def);
+    return Iter != DefinePurity.end() && Iter->second;
+  }
   Node* getError() const { return Err; }
   const Header* getSourceHeader() const;
   const Header* getReadHeader() const;
@@ -257,7 +287,9 @@ class SymbolTable FINAL : public std::enable_shared_from_this<SymbolTable> {
   std::vector<Node*> Allocated;
   std::shared_ptr<utils::TraceClass> Trace;
   Algorithm* Alg;
+  std::string SourceFilename;
   bool IsAlgInstalled;
+  bool LazyInstall;
   Node* Err;
   int NextCreationIndex;
   decode::IntType ActionBase;
@@ -270,6 +302,13 @@ class SymbolTable FINAL : public std::enable_shared_from_this<SymbolTable> {
   Callback* BlockEnterCallback;
   Callback* BlockExitCallback;
   CachedValueMap CachedValue;
+  // Call sites of enclosing algorithms that bind to a different define in
+  // this scope than in their own (see Eval::getBoundDefine). Kept here,
+  // since enclosing algorithms are shared by all scopes they enclose.
+  std::unordered_map<const Eval*, const Define*> OverriddenCalls;
+  // Defines (reachable from bound call sites) analyzed for purity with
+  // respect to this scope, and whether they are pure.
+  std::unordered_map<const Define*, bool> DefinePurity;
   mutable const Header* CachedSourceHeader;
   mutable const Header* CachedReadHeader;
   mutable const Header* CachedWriteHeader;
@@ -282,6 +321,12 @@ class SymbolTable FINAL : public std::enable_shared_from_this<SymbolTable> {
   bool standardizeAlgorithm();
   void installPredefined();
   void installDefinitions(const Node* Root);
+  bool validateGlobals();
+  void installCachedValues(const Node* Root);
+  void bindCallSites(const Node* Root);
+  void markTailCalls(const Node* Nd);
+  void markPureDefines(const Define* Root);
+  bool isLocallyPure(const Define* Def, std::vector<const Define*>& Callees);
 
   bool areActionsConsistent();
   Node* stripUsing(Node* Root, std::function<Node*(Node*)> stripKid);
@@ -361,6 +406,11 @@ class Node {
 
   int getCreationIndex() const { return CreationIndex; }
 
+  // The line (in SymbolTable::getSourceFilename()) the node was parsed
+  // from. Zero if unknown.
+  uint32_t getSourceLine() const { return SourceLine; }
+  void setSourceLine(uint32_t Line) { SourceLine = Line; }
+
   // General iterators for walking kids.
   Iterator begin() const;
   Iterator end() const;
@@ -380,6 +430,7 @@ class Node {
   NodeType Type;
   SymbolTable& Symtab;
   int CreationIndex;
+  uint32_t SourceLine;
   Node(SymbolTable& Symtab, NodeType Type);
 };
 
@@ -559,18 +610,36 @@ class Eval : public Nary {
   Eval() = delete;
   Eval(const Eval&) = delete;
   Eval& operator=(const Eval&) = delete;
-  friend class SymbolTable;
 
  public:
   ~Eval() OVERRIDE;
   Symbol* getCallName() const;
   bool validateNode(ConstNodeVectorType& Parents) const OVERRIDE;
   static bool implementsClass(NodeType Type);
+  // Returns the define this call site was bound to when its algorithm was
+  // installed, or nullptr if not bound.
+  const Define* getBoundDefine() const { return BoundDefine; }
+  // Returns true if the call is in tail position of the body of the
+  // enclosing define (set when installed).
+  bool isTailCall() const { return IsTailCall; }
 
  protected:
   Eval(SymbolTable& Symtab, NodeType Type);
+
+ private:
+  friend class SymbolTable;
+  mutable const Define* BoundDefine = nullptr;
+  mutable bool IsTailCall = false;
 };
 
+inline const Define* SymbolTable::getBoundDefine(const Eval* EvalNd) const {
+  if (&EvalNd->getSymtab() == this || OverriddenCalls.empty())
+    return EvalNd->getBoundDefine();
+  auto Iter = OverriddenCalls.find(EvalNd);
+  return Iter == OverriddenCalls.end() ? EvalNd->getBoundDefine()
+                                       : Iter->second;
+}
+
 class IntLookup FINAL : public Cached {
   IntLookup() = delete;
   IntLookup(const IntLookup&) = delete;
@@ -822,6 +891,7 @@ class SelectBase : public Nary {
   static bool implementsClass(NodeType Type);
 
  protected:
+  friend class SymbolTable;
   SelectBase(SymbolTable& Symtab, NodeType Type);
   IntLookup* getIntLookup() const;
 };
@@ -917,6 +987,7 @@ class BinaryEval : public Unary {
   }
 
  private:
+  friend class SymbolTable;
   IntLookup* getIntLookup() const;
 };
 
@@ -49,6 +49,9 @@ class BitReadCursor : public ReadCursor {
   ByteType readByte() OVERRIDE;
   ByteType readBit() OVERRIDE;
   void alignToByte();
+  // True if no bits of the current byte have been read, and hence bytes can
+  // be read using ReadCursor::readAlignedByte().
+  bool isByteAligned() const { return NumBits == 0; }
 
   void describeDerivedExtensions(FILE* File, bool IncludeDetail) OVERRIDE;
 
@@ -0,0 +1,233 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stream/ChecksumReader.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "stream/ChecksumWriter.h"
+#include "utils/Crc32c.h"
+
+namespace wasm {
+
+namespace decode {
+
+namespace {
+
+uint32_t readU32(const ByteType* Buf) {
+  uint32_t Value = 0;
+  for (size_t i = sizeof(uint32_t); i > 0; --i)
+    Value = (Value << 8) | Buf[i - 1];
+  return Value;
+}
+
+bool isValidBlockSize(uint32_t BlockSize) {
+  return BlockSize > 0 && BlockSize <= ChecksumWriter::MaxBlockSize;
+}
+
+}  // end of anonymous namespace
+
+ChecksumReader::ChecksumReader(std::shared_ptr<RawStream> Input)
+    : Input(Input),
+      MyMode(Mode::Unknown),
+      BlockSize(0),
+      BlockPos(0),
+      BlockIndex(0),
+      AtEnd(false),
+      FoundErrors(false) {}
+
+ChecksumReader::~ChecksumReader() {}
+
+void ChecksumReader::error(const char* Message) {
+  fprintf(stderr, "Error: Block %" PRIuMAX " of checksummed input: %s\n",
+          uintmax_t(BlockIndex), Message);
+  FoundErrors = true;
+  AtEnd = true;
+  Block.clear();
+  BlockPos = 0;
+}
+
+void ChecksumReader::readHeader() {
+  ByteType Header[ChecksumWriter::HeaderSize];
+  AddressType Count = Input->read(Header, ChecksumWriter::MagicSize);
+  if (!isChecked(Header, Count)) {
+    MyMode = Mode::PassThrough;
+    Block.assign(Header, Header + Count);
+    return;
+  }
+  MyMode = Mode::Checked;
+  if (Input->read(Header + ChecksumWriter::MagicSize,
+                  sizeof(uint32_t)) != sizeof(uint32_t))
+    return error("truncated header");
+  BlockSize = readU32(Header + ChecksumWriter::MagicSize);
+  if (!isValidBlockSize(BlockSize))
+    return error("malformed header");
+  Block.reserve(BlockSize);
+}
+
+bool ChecksumReader::readBlock() {
+  ByteType Prefix[ChecksumWriter::HeaderSize];
+  if (Input->read(Prefix, ChecksumWriter::HeaderSize) !=
+      ChecksumWriter::HeaderSize) {
+    error("truncated file");
+    return false;
+  }
+  uint32_t Size = readU32(Prefix);
+  uint32_t Crc = readU32(Prefix + sizeof(uint32_t));
+  if (Size > BlockSize) {
+    error("malformed block size");
+    return false;
+  }
+  Block.resize(Size);
+  BlockPos = 0;
+  if (Size == 0) {
+    ByteType Extra;
+    if (Crc != 0 || Input->read(&Extra, 1) != 0)
+      error("unexpected bytes after end of checksummed input");
+    AtEnd = true;
+    return false;
+  }
+  if (Input->read(Block.data(), Size) != Size) {
+    error("truncated file");
+    return false;
+  }
+  if (utils::crc32c(Block.data(), Size) != Crc) {
+    error("checksum mismatch");
+    return false;
+  }
+  ++BlockIndex;
+  return true;
+}
+
+AddressType ChecksumReader::read(ByteType* Buf, AddressType Size) {
+  if (MyMode == Mode::Unknown)
+    readHeader();
+  AddressType Count = 0;
+  while (Size) {
+    if (BlockPos < Block.size()) {
+      AddressType Available =
+          std::min(Size, AddressType(Block.size() - BlockPos));
+      memcpy(Buf, Block.data() + BlockPos, Available);
+      BlockPos += Available;
+      Buf += Available;
+      Size -= Available;
+      Count += Available;
+      continue;
+    }
+    if (MyMode == Mode::PassThrough)
+      return Count + Input->read(Buf, Size);
+    if (AtEnd || !readBlock())
+      break;
+  }
+  return Count;
+}
+
+bool ChecksumReader::write(ByteType* Buf, AddressType Size) {
+  (void)Buf;
+  (void)Size;
+  return false;
+}
+
+bool ChecksumReader::freeze() {
+  return Input->freeze();
+}
+
+bool ChecksumReader::atEof() {
+  if (MyMode == Mode::Unknown)
+    readHeader();
+  if (BlockPos < Block.size())
+    return false;
+  if (MyMode == Mode::PassThrough)
+    return Input->atEof();
+  return AtEnd;
+}
+
+bool ChecksumReader::hasErrors() {
+  return FoundErrors || Input->hasErrors();
+}
+
+bool ChecksumReader::isChecked() {
+  if (MyMode == Mode::Unknown)
+    readHeader();
+  return MyMode == Mode::Checked;
+}
+
+bool ChecksumReader::isChecked(const ByteType* Bytes, size_t Size) {
+  return Size >= ChecksumWriter::MagicSize &&
+         memcmp(Bytes, ChecksumWriter::Magic, ChecksumWriter::MagicSize) == 0;
+}
+
+bool ChecksumReader::verify(const ByteType* Bytes, size_t Size, FILE* Out) {
+  if (!isChecked(Bytes, Size)) {
+    fprintf(Out, "Error: Input doesn't have checksums\n");
+    return false;
+  }
+  if (Size < ChecksumWriter::HeaderSize) {
+    fprintf(Out, "Error: Truncated header\n");
+    return false;
+  }
+  uint32_t BlockSize = readU32(Bytes + ChecksumWriter::MagicSize);
+  if (!isValidBlockSize(BlockSize)) {
+    fprintf(Out, "Error: Malformed header\n");
+    return false;
+  }
+  size_t Pos = ChecksumWriter::HeaderSize;
+  for (size_t Index = 0;; ++Index) {
+    if (Size - Pos < ChecksumWriter::HeaderSize) {
+      fprintf(Out, "Error: Block %" PRIuMAX ": truncated file\n",
+              uintmax_t(Index));
+      return false;
+    }
+    uint32_t BlkSize = readU32(Bytes + Pos);
+    uint32_t Crc = readU32(Bytes + Pos + sizeof(uint32_t));
+    Pos += ChecksumWriter::HeaderSize;
+    if (BlkSize == 0) {
+      if (Crc != 0) {
+        fprintf(Out, "Error: Block %" PRIuMAX ": malformed end\n",
+                uintmax_t(Index));
+        return false;
+      }
+      break;
+    }
+    if (BlkSize > BlockSize) {
+      fprintf(Out, "Error: Block %" PRIuMAX ": malformed block size\n",
+              uintmax_t(Index));
+      return false;
+    }
+    if (Size - Pos < BlkSize) {
+      fprintf(Out, "Error: Block %" PRIuMAX ": truncated file\n",
+              uintmax_t(Index));
+      return false;
+    }
+    if (utils::crc32c(Bytes + Pos, BlkSize) != Crc) {
+      fprintf(Out, "Error: Block %" PRIuMAX ": checksum mismatch\n",
+              uintmax_t(Index));
+      return false;
+    }
+    Pos += BlkSize;
+  }
+  if (Pos != Size) {
+    fprintf(Out, "Error: Unexpected bytes after end of checksummed input\n");
+    return false;
+  }
+  return true;
+}
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
@@ -0,0 +1,82 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reads a stream written by a ChecksumWriter, verifying the checksum of
+// each block before any of its bytes are returned. Streams that don't start
+// with the checksum magic number are passed through unchanged.
+//
+// When a block is corrupt (or the stream is truncated), the error is
+// reported, hasErrors() becomes true, and the stream ends.
+
+#ifndef DECOMPRESSOR_SRC_STREAM_CHECKSUMREADER_H_
+#define DECOMPRESSOR_SRC_STREAM_CHECKSUMREADER_H_
+
+#include <vector>
+
+#include "stream/RawStream.h"
+
+namespace wasm {
+
+namespace decode {
+
+class ChecksumReader FINAL : public RawStream {
+  ChecksumReader() = delete;
+  ChecksumReader(const ChecksumReader&) = delete;
+  ChecksumReader& operator=(const ChecksumReader&) = delete;
+
+ public:
+  explicit ChecksumReader(std::shared_ptr<RawStream> Input);
+  ~ChecksumReader() OVERRIDE;
+  AddressType read(ByteType* Buf, AddressType Size = 1) OVERRIDE;
+  bool write(ByteType* Buf, AddressType Size = 1) OVERRIDE;
+  bool freeze() OVERRIDE;
+  bool atEof() OVERRIDE;
+  bool hasErrors() OVERRIDE;
+
+  // Returns true if the stream has checksums.
+  bool isChecked();
+
+  // Returns true if Bytes (of the given Size) starts with the checksum
+  // magic number.
+  static bool isChecked(const ByteType* Bytes, size_t Size);
+
+  // Verifies all blocks of the checksummed stream in Bytes (of the given
+  // Size), without copying them. Reports problems found to Out.
+  static bool verify(const ByteType* Bytes, size_t Size, FILE* Out);
+
+ private:
+  enum class Mode { Unknown, PassThrough, Checked };
+  std::shared_ptr<RawStream> Input;
+  Mode MyMode;
+  uint32_t BlockSize;
+  // The verified bytes of the current block (or in pass through mode, the
+  // bytes read while looking for the magic number).
+  std::vector<ByteType> Block;
+  size_t BlockPos;
+  size_t BlockIndex;
+  bool AtEnd;
+  bool FoundErrors;
+  void readHeader();
+  bool readBlock();
+  void error(const char* Message);
+};
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_STREAM_CHECKSUMREADER_H_
@@ -0,0 +1,141 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stream/ChecksumWriter.h"
+
+#include <algorithm>
+
+#include "utils/Crc32c.h"
+
+namespace wasm {
+
+namespace decode {
+
+namespace {
+
+void writeU32(ByteType* Buf, uint32_t Value) {
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    Buf[i] = ByteType(Value);
+    Value >>= 8;
+  }
+}
+
+}  // end of anonymous namespace
+
+const ByteType ChecksumWriter::Magic[ChecksumWriter::MagicSize] = {0x00, 'c',
+                                                                   'r', 'c'};
+
+constexpr size_t ChecksumWriter::MagicSize;
+constexpr size_t ChecksumWriter::HeaderSize;
+constexpr uint32_t ChecksumWriter::DefaultBlockSize;
+constexpr uint32_t ChecksumWriter::MaxBlockSize;
+
+ChecksumWriter::ChecksumWriter(std::shared_ptr<RawStream> Output,
+                               uint32_t BlockSize)
+    : Output(Output),
+      BlockSize(BlockSize ? std::min(BlockSize, MaxBlockSize)
+                          : DefaultBlockSize),
+      WroteHeader(false),
+      IsFrozen(false),
+      FoundErrors(false) {
+  Block.reserve(this->BlockSize);
+}
+
+ChecksumWriter::~ChecksumWriter() {
+  freeze();
+}
+
+AddressType ChecksumWriter::read(ByteType* Buf, AddressType Size) {
+  (void)Buf;
+  (void)Size;
+  return 0;
+}
+
+bool ChecksumWriter::writeHeader() {
+  ByteType Header[HeaderSize];
+  memcpy(Header, Magic, MagicSize);
+  writeU32(Header + MagicSize, BlockSize);
+  WroteHeader = true;
+  return Output->write(Header, HeaderSize);
+}
+
+bool ChecksumWriter::writeBlock(ByteType* Buf, uint32_t Size) {
+  ByteType Prefix[HeaderSize];
+  writeU32(Prefix, Size);
+  writeU32(Prefix + sizeof(uint32_t), Size ? utils::crc32c(Buf, Size) : 0);
+  return Output->write(Prefix, HeaderSize) &&
+         (Size == 0 || Output->write(Buf, Size));
+}
+
+bool ChecksumWriter::write(ByteType* Buf, AddressType Size) {
+  if (IsFrozen || FoundErrors)
+    return false;
+  if (!WroteHeader && !writeHeader()) {
+    FoundErrors = true;
+    return false;
+  }
+  while (Size) {
+    if (Block.empty() && Size >= BlockSize) {
+      // Note: Full blocks are written without copying.
+      if (!writeBlock(Buf, BlockSize)) {
+        FoundErrors = true;
+        return false;
+      }
+      Buf += BlockSize;
+      Size -= BlockSize;
+      continue;
+    }
+    AddressType Count = std::min(Size, AddressType(BlockSize - Block.size()));
+    Block.insert(Block.end(), Buf, Buf + Count);
+    Buf += Count;
+    Size -= Count;
+    if (Block.size() < BlockSize)
+      break;
+    if (!writeBlock(Block.data(), Block.size())) {
+      FoundErrors = true;
+      return false;
+    }
+    Block.clear();
+  }
+  return true;
+}
+
+bool ChecksumWriter::freeze() {
+  if (IsFrozen)
+    return !FoundErrors;
+  IsFrozen = true;
+  if (!FoundErrors) {
+    if ((!WroteHeader && !writeHeader()) ||
+        (!Block.empty() && !writeBlock(Block.data(), Block.size())) ||
+        !writeBlock(nullptr, 0))
+      FoundErrors = true;
+    Block.clear();
+  }
+  return Output->freeze() && !FoundErrors;
+}
+
+bool ChecksumWriter::atEof() {
+  return IsFrozen;
+}
+
+bool ChecksumWriter::hasErrors() {
+  return FoundErrors || Output->hasErrors();
+}
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
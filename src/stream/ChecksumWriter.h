@@ -0,0 +1,80 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Writes a stream as a sequence of checksummed blocks, so that corrupted
+// or truncated files can be rejected before they are decompressed.
+//
+// The layout is:
+//
+//   magic (4 bytes) block-size (u32)
+//   [ size (u32) crc32c (u32) size bytes ]*
+//   0 (u32) 0 (u32)
+//
+// where all u32 values are little endian. Each block (except the last) holds
+// block-size bytes, and block-size is at most MaxBlockSize. The empty block
+// marks the end of the stream, and hence a missing end implies the file was
+// truncated. Nothing may follow it.
+
+#ifndef DECOMPRESSOR_SRC_STREAM_CHECKSUMWRITER_H_
+#define DECOMPRESSOR_SRC_STREAM_CHECKSUMWRITER_H_
+
+#include <vector>
+
+#include "stream/RawStream.h"
+
+namespace wasm {
+
+namespace decode {
+
+class ChecksumWriter FINAL : public RawStream {
+  ChecksumWriter() = delete;
+  ChecksumWriter(const ChecksumWriter&) = delete;
+  ChecksumWriter& operator=(const ChecksumWriter&) = delete;
+
+ public:
+  static constexpr size_t MagicSize = 4;
+  static const ByteType Magic[MagicSize];
+  // Size of the header, and of the size and checksum preceding each block.
+  static constexpr size_t HeaderSize = 8;
+  static constexpr uint32_t DefaultBlockSize = uint32_t(1) << 16;
+  static constexpr uint32_t MaxBlockSize = uint32_t(1) << 24;
+
+  explicit ChecksumWriter(std::shared_ptr<RawStream> Output,
+                          uint32_t BlockSize = DefaultBlockSize);
+  ~ChecksumWriter() OVERRIDE;
+  AddressType read(ByteType* Buf, AddressType Size = 1) OVERRIDE;
+  bool write(ByteType* Buf, AddressType Size = 1) OVERRIDE;
+  bool freeze() OVERRIDE;
+  bool atEof() OVERRIDE;
+  bool hasErrors() OVERRIDE;
+
+ private:
+  std::shared_ptr<RawStream> Output;
+  uint32_t BlockSize;
+  std::vector<ByteType> Block;
+  bool WroteHeader;
+  bool IsFrozen;
+  bool FoundErrors;
+  bool writeHeader();
+  bool writeBlock(ByteType* Buf, uint32_t Size);
+};
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_STREAM_CHECKSUMWRITER_H_
@@ -30,10 +30,15 @@ Cursor::TraceContext::TraceContext(Cursor& Pos) : Pos(Pos) {}
 Cursor::TraceContext::~TraceContext() {}
 
 Cursor::Cursor(StreamType Type, std::shared_ptr<Queue> Que)
-    : PageCursor(Que->FirstPage, Que->FirstPage->getMinAddress()),
-      Type(Type),
-      Que(Que),
-      EobPtr(Que->getEofPtr()) {
+    : PageCursor(), Type(Type), Que(Que), EobPtr(Que->getEofPtr()) {
+  // Note: Doesn't allocate the first page of the queue. If not yet
+  // allocated, the page is found when the cursor is first used.
+  if (Que->FirstPage) {
+    CurPage = Que->FirstPage;
+    CurAddress = CurPage->getMinAddress();
+  } else {
+    StartPin = Que->StartPin;
+  }
   updateGuaranteedBeforeEob();
 }
 
@@ -55,10 +60,15 @@ Cursor::Cursor(const Cursor& C, AddressType StartAddress, bool ForRead)
   CurPage = ForRead ? Que->getReadPage(StartAddress)
                     : Que->getWritePage(StartAddress);
   CurAddress = StartAddress;
+  StartPin.reset();
   updateGuaranteedBeforeEob();
 }
 
-Cursor::Cursor() : PageCursor(), Type(StreamType::Byte) {}
+Cursor::Cursor()
+    : PageCursor(),
+      Type(StreamType::Byte),
+      GuaranteedBeforeEob(0),
+      GuaranteedBuffer(nullptr) {}
 
 Cursor::~Cursor() {}
 
@@ -74,6 +84,7 @@ void Cursor::swap(Cursor& C) {
   std::swap(CurByte, C.CurByte);
   std::swap(CurByte, C.CurByte);
   std::swap(GuaranteedBeforeEob, C.GuaranteedBeforeEob);
+  std::swap(GuaranteedBuffer, C.GuaranteedBuffer);
 }
 
 void Cursor::assign(const Cursor& C) {
@@ -83,6 +94,7 @@ void Cursor::assign(const Cursor& C) {
   EobPtr = C.EobPtr;
   CurByte = C.CurByte;
   GuaranteedBeforeEob = C.GuaranteedBeforeEob;
+  GuaranteedBuffer = C.GuaranteedBuffer;
 }
 
 bool Cursor::isQueueGood() const {
@@ -127,18 +139,27 @@ TraceContextPtr Cursor::getTraceContext() {
 
 void Cursor::close() {
   CurPage = Que->getErrorPage();
+  StartPin.reset();
   CurByte = 0;
-  GuaranteedBeforeEob = false;
+  GuaranteedBeforeEob = 0;
+  GuaranteedBuffer = nullptr;
 }
 
 void Cursor::updateGuaranteedBeforeEob() {
+  if (!CurPage) {
+    GuaranteedBeforeEob = 0;
+    GuaranteedBuffer = nullptr;
+    return;
+  }
   GuaranteedBeforeEob =
-      CurPage ? std::min(CurPage->getMaxAddress(), EobPtr->getEobAddress()) : 0;
+      std::min(CurPage->getMaxAddress(), EobPtr->getEobAddress());
+  GuaranteedBuffer = CurPage->getByteAddress(0);
 }
 
 void Cursor::fail() {
   Que->fail();
   CurPage = Que->getErrorPage();
+  StartPin.reset();
   CurAddress = kErrorPageAddress;
   updateGuaranteedBeforeEob();
   EobPtr->fail();
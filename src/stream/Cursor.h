@@ -75,7 +75,13 @@ class Cursor : public PageCursor {
   // End of block address.
   std::shared_ptr<BlockEob> EobPtr;
   ByteType CurByte;
+  // Addresses below GuaranteedBeforeEob are filled, on the current page, and
+  // before the end of the current block.
   AddressType GuaranteedBeforeEob;
+  // The buffer of the page GuaranteedBeforeEob was computed for, so that
+  // bytes below GuaranteedBeforeEob can be accessed without going through
+  // CurPage. Indexed using PageAddress().
+  ByteType* GuaranteedBuffer;
 
   Cursor(StreamType Type, std::shared_ptr<Queue> Que);
   explicit Cursor(const Cursor& C);
@@ -0,0 +1,171 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stream/MappedFileWriter.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wasm {
+
+namespace decode {
+
+static_assert(MappedFileWriter::ChunkSize % PageSize == 0,
+              "Mapped chunks must hold a whole number of pages");
+
+constexpr AddressType MappedFileWriter::ChunkSize;
+
+class MappedFileWriter::Chunk {
+  Chunk() = delete;
+  Chunk(const Chunk&) = delete;
+  Chunk& operator=(const Chunk&) = delete;
+
+ public:
+  explicit Chunk(ByteType* Base) : Base(Base) {}
+  ~Chunk() { munmap(Base, ChunkSize); }
+  ByteType* getBase() const { return Base; }
+
+ private:
+  ByteType* Base;
+};
+
+MappedFileWriter::MappedFileWriter(const char* Filename)
+    : FileWriter(Filename),
+      Fd(fileno(File)),
+      UseMap(false),
+      MapPages(false),
+      FileSize(0),
+      AllocatedSize(0) {
+#if defined(__linux__)
+  // Note: Standard output isn't mapped, since it may not start at offset 0.
+  struct stat Info;
+  if (FoundErrors || File == stdout || fstat(Fd, &Info) != 0 ||
+      !S_ISREG(Info.st_mode))
+    return;
+  // Shared writable mappings need a descriptor opened for reading and
+  // writing, while File is only open for writing. Hence, the file is opened
+  // again (checking that it is the same file).
+  int MapFd = open(Filename, O_RDWR);
+  if (MapFd < 0)
+    return;
+  struct stat MapInfo;
+  if (fstat(MapFd, &MapInfo) != 0 || MapInfo.st_dev != Info.st_dev ||
+      MapInfo.st_ino != Info.st_ino) {
+    close(MapFd);
+    return;
+  }
+  Fd = MapFd;
+  UseMap = true;
+#endif
+}
+
+MappedFileWriter::~MappedFileWriter() {
+  if (!freeze())
+    fprintf(stderr, "WARNING: Unable to close file!\n");
+  if (UseMap)
+    close(Fd);
+}
+
+std::shared_ptr<MappedFileWriter::Chunk> MappedFileWriter::getChunk(
+    size_t Index) {
+  if (Index < Chunks.size()) {
+    if (std::shared_ptr<Chunk> C = Chunks[Index].lock())
+      return C;
+  }
+  std::shared_ptr<Chunk> C;
+#if defined(__linux__)
+  AddressType Offset = Index * ChunkSize;
+  if (Offset + ChunkSize > AllocatedSize) {
+    // Only map preallocated bytes, so that running out of space is reported
+    // here, rather than as a fault when the mapped memory is written.
+    if (fallocate(Fd, 0, AllocatedSize, Offset + ChunkSize - AllocatedSize) !=
+        0)
+      return C;
+    AllocatedSize = Offset + ChunkSize;
+  }
+  void* Base =
+      mmap(nullptr, ChunkSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, Offset);
+  if (Base == MAP_FAILED)
+    return C;
+  C = std::make_shared<Chunk>(static_cast<ByteType*>(Base));
+  if (Index >= Chunks.size())
+    Chunks.resize(Index + 1);
+  Chunks[Index] = C;
+#endif
+  return C;
+}
+
+std::shared_ptr<Page> MappedFileWriter::allocatePage(AddressType PageIndex) {
+  if (PageIndex == 0)
+    MapPages = UseMap && !IsFrozen && FileSize == 0;
+  if (MapPages) {
+    AddressType Offset = minAddressForPage(PageIndex);
+    if (std::shared_ptr<Chunk> C = getChunk(Offset / ChunkSize))
+      return std::make_shared<MappedPage>(
+          PageIndex, C->getBase() + Offset % ChunkSize, C);
+  }
+  return FileWriter::allocatePage(PageIndex);
+}
+
+bool MappedFileWriter::writePage(std::shared_ptr<Page> Pg) {
+  if (!UseMap)
+    return FileWriter::writePage(Pg);
+  AddressType Size = Pg->getPageSize();
+  if (!Pg->isMapped() || Pg->getMinAddress() != FileSize)
+    return write(Pg->getByteAddress(0), Size);
+  // Already in the file.
+  FileSize += Size;
+  return true;
+}
+
+bool MappedFileWriter::write(ByteType* Buf, AddressType Size) {
+  if (!UseMap)
+    return FileWriter::write(Buf, Size);
+  if (IsFrozen)
+    return false;
+  while (Size) {
+    ssize_t Count = pwrite(Fd, Buf, Size, FileSize);
+    if (Count < 0) {
+      if (errno == EINTR)
+        continue;
+      FoundErrors = true;
+      return false;
+    }
+    Buf += Count;
+    Size -= Count;
+    FileSize += Count;
+  }
+  return true;
+}
+
+bool MappedFileWriter::freeze() {
+  if (IsFrozen)
+    return true;
+  bool Success = true;
+  if (UseMap && AllocatedSize > FileSize) {
+    // Remove the unused (preallocated) bytes.
+    Success = ftruncate(Fd, FileSize) == 0;
+  }
+  return FileWriter::freeze() && Success;
+}
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
@@ -0,0 +1,80 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Writes to a file. When the file is a regular file (on Linux), the file is
+// preallocated (using fallocate) and mapped into memory, a chunk at a time.
+// Pages of the queue dumped to the file are created in the mapped memory, so
+// writing a page doesn't copy its contents. When frozen, the file is
+// truncated to the number of bytes written. Otherwise, behaves like a
+// FileWriter.
+//
+// Note: Pages are only mapped for the first queue written to the file, since
+// only then do page addresses correspond to file offsets.
+
+#ifndef DECOMPRESSOR_SRC_STREAM_MAPPEDFILEWRITER_H_
+#define DECOMPRESSOR_SRC_STREAM_MAPPEDFILEWRITER_H_
+
+#include <vector>
+
+#include "stream/FileWriter.h"
+
+namespace wasm {
+
+namespace decode {
+
+class MappedFileWriter FINAL : public FileWriter {
+  MappedFileWriter() = delete;
+  MappedFileWriter(const MappedFileWriter&) = delete;
+  MappedFileWriter& operator=(const MappedFileWriter&) = delete;
+
+ public:
+  // Number of bytes mapped (and preallocated) at a time.
+  static constexpr AddressType ChunkSize = AddressType(64) << 20;
+
+  explicit MappedFileWriter(const char* Filename);
+  ~MappedFileWriter() OVERRIDE;
+  bool write(ByteType* Buf, AddressType Size = 1) OVERRIDE;
+  bool writePage(std::shared_ptr<Page> Pg) OVERRIDE;
+  std::shared_ptr<Page> allocatePage(AddressType PageIndex) OVERRIDE;
+  bool freeze() OVERRIDE;
+
+  // Returns true if the file is being written using mapped memory.
+  bool isMapping() const { return UseMap; }
+
+ private:
+  class Chunk;
+  // Descriptor of the file. When mapping, a separate (owned) descriptor that
+  // is open for reading and writing.
+  int Fd;
+  bool UseMap;
+  // True if pages of the current queue are created in mapped memory.
+  bool MapPages;
+  // Number of bytes written to the file.
+  AddressType FileSize;
+  // Number of bytes preallocated for the file.
+  AddressType AllocatedSize;
+  // Mapped chunks (indexed by file offset / ChunkSize). A chunk is unmapped
+  // once no page refers to it.
+  std::vector<std::weak_ptr<Chunk>> Chunks;
+  std::shared_ptr<Chunk> getChunk(size_t Index);
+};
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_STREAM_MAPPEDFILEWRITER_H_
@@ -16,18 +16,50 @@
 
 #include "stream/Page.h"
 #include "stream/Queue.h"
+#include "utils/HugePages.h"
+
+#include <cstring>
 
 namespace wasm {
 
 namespace decode {
 
-Page::Page(AddressType PageIndex)
-    : Index(PageIndex),
-      MinAddress(minAddressForPage(PageIndex)),
-      MaxAddress(minAddressForPage(PageIndex)) {
-  std::memset(&Buffer, 0, PageSize);
+namespace {
+
+class InlinePage FINAL : public Page {
+  InlinePage() = delete;
+  InlinePage(const InlinePage&) = delete;
+  InlinePage& operator=(const InlinePage&) = delete;
+
+ public:
+  explicit InlinePage(AddressType PageIndex)
+      : Page(PageIndex, Contents, false) {
+    memset(Contents, 0, PageSize);
+  }
+
+ private:
+  ByteType Contents[PageSize];
+};
+
+}  // end of anonymous namespace
+
+std::shared_ptr<Page> Page::create(AddressType PageIndex) {
+  return std::allocate_shared<InlinePage>(
+      alloc::HugePageAllocator<InlinePage>(), PageIndex);
 }
 
+Page::Page(AddressType PageIndex, ByteType* Buffer, bool IsMapped)
+    : Buffer(Buffer),
+      IsMapped(IsMapped),
+      Index(PageIndex),
+      MinAddress(minAddressForPage(PageIndex)),
+      MaxAddress(minAddressForPage(PageIndex)) {}
+
+MappedPage::MappedPage(AddressType PageIndex,
+                       ByteType* Buffer,
+                       std::shared_ptr<void> Owner)
+    : Page(PageIndex, Buffer, true), Owner(std::move(Owner)) {}
+
 AddressType Page::spaceRemaining() const {
   return MinAddress == MaxAddress
              ? PageSize
@@ -62,7 +62,8 @@ class Page : public std::enable_shared_from_this<Page> {
   friend class Queue;
 
  public:
-  Page(AddressType PageIndex);
+  // Creates a page whose contents are held (inline) in the page.
+  static std::shared_ptr<Page> create(AddressType PageIndex);
   AddressType spaceRemaining() const;
   AddressType getPageIndex() const { return Index; }
   AddressType getMinAddress() const { return MinAddress; }
@@ -74,13 +75,19 @@ class Page : public std::enable_shared_from_this<Page> {
   }
   ByteType getByte(AddressType i) const { return Buffer[i]; }
   ByteType* getByteAddress(AddressType i) { return &Buffer[i]; }
+  // Returns true if the contents are external memory (see MappedPage).
+  bool isMapped() const { return IsMapped; }
 
   // For debugging only.
   FILE* describe(FILE* File);
 
+ protected:
+  Page(AddressType PageIndex, ByteType* Buffer, bool IsMapped);
+
  private:
   // The contents of the page.
-  ByteType Buffer[PageSize];
+  ByteType* Buffer;
+  bool IsMapped;
   // The page index of the page.
   AddressType Index;
   // Note: Buffer address range is [MinAddress, MaxAddress).
@@ -89,6 +96,23 @@ class Page : public std::enable_shared_from_this<Page> {
   std::shared_ptr<Page> Next;
 };
 
+// A page whose contents are the (PageSize) bytes at Buffer, rather than
+// memory held in the page. Owner keeps Buffer valid while the page exists.
+// Note: The contents are assumed to be zero initialized.
+class MappedPage FINAL : public Page {
+  MappedPage() = delete;
+  MappedPage(const MappedPage&) = delete;
+  MappedPage& operator=(const MappedPage&) = delete;
+
+ public:
+  MappedPage(AddressType PageIndex,
+             ByteType* Buffer,
+             std::shared_ptr<void> Owner);
+
+ private:
+  std::shared_ptr<void> Owner;
+};
+
 void describePage(FILE* File, Page* Pg);
 
 }  // end of namespace decode
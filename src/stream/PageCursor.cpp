@@ -25,18 +25,13 @@ namespace decode {
 
 PageCursor::PageCursor() : CurAddress(0) {}
 
-PageCursor::PageCursor(Queue* Que)
-    : CurPage(Que->FirstPage), CurAddress(Que->FirstPage->getMinAddress()) {
-  assert(CurPage);
-}
-
 PageCursor::PageCursor(std::shared_ptr<Page> CurPage, AddressType CurAddress)
     : CurPage(CurPage), CurAddress(CurAddress) {
   assert(CurPage);
 }
 
 PageCursor::PageCursor(const PageCursor& PC)
-    : CurPage(PC.CurPage), CurAddress(PC.CurAddress) {
+    : CurPage(PC.CurPage), CurAddress(PC.CurAddress), StartPin(PC.StartPin) {
   //    assert(CurPage);
 }
 
@@ -45,11 +40,13 @@ PageCursor::~PageCursor() {}
 void PageCursor::assign(const PageCursor& C) {
   CurPage = C.CurPage;
   CurAddress = C.CurAddress;
+  StartPin = C.StartPin;
 }
 
 void PageCursor::swap(PageCursor& C) {
   std::swap(CurPage, C.CurPage);
   std::swap(CurAddress, C.CurAddress);
+  std::swap(StartPin, C.StartPin);
 }
 
 AddressType PageCursor::getMinAddress() const {
@@ -62,7 +62,6 @@ class PageCursor {
 
  public:
   PageCursor();
-  PageCursor(Queue* Que);
   PageCursor(std::shared_ptr<Page> CurPage, AddressType CurAddress);
   PageCursor(const PageCursor& PC);
   ~PageCursor();
@@ -86,6 +85,10 @@ class PageCursor {
   std::shared_ptr<Page> CurPage;
   // Absolute address.
   AddressType CurAddress;
+  // Held, instead of a page, by a cursor created before its queue allocated
+  // any pages. Keeps the queue from dumping pages the cursor has yet to
+  // access (see Queue::dumpPreviousPages()).
+  std::shared_ptr<void> StartPin;
 };
 
 }  // end of namespace decode
@@ -54,7 +54,11 @@ Pipe::Pipe()
       Output(std::make_shared<Queue>()),
       WritePos(utils::make_unique<WriteCursor2ReadQueue>(Output)) {}
 
-Pipe::~Pipe() {}
+Pipe::~Pipe() {
+  // Note: Must flush the input (if not already closed) while WritePos is
+  // still defined.
+  Input->close();
+}
 
 std::shared_ptr<Queue> Pipe::getInput() const {
   return Input;
@@ -29,14 +29,32 @@ Queue::Queue()
     : MinPeekSize(32),
       EofFrozen(false),
       Status(StatusValue::Good),
-      EofPtr(std::make_shared<BlockEob>()) {
+      EofPtr(std::make_shared<BlockEob>()),
+      PageMapBase(0),
+      StartPin(std::make_shared<char>(0)) {
   // Verify we have space for kErrorPageAddress and kUndefinedAddress.
   assert(PageSizeLog2 > 1);
-  LastPage = FirstPage = std::make_shared<Page>(0);
+}
+
+void Queue::allocateFirstPage() {
+  assert(!LastPage);
+  LastPage = FirstPage = createPage(0);
   PageMap.push_back(LastPage);
 }
 
+std::shared_ptr<Page> Queue::createPage(AddressType PageIndex) {
+  return Page::create(PageIndex);
+}
+
 void Queue::close() {
+  if (!LastPage) {
+    // Never used, so no pages to fill or dump.
+    if (!isEofFrozen()) {
+      EofPtr->setEobAddress(0);
+      EofFrozen = true;
+    }
+    return;
+  }
   if (!isEofFrozen()) {
     AddressType EofAddress = LastPage->getMaxAddress();
     freezeEof(EofAddress);
@@ -54,10 +72,12 @@ AddressType Queue::currentSize() const {
 }
 
 AddressType Queue::fillSize() const {
-  return LastPage->getMaxAddress();
+  return LastPage ? LastPage->getMaxAddress() : 0;
 }
 
 AddressType Queue::actualSize() const {
+  if (!FirstPage)
+    return 0;
   return LastPage->getMaxAddress() - FirstPage->getMinAddress();
 }
 
@@ -74,7 +94,7 @@ void Queue::describe(FILE* Out) {
     if (Pg)
       Pg->describe(Out);
     else
-      fprintf(Out, "Page[%" PRIuMAX "] = nullptr", uintmax_t(i));
+      fprintf(Out, "Page[%" PRIuMAX "] = nullptr", uintmax_t(PageMapBase + i));
     fprintf(Out, "\n");
   }
   if (ErrorPage) {
@@ -92,37 +112,39 @@ void Queue::fail() {
 std::shared_ptr<Page> Queue::getErrorPage() {
   if (ErrorPage)
     return ErrorPage;
-  ErrorPage = std::make_shared<Page>(kErrorPageIndex);
+  ErrorPage = Page::create(kErrorPageIndex);
   return ErrorPage;
 }
 
 std::shared_ptr<Page> Queue::getReadPage(AddressType& Address) const {
   AddressType Index = PageIndex(Address);
-  if (Index >= PageMap.size())
+  if (Index >= getPageMapEnd())
     return const_cast<Queue*>(this)->readFillToPage(Index, Address);
   return getDefinedPage(Index, Address);
 }
 
 std::shared_ptr<Page> Queue::getWritePage(AddressType& Address) const {
   AddressType Index = PageIndex(Address);
-  if (Index >= PageMap.size())
+  if (Index >= getPageMapEnd())
     return const_cast<Queue*>(this)->writeFillToPage(Index, Address);
   return getDefinedPage(Index, Address);
 }
 
 std::shared_ptr<Page> Queue::getCachedPage(AddressType& Address) {
   AddressType Index = PageIndex(Address);
-  if (Index >= PageMap.size())
+  if (Index >= getPageMapEnd())
     return failThenGetErrorPage(Address);
   return getDefinedPage(Index, Address);
 }
 
 std::shared_ptr<Page> Queue::getDefinedPage(AddressType Index,
                                             AddressType& Address) const {
-  assert(Index < PageMap.size());
-  std::shared_ptr<Page> Pg = PageMap[Index].lock();
-  if (Pg)
-    return Pg;
+  assert(Index < getPageMapEnd());
+  if (Index >= PageMapBase) {
+    std::shared_ptr<Page> Pg = PageMap[Index - PageMapBase].lock();
+    if (Pg)
+      return Pg;
+  }
   return const_cast<Queue*>(this)->failThenGetErrorPage(Address);
 }
 
@@ -133,10 +155,11 @@ std::shared_ptr<Page> Queue::failThenGetErrorPage(AddressType& Address) {
 }
 
 bool Queue::appendPage() {
+  getLastPage();
   AddressType NewPageIndex = LastPage->getPageIndex() + 1;
   if (NewPageIndex > kMaxPageIndex)
     return false;
-  std::shared_ptr<Page> NewPage = std::make_shared<Page>(NewPageIndex);
+  std::shared_ptr<Page> NewPage = createPage(NewPageIndex);
   PageMap.push_back(NewPage);
   LastPage->Next = NewPage;
   LastPage = NewPage;
@@ -144,19 +167,31 @@ bool Queue::appendPage() {
 }
 
 void Queue::dumpFirstPage() {
-  FirstPage = FirstPage->Next;
+  // Unlink the dumped page, so that holding onto it (see
+  // RawStream::writePage) doesn't lock the remaining pages.
+  std::shared_ptr<Page> Next = std::move(FirstPage->Next);
+  FirstPage = std::move(Next);
+  // Slide page map window past dumped pages.
+  AddressType NewBase = FirstPage ? FirstPage->getPageIndex() : getPageMapEnd();
+  while (PageMapBase < NewBase && !PageMap.empty()) {
+    PageMap.pop_front();
+    ++PageMapBase;
+  }
 }
 
 void Queue::dumpPreviousPages() {
-  while (FirstPage.unique())
+  // Note: Pages are kept while cursors that haven't accessed the queue
+  // (i.e. hold StartPin) exist, since they start at the first page.
+  while (FirstPage.unique() && StartPin.unique())
     dumpFirstPage();
 }
 
 bool Queue::readFill(AddressType Address) {
-  return Address < LastPage->getMaxAddress();
+  return Address < getLastPage()->getMaxAddress();
 }
 
 bool Queue::writeFill(AddressType Address, AddressType WantedSize) {
+  getLastPage();
   Address += WantedSize;
   // Expand till page exists.
   while (Address > LastPage->getMaxAddress()) {
@@ -176,7 +211,7 @@ bool Queue::writeFill(AddressType Address, AddressType WantedSize) {
 
 std::shared_ptr<Page> Queue::readFillToPage(AddressType Index,
                                             AddressType& Address) {
-  while (Index > LastPage->Index) {
+  while (Index > getLastPage()->Index) {
     bool ReadFillNextPage = readFill(LastPage->getMinAddress() + PageSize);
     if (!ReadFillNextPage && Index > LastPage->Index) {
       // This should only happen if we reach eof. Verify,
@@ -192,7 +227,7 @@ std::shared_ptr<Page> Queue::readFillToPage(AddressType Index,
 
 std::shared_ptr<Page> Queue::writeFillToPage(AddressType Index,
                                              AddressType& Address) {
-  while (Index > LastPage->Index) {
+  while (Index > getLastPage()->Index) {
     bool WriteFillNextPage = writeFill(LastPage->getMinAddress(), PageSize);
     if (!WriteFillNextPage && Index > LastPage->Index) {
       // This should only happen if we reach eof. Verify,
@@ -210,12 +245,16 @@ AddressType Queue::readFromPage(AddressType& Address,
                                 AddressType WantedSize,
                                 PageCursor& Cursor) {
   // Start by read-filling if necessary.
-  if (Address >= LastPage->getMaxAddress() && !readFill(Address))
+  if (Address >= getLastPage()->getMaxAddress() && !readFill(Address))
     return 0;
   // Find page associated with Address.
   Cursor.CurPage = getCachedPage(Address);
   Cursor.setCurAddress(Address);
+  Cursor.StartPin.reset();
   dumpPreviousPages();
+  // Note: Address is past the (empty) error page if broken.
+  if (isBroken(Cursor))
+    return 0;
   // Compute largest contiguous range of elements available.
   if (Address + WantedSize > Cursor.getMaxAddress())
     WantedSize = Cursor.getMaxAddress() - Address;
@@ -230,7 +269,11 @@ AddressType Queue::writeToPage(AddressType& Address,
     return 0;
   Cursor.CurPage = getCachedPage(Address);
   Cursor.setCurAddress(Address);
+  Cursor.StartPin.reset();
   dumpPreviousPages();
+  // Note: Address is past the (empty) error page if broken.
+  if (isBroken(Cursor))
+    return 0;
   // Compute largest contiguous range of bytes available.
   if (Address + WantedSize > Cursor.getMaxAddress())
     WantedSize = Cursor.getMaxAddress() - Address;
@@ -244,7 +287,7 @@ void Queue::freezeEof(AddressType& Address) {
     Address = 0;
   }
   // This call zero-fills pages if writing hasn't reached Address yet.
-  PageCursor Cursor(this);
+  PageCursor Cursor;
   writeToPage(Address, 0, Cursor);
   EofPtr->setEobAddress(Address);
   EofFrozen = true;
@@ -259,21 +302,22 @@ void Queue::freezeEof(AddressType& Address) {
 }
 
 bool Queue::isBroken(const PageCursor& C) const {
-  assert(C.CurPage);
-  return C.CurPage->getPageIndex() >= kErrorPageIndex;
+  // Note: Cursors that haven't accessed the queue don't have a page.
+  return C.CurPage && C.CurPage->getPageIndex() >= kErrorPageIndex;
 }
 
 AddressType Queue::read(AddressType& Address,
                         uint8_t* ToBuf,
                         AddressType WantedSize) {
   AddressType Count = 0;
-  PageCursor Cursor(this);
+  PageCursor Cursor;
   while (WantedSize) {
     AddressType FoundSize = readFromPage(Address, WantedSize, Cursor);
     if (FoundSize == 0)
       return Count;
     uint8_t* FromBuf = Cursor.getBufferPtr();
     memcpy(ToBuf, FromBuf, FoundSize);
+    ToBuf += FoundSize;
     Count += FoundSize;
     WantedSize -= FoundSize;
     Address += FoundSize;
@@ -284,13 +328,14 @@ AddressType Queue::read(AddressType& Address,
 bool Queue::write(AddressType& Address,
                   uint8_t* FromBuf,
                   AddressType WantedSize) {
-  PageCursor Cursor(this);
+  PageCursor Cursor;
   while (WantedSize) {
     AddressType FoundSize = writeToPage(Address, WantedSize, Cursor);
     if (FoundSize == 0)
       return false;
     uint8_t* ToBuf = Cursor.getBufferPtr();
     memcpy(ToBuf, FromBuf, FoundSize);
+    FromBuf += FoundSize;
     Address += FoundSize;
     WantedSize -= FoundSize;
   }
@@ -35,7 +35,7 @@
 #ifndef DECOMPRESSOR_SRC_STREAM_QUEUE_H_
 #define DECOMPRESSOR_SRC_STREAM_QUEUE_H_
 
-#include <vector>
+#include <deque>
 
 #include "stream/PageAddress.h"
 
@@ -141,7 +141,7 @@ class Queue : public std::enable_shared_from_this<Queue> {
   void describe(FILE* Out);
 
  protected:
-  typedef std::vector<std::weak_ptr<Page>> PageMapType;
+  typedef std::deque<std::weak_ptr<Page>> PageMapType;
   // Minimum peek size to maintain. That is, the minimal number of
   // bytes that the read can back up without freezing an address.
   AddressType MinPeekSize;
@@ -149,16 +149,32 @@ class Queue : public std::enable_shared_from_this<Queue> {
   bool EofFrozen;
   StatusValue Status;
   std::shared_ptr<BlockEob> EofPtr;
-  // First page still in queue.
+  // First page still in queue. Note: The first page is not allocated until
+  // needed (see getLastPage()).
   std::shared_ptr<Page> FirstPage;
   // Page at the current end of buffer.
   std::shared_ptr<Page> LastPage;
   // Page to use if an error occurs.
   std::shared_ptr<Page> ErrorPage;
-  // Fast page lookup map (from page index)
+  // Fast page lookup map (from page index). Only covers the window of pages
+  // [PageMapBase, PageMapBase + PageMap.size()). Entries are dropped when the
+  // corresponding page is dumped.
   PageMapType PageMap;
-
+  AddressType PageMapBase;
+  // Shared with cursors created before the first page is allocated (see
+  // PageCursor::StartPin).
+  std::shared_ptr<void> StartPin;
+
+  const std::shared_ptr<Page>& getLastPage() {
+    if (!LastPage)
+      allocateFirstPage();
+    return LastPage;
+  }
+  void allocateFirstPage();
   bool appendPage();
+  // Creates the page with the given index.
+  virtual std::shared_ptr<Page> createPage(AddressType PageIndex);
+  AddressType getPageMapEnd() const { return PageMapBase + PageMap.size(); }
 
   // Returns the page in the queue referred to Address, or nullptr if no
   // such page is in the byte queue.
@@ -174,7 +190,7 @@ class Queue : public std::enable_shared_from_this<Queue> {
                                         AddressType& Address);
 
   bool isValidPageAddress(AddressType Address) {
-    return PageIndex(Address) < PageMap.size();
+    return PageIndex(Address) < getPageMapEnd();
   }
 
   // Dumps and deletes the first page.  Note: Dumping only occurs if a
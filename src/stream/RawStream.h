@@ -20,6 +20,7 @@
 #ifndef DECOMPRESSOR_SRC_STREAM_RAWSTREAM_H
 #define DECOMPRESSOR_SRC_STREAM_RAWSTREAM_H
 
+#include "stream/Page.h"
 #include "utils/Defs.h"
 
 namespace wasm {
@@ -49,6 +50,26 @@ class RawStream : public std::enable_shared_from_this<RawStream> {
   // @result        - True if successful.
   virtual bool write(ByteType* Buf, AddressType Size = 1) = 0;
 
+  // Writes the contents of a page that is no longer used by its queue.
+  // Streams that can hold onto the page (rather than copy its contents)
+  // should override this.
+  //
+  // @param Pg      - The page to write.
+  // @result        - True if successful.
+  virtual bool writePage(std::shared_ptr<Page> Pg) {
+    return write(Pg->getByteAddress(0), Pg->getPageSize());
+  }
+
+  // Creates the page (with the given index) of a queue dumped to this
+  // stream. Streams that can provide the memory of the written page (rather
+  // than copying its contents) should override this.
+  //
+  // @param PageIndex - The index of the page to create.
+  // @result          - The created page.
+  virtual std::shared_ptr<Page> allocatePage(AddressType PageIndex) {
+    return Page::create(PageIndex);
+  }
+
   bool putc(ByteType ch) { return write(&ch, 1); }
 
   bool puts(charstring str) { return write((ByteType*)str, std::strlen(str)); }
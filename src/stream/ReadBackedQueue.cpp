@@ -33,7 +33,7 @@ ReadBackedQueue::~ReadBackedQueue() {}
 
 bool ReadBackedQueue::readFill(AddressType Address) {
   // Double check that there isn't more to read.
-  if (Address < LastPage->getMaxAddress())
+  if (Address < getLastPage()->getMaxAddress())
     return true;
   if (EofFrozen)
     return false;
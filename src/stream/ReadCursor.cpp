@@ -87,8 +87,7 @@ size_t ReadCursor::advance(size_t Distance) {
 }
 
 ByteType ReadCursor::readByte() {
-  return (CurAddress < GuaranteedBeforeEob) ? readOneByte()
-                                            : readByteAfterReadFill();
+  return readAlignedByte();
 }
 
 ByteType ReadCursor::readOneByte() {
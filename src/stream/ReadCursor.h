@@ -20,6 +20,7 @@
 #define DECOMPRESSOR_SRC_STREAM_READCURSOR_H
 
 #include "stream/Cursor.h"
+#include "stream/Page.h"
 
 namespace wasm {
 
@@ -44,6 +45,13 @@ class ReadCursor : public Cursor {
     assign(C);
     return *this;
   }
+  bool atEof() const OVERRIDE { return atReadEof(); }
+  // Non-virtual (inlinable) version of ReadCursor::atEof(). Note: Addresses
+  // below GuaranteedBeforeEob are filled, and hence can't be at the end of
+  // the file.
+  bool atReadEof() const {
+    return CurAddress >= GuaranteedBeforeEob && Cursor::atEof();
+  }
   virtual bool atEob();
   void pushEobAddress(AddressType NewValue);
   void popEobAddress();
@@ -52,6 +60,15 @@ class ReadCursor : public Cursor {
   virtual ByteType readByte();
   virtual ByteType readBit();
 
+  // Non-virtual (inlinable) version of ReadCursor::readByte(). Note: Derived
+  // cursors must only use this when their state matches the base cursor
+  // (i.e. a BitReadCursor that is byte aligned).
+  ByteType readAlignedByte() {
+    if (CurAddress < GuaranteedBeforeEob)
+      return GuaranteedBuffer[PageAddress(CurAddress++)];
+    return readByteAfterReadFill();
+  }
+
   // Try to advance Distance bytes. Returns actual number of bytes advanced.  If
   // zero is returned (and Distance > 0), no more bytes are available to advance
   // on.
@@ -62,6 +79,21 @@ class ReadCursor : public Cursor {
   uint8_t readByteAfterReadFill();
 };
 
+// Wraps a (byte aligned) read cursor, so that templated format readers
+// read bytes without virtual dispatch.
+class AlignedReadCursor {
+  AlignedReadCursor() = delete;
+  AlignedReadCursor(const AlignedReadCursor&) = delete;
+  AlignedReadCursor& operator=(const AlignedReadCursor&) = delete;
+
+ public:
+  explicit AlignedReadCursor(ReadCursor& Pos) : Pos(Pos) {}
+  ByteType readByte() { return Pos.readAlignedByte(); }
+
+ private:
+  ReadCursor& Pos;
+};
+
 }  // end of namespace decode
 
 }  // end of namespace wasm
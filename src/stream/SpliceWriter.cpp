@@ -0,0 +1,184 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stream/SpliceWriter.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/uio.h>
+#endif
+
+namespace wasm {
+
+namespace decode {
+
+// Recycles the memory of pages created by SpliceWriter::allocatePage. The
+// memory is mapped PagesPerChunk pages at a time, and is unmapped once the
+// writer and all of its pages are gone.
+// Note: Since the pipe keeps its own references to the memory of spliced
+// pages, the memory of a released page is discarded (using madvise) before
+// being reused. Hence, a reused page is backed by new (zeroed) memory.
+// Pages may be released by other threads, so the free list is locked.
+class SpliceWriter::PagePool {
+  PagePool(const PagePool&) = delete;
+  PagePool& operator=(const PagePool&) = delete;
+
+ public:
+  static constexpr size_t PagesPerChunk = 16;
+
+  PagePool() {}
+  ~PagePool() {
+#if defined(__linux__)
+    for (void* Base : Chunks)
+      munmap(Base, PagesPerChunk * PageSize);
+#endif
+  }
+
+  ByteType* allocate() {
+    std::lock_guard<std::mutex> Lock(PoolMutex);
+#if defined(__linux__)
+    if (FreePages.empty()) {
+      void* Base = mmap(nullptr, PagesPerChunk * PageSize,
+                        PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1, 0);
+      if (Base == MAP_FAILED)
+        return nullptr;
+      Chunks.push_back(Base);
+      auto* Pages = static_cast<ByteType*>(Base);
+      for (size_t i = PagesPerChunk; i > 0; --i)
+        FreePages.push_back(Pages + (i - 1) * PageSize);
+    }
+#endif
+    if (FreePages.empty())
+      return nullptr;
+    ByteType* Buffer = FreePages.back();
+    FreePages.pop_back();
+    return Buffer;
+  }
+
+  void release(ByteType* Buffer) {
+#if defined(__linux__)
+    madvise(Buffer, PageSize, MADV_DONTNEED);
+#endif
+    std::lock_guard<std::mutex> Lock(PoolMutex);
+    FreePages.push_back(Buffer);
+  }
+
+ private:
+  std::vector<void*> Chunks;
+  std::vector<ByteType*> FreePages;
+  std::mutex PoolMutex;
+};
+
+SpliceWriter::SpliceWriter(const char* Filename)
+    : FileWriter(Filename),
+      Fd(fileno(File)),
+      UseSplice(false),
+      Pool(std::make_shared<PagePool>()) {
+#if defined(__linux__)
+  struct stat Info;
+  if (FoundErrors || fstat(Fd, &Info) != 0 || !S_ISFIFO(Info.st_mode))
+    return;
+  UseSplice = true;
+#endif
+}
+
+SpliceWriter::~SpliceWriter() {}
+
+bool SpliceWriter::flush() {
+  if (!saveBuffer())
+    return false;
+  return fflush(File) == 0;
+}
+
+std::shared_ptr<Page> SpliceWriter::allocatePage(AddressType PageIndex) {
+#if defined(__linux__)
+  if (UseSplice && !IsFrozen) {
+    if (ByteType* Buffer = Pool->allocate()) {
+      // Note: The owner refers to the pool, since pages may outlive the
+      // writer.
+      std::shared_ptr<PagePool> MyPool = Pool;
+      std::shared_ptr<void> Owner(Buffer, [MyPool](void* Base) {
+        MyPool->release(static_cast<ByteType*>(Base));
+      });
+      return std::make_shared<MappedPage>(PageIndex, Buffer, Owner);
+    }
+  }
+#endif
+  return FileWriter::allocatePage(PageIndex);
+}
+
+bool SpliceWriter::writePage(std::shared_ptr<Page> Pg) {
+  AddressType Size = Pg->getPageSize();
+  // Note: Only mapped pages are spliced, since the memory of other pages may
+  // be reused once released.
+  if (!UseSplice || IsFrozen || Size == 0 || !Pg->isMapped())
+    return FileWriter::writePage(Pg);
+  // Keep bytes in order, by first writing out buffered bytes.
+  if (!flush())
+    return false;
+  return splice(Pg->getByteAddress(0), Size);
+}
+
+bool SpliceWriter::splice(ByteType* Buf, AddressType Size) {
+#if defined(__linux__)
+  while (Size) {
+    struct iovec Vec;
+    Vec.iov_base = Buf;
+    Vec.iov_len = Size;
+    ssize_t Count = vmsplice(Fd, &Vec, 1, 0);
+    if (Count < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EPIPE) {
+        // No reader.
+        FoundErrors = true;
+        return false;
+      }
+      // Not supported. Fall back to writing the remaining bytes.
+      UseSplice = false;
+      break;
+    }
+    Buf += Count;
+    Size -= Count;
+  }
+#endif
+  while (Size) {
+    ssize_t Count = ::write(Fd, Buf, Size);
+    if (Count < 0) {
+      if (errno == EINTR)
+        continue;
+      FoundErrors = true;
+      return false;
+    }
+    Buf += Count;
+    Size -= Count;
+  }
+  return true;
+}
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
@@ -0,0 +1,64 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Writes to a file descriptor. When the file is a pipe (on Linux), dumped
+// queue pages are handed to the kernel using vmsplice, rather than being
+// copied. Otherwise, behaves like a FileWriter.
+//
+// Note: The pipe refers to the memory of spliced pages until the bytes are
+// consumed (or longer, if the reader tees or splices them onward). Hence,
+// only pages created by allocatePage are spliced. Their memory is taken from
+// a pool, and discarded when the page is released, before being reused. This
+// is safe, since the pipe keeps its own references to the discarded memory.
+
+#ifndef DECOMPRESSOR_SRC_STREAM_SPLICEWRITER_H_
+#define DECOMPRESSOR_SRC_STREAM_SPLICEWRITER_H_
+
+#include "stream/FileWriter.h"
+
+namespace wasm {
+
+namespace decode {
+
+class SpliceWriter FINAL : public FileWriter {
+  SpliceWriter() = delete;
+  SpliceWriter(const SpliceWriter&) = delete;
+  SpliceWriter& operator=(const SpliceWriter&) = delete;
+
+ public:
+  explicit SpliceWriter(const char* Filename);
+  ~SpliceWriter() OVERRIDE;
+  bool writePage(std::shared_ptr<Page> Pg) OVERRIDE;
+  std::shared_ptr<Page> allocatePage(AddressType PageIndex) OVERRIDE;
+
+  // Returns true if pages are being spliced into a pipe.
+  bool isSplicing() const { return UseSplice; }
+
+ private:
+  class PagePool;
+  int Fd;
+  bool UseSplice;
+  std::shared_ptr<PagePool> Pool;
+  bool flush();
+  bool splice(ByteType* Buf, AddressType Size);
+};
+
+}  // end of namespace decode
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_STREAM_SPLICEWRITER_H_
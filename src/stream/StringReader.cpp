@@ -49,6 +49,10 @@ bool StringReader::atEof() {
   return Cursor >= Str.size();
 }
 
+bool StringReader::hasErrors() {
+  return false;
+}
+
 }  // end of namespace decode
 
 }  // end of namespace wasm
@@ -46,6 +46,10 @@ bool StringWriter::atEof() {
   return IsFrozen;
 }
 
+bool StringWriter::hasErrors() {
+  return false;
+}
+
 }  // end of namespace decode
 
 }  // end of namespace wasm
@@ -40,6 +40,7 @@ class StringWriter : public RawStream {
   bool write(ByteType* Buf, AddressType Size = 1) OVERRIDE;
   bool freeze() OVERRIDE;
   bool atEof() OVERRIDE;
+  bool hasErrors() OVERRIDE;
 
  private:
   std::string& Str;
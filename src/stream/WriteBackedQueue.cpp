@@ -34,12 +34,15 @@ WriteBackedQueue::~WriteBackedQueue() {
   close();
 }
 
+std::shared_ptr<Page> WriteBackedQueue::createPage(AddressType PageIndex) {
+  return Writer->allocatePage(PageIndex);
+}
+
 void WriteBackedQueue::dumpFirstPage() {
-  AddressType Address = 0;
-  AddressType Size = FirstPage->getMaxAddress() - FirstPage->getMinAddress();
-  if (!Writer->write(FirstPage->getByteAddress(Address), Size))
-    fail();
+  std::shared_ptr<Page> Pg = FirstPage;
   Queue::dumpFirstPage();
+  if (!Writer->writePage(Pg))
+    fail();
 }
 
 }  // end of decode namespace
@@ -41,6 +41,7 @@ class WriteBackedQueue FINAL : public Queue {
   // needed by reader.
   std::shared_ptr<RawStream> Writer;
 
+  std::shared_ptr<Page> createPage(AddressType PageIndex) OVERRIDE;
   void dumpFirstPage() OVERRIDE;
 };
 
@@ -0,0 +1,182 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on class AbbrevSelector.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "intcomp/AbbrevSelector.h"
+#include "utils/HuffmanEncoding.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::decode;
+using namespace wasm::intcomp;
+using namespace wasm::utils;
+
+constexpr size_t BufferSize = 12;
+
+class AbbrevSelectorTest : public ::testing::Test {
+ protected:
+  AbbrevSelectorTest()
+      : Root(std::make_shared<RootCountNode>()),
+        Buffer(BufferSize),
+        NextValue(0) {
+    addPattern({1, 2, 3, 4});
+    addPattern({1, 2});
+    addPattern({5, 6});
+    addPattern({7});
+  }
+
+  void addPattern(std::vector<IntType> Values) {
+    CountNode::IntPtr Nd;
+    for (IntType Value : Values)
+      Nd = Nd ? lookup(Nd, Value) : lookup(Root, Value);
+    Nd->setAbbrevIndex(Encoder.createSymbol(1));
+  }
+
+  // Returns the values of the stream at Index.
+  static IntType getValue(size_t Index) {
+    static const IntType Values[] = {1, 2, 3, 4, 9, 5, 6, 1, 2, 7, 8};
+    return Values[Index % size(Values)];
+  }
+
+  void fill() {
+    while (!Buffer.full())
+      Buffer.push_back(getValue(NextValue++));
+  }
+
+  // Checks that the abbreviations of Sel match the (leading) values of the
+  // buffer. Returns the abbreviations, in order.
+  std::vector<CountNode*> check(AbbrevSelection::Ptr Sel) {
+    std::vector<CountNode*> Abbrevs;
+    EXPECT_TRUE(bool(Sel)) << "No selection made";
+    if (!Sel)
+      return Abbrevs;
+    size_t IntsConsumed = Sel->getIntsConsumed();
+    EXPECT_GE(Buffer.size(), IntsConsumed);
+    for (; Sel; Sel = Sel->getPrevious())
+      Abbrevs.push_back(Sel->getAbbreviation().get());
+    std::reverse(Abbrevs.begin(), Abbrevs.end());
+    size_t Index = 0;
+    for (CountNode* Abbrev : Abbrevs) {
+      auto* IntNd = dyn_cast<IntCountNode>(Abbrev);
+      if (IntNd == nullptr) {
+        EXPECT_TRUE(isa<DefaultCountNode>(Abbrev));
+        ++Index;
+        continue;
+      }
+      Index += IntNd->getPathLength();
+      size_t ValueIndex = Index;
+      for (; IntNd != nullptr; IntNd = IntNd->getParent().get())
+        EXPECT_EQ(IntNd->getValue(), Buffer[--ValueIndex]);
+    }
+    EXPECT_EQ(IntsConsumed, Index);
+    return Abbrevs;
+  }
+
+  // Returns the number of values covered by the first NumAbbrevs
+  // abbreviations.
+  static size_t getLength(const std::vector<CountNode*>& Abbrevs,
+                          size_t NumAbbrevs) {
+    size_t Length = 0;
+    for (size_t i = 0; i < NumAbbrevs && i < Abbrevs.size(); ++i) {
+      auto* IntNd = dyn_cast<IntCountNode>(Abbrevs[i]);
+      Length += IntNd ? IntNd->getPathLength() : 1;
+    }
+    return Length;
+  }
+
+  void consume(AbbrevSelector& Selector, size_t NumInts) {
+    for (size_t i = 0; i < NumInts; ++i)
+      Buffer.pop_front();
+    Selector.consumed(NumInts);
+  }
+
+  HuffmanEncoder Encoder;
+  CountNode::RootPtr Root;
+  AbbrevSelector::BufferType Buffer;
+  CompressionFlags Flags;
+  size_t NextValue;
+};
+
+TEST_F(AbbrevSelectorTest, CarryOverMatchesFreshSelection) {
+  size_t NumCompared = 0;
+  AbbrevSelector Selector(Buffer, Root, Flags);
+  for (size_t i = 0; i < 20; ++i) {
+    fill();
+    AbbrevSelection::Ptr Sel = Selector.select(0);
+    std::vector<CountNode*> Abbrevs = check(Sel);
+    AbbrevSelector Fresh(Buffer, Root, Flags);
+    AbbrevSelection::Ptr FreshSel = Fresh.select(0);
+    check(FreshSel);
+    // Note: Selections may only cover a prefix of the buffer (i.e. when
+    // there is only one choice).
+    if (Sel && FreshSel && Sel->getIntsConsumed() == Buffer.size() &&
+        FreshSel->getIntsConsumed() == Buffer.size()) {
+      EXPECT_EQ(FreshSel->getWeight(), Sel->getWeight()) << "at step " << i;
+      ++NumCompared;
+    }
+    consume(Selector, getLength(Abbrevs, 1 + i % 3));
+  }
+  EXPECT_LT(size_t(0), NumCompared);
+}
+
+TEST_F(AbbrevSelectorTest, CarryOverBoundsLimitedSearch) {
+  AbbrevSelector Selector(Buffer, Root, Flags);
+  fill();
+  std::vector<CountNode*> Abbrevs = check(Selector.select(0));
+  size_t Consumed = getLength(Abbrevs, 2);
+  size_t NumCarried = Buffer.size() - Consumed;
+  consume(Selector, Consumed);
+  fill();
+  // With little effort, the carried over selection is the furthest found.
+  Selector.setEffortLimit(2);
+  AbbrevSelection::Ptr Sel = Selector.select(0);
+  check(Sel);
+  if (Sel) {
+    EXPECT_LE(NumCarried, Sel->getIntsConsumed());
+  }
+}
+
+TEST_F(AbbrevSelectorTest, StaleCarryOverIgnored) {
+  AbbrevSelector Selector(Buffer, Root, Flags);
+  fill();
+  std::vector<CountNode*> Abbrevs = check(Selector.select(0));
+  // Consume without ending on a selection boundary.
+  consume(Selector, getLength(Abbrevs, 1) + 1);
+  fill();
+  Abbrevs = check(Selector.select(0));
+  // Replace the values, so that carried over patterns no longer match.
+  consume(Selector, getLength(Abbrevs, 1));
+  while (!Buffer.empty())
+    Buffer.pop_front();
+  for (size_t i = 0; i < BufferSize; ++i)
+    Buffer.push_back(7 + i % 2);
+  check(Selector.select(0));
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on class AdaptiveHuffman.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "utils/AdaptiveHuffman.h"
+
+#include <vector>
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::utils;
+
+// Holds the bits of encoded symbols.
+class BitBuffer {
+ public:
+  BitBuffer() : ReadIndex(0) {}
+
+  void write(const AdaptiveHuffman& Model, size_t Symbol) {
+    AdaptiveHuffman::PathType Path = Model.getPath(Symbol);
+    for (unsigned i = 0; i < Model.getNumBits(Symbol); ++i) {
+      Bits.push_back(uint8_t(Path & 0x1));
+      Path >>= 1;
+    }
+  }
+
+  uint8_t readBit() {
+    EXPECT_LT(ReadIndex, Bits.size()) << "Read past end of bits";
+    return ReadIndex < Bits.size() ? Bits[ReadIndex++] : 0;
+  }
+
+  size_t size() const { return Bits.size(); }
+  bool atEnd() const { return ReadIndex == Bits.size(); }
+
+ private:
+  std::vector<uint8_t> Bits;
+  size_t ReadIndex;
+};
+
+// Encodes then decodes Symbols, using separate models. Returns the number
+// of bits used to encode.
+size_t roundTrip(size_t NumSymbols, const std::vector<size_t>& Symbols) {
+  AdaptiveHuffman Writer(NumSymbols);
+  BitBuffer Buffer;
+  for (size_t Symbol : Symbols) {
+    Buffer.write(Writer, Symbol);
+    Writer.update(Symbol);
+  }
+  AdaptiveHuffman Reader(NumSymbols);
+  for (size_t i = 0; i < Symbols.size(); ++i) {
+    size_t Symbol = Reader.decode(Buffer);
+    EXPECT_EQ(Symbols[i], Symbol) << "Symbol " << i << " decoded wrong";
+    if (Symbol != Symbols[i])
+      break;
+    Reader.update(Symbol);
+  }
+  EXPECT_TRUE(Buffer.atEnd()) << "Not all bits decoded";
+  return Buffer.size();
+}
+
+TEST(AdaptiveHuffmanTest, SingleSymbol) {
+  std::vector<size_t> Symbols(100, 0);
+  EXPECT_EQ(size_t(0), roundTrip(1, Symbols));
+}
+
+TEST(AdaptiveHuffmanTest, InitialCodeIsBalanced) {
+  AdaptiveHuffman Model(8);
+  for (size_t i = 0; i < Model.getNumSymbols(); ++i)
+    EXPECT_EQ(3U, Model.getNumBits(i));
+}
+
+TEST(AdaptiveHuffmanTest, RoundTripAcrossRebuilds) {
+  constexpr size_t NumSymbols = 37;
+  std::vector<size_t> Symbols;
+  // Enough symbols to rebuild many times, with a changing distribution.
+  for (size_t i = 0; i < 20000; ++i)
+    Symbols.push_back(i < 10000 ? (i * i) % 5 : (i * 7) % NumSymbols);
+  roundTrip(NumSymbols, Symbols);
+}
+
+TEST(AdaptiveHuffmanTest, AdaptsToSkew) {
+  constexpr size_t NumSymbols = 256;
+  constexpr size_t NumValues = 4096;
+  std::vector<size_t> Symbols;
+  for (size_t i = 0; i < NumValues; ++i)
+    Symbols.push_back(i % 16 == 0 ? i % NumSymbols : 3);
+  // A fixed code would use 8 bits per symbol.
+  EXPECT_GT(NumValues * 8 / 2, roundTrip(NumSymbols, Symbols));
+  AdaptiveHuffman Model(NumSymbols);
+  for (size_t Symbol : Symbols)
+    Model.update(Symbol);
+  EXPECT_EQ(1U, Model.getNumBits(3));
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
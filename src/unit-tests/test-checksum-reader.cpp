@@ -0,0 +1,133 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on classes ChecksumReader and ChecksumWriter.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "stream/ChecksumReader.h"
+#include "stream/ChecksumWriter.h"
+#include "stream/StringReader.h"
+#include "stream/StringWriter.h"
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::decode;
+
+std::string checksum(std::string Input, uint32_t BlockSize) {
+  std::string Output;
+  {
+    ChecksumWriter Writer(std::make_shared<StringWriter>(Output), BlockSize);
+    EXPECT_TRUE(Writer.write((ByteType*)&Input[0], Input.size()));
+    EXPECT_TRUE(Writer.freeze());
+    EXPECT_FALSE(Writer.hasErrors());
+  }
+  return Output;
+}
+
+bool verify(const std::string& Input) {
+  FILE* Out = fopen("/dev/null", "w");
+  bool Result =
+      ChecksumReader::verify((const ByteType*)Input.data(), Input.size(), Out);
+  fclose(Out);
+  return Result;
+}
+
+// Reads all of Input through a ChecksumReader, returning true if no errors
+// were found.
+bool readAll(std::string Input, std::string& Output) {
+  ChecksumReader Reader(std::make_shared<StringReader>(Input));
+  Output.clear();
+  ByteType Buffer[7];
+  while (AddressType Count = Reader.read(Buffer, sizeof(Buffer)))
+    Output.append((const char*)Buffer, Count);
+  return Reader.atEof() && !Reader.hasErrors();
+}
+
+void setU32(std::string& Bytes, size_t Pos, uint32_t Value) {
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    Bytes[Pos + i] = char(Value);
+    Value >>= 8;
+  }
+}
+
+const std::string Text("Some text that spans several checksummed blocks.");
+
+TEST(ChecksumReaderTest, RoundTrip) {
+  for (uint32_t BlockSize : {1, 5, 16, 1 << 16}) {
+    std::string Checked = checksum(Text, BlockSize);
+    EXPECT_TRUE(verify(Checked));
+    std::string Output;
+    EXPECT_TRUE(readAll(Checked, Output));
+    EXPECT_EQ(Text, Output);
+  }
+}
+
+TEST(ChecksumReaderTest, PassesThroughUnchecked) {
+  std::string Output;
+  EXPECT_TRUE(readAll(Text, Output));
+  EXPECT_EQ(Text, Output);
+  EXPECT_FALSE(verify(Text));
+}
+
+TEST(ChecksumReaderTest, RejectsBadBlockSize) {
+  std::string Checked = checksum(Text, 16);
+  std::string Output;
+  for (uint32_t BlockSize : {uint32_t(0), ChecksumWriter::MaxBlockSize + 1,
+                             uint32_t(0xffffffff)}) {
+    std::string Bad(Checked);
+    setU32(Bad, ChecksumWriter::MagicSize, BlockSize);
+    EXPECT_FALSE(verify(Bad));
+    EXPECT_FALSE(readAll(Bad, Output));
+    EXPECT_TRUE(Output.empty());
+  }
+}
+
+TEST(ChecksumReaderTest, RejectsTrailingBytes) {
+  std::string Checked = checksum(Text, 16);
+  std::string Output;
+  std::string Bad = Checked + "x";
+  EXPECT_FALSE(verify(Bad));
+  EXPECT_FALSE(readAll(Bad, Output));
+  // A second (empty) end block is also trailing bytes.
+  Bad = Checked + Checked.substr(Checked.size() - ChecksumWriter::HeaderSize);
+  EXPECT_FALSE(verify(Bad));
+  EXPECT_FALSE(readAll(Bad, Output));
+}
+
+TEST(ChecksumReaderTest, RejectsCorruptAndTruncated) {
+  std::string Checked = checksum(Text, 16);
+  std::string Output;
+  std::string Bad(Checked);
+  Bad[ChecksumWriter::HeaderSize * 2 + 3] ^= 1;
+  EXPECT_FALSE(verify(Bad));
+  EXPECT_FALSE(readAll(Bad, Output));
+  for (size_t Size = ChecksumWriter::MagicSize; Size < Checked.size();
+       ++Size) {
+    Bad = Checked.substr(0, Size);
+    EXPECT_FALSE(verify(Bad)) << "Size " << Size;
+    EXPECT_FALSE(readAll(Bad, Output)) << "Size " << Size;
+  }
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
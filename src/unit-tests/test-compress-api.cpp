@@ -0,0 +1,109 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on compressing concurrently, using the C API of the
+// compressor.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "intcomp/Compress.h"
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr const char* InputFilename = "test/test-sources/0xD/br.wasm";
+constexpr size_t NumThreads = 4;
+
+std::vector<uint8_t> readFile(const char* Filename) {
+  std::vector<uint8_t> Bytes;
+  FILE* File = fopen(Filename, "rb");
+  if (File == nullptr)
+    return Bytes;
+  int Ch;
+  while ((Ch = fgetc(File)) != EOF)
+    Bytes.push_back(uint8_t(Ch));
+  fclose(File);
+  return Bytes;
+}
+
+bool appendOutput(void* Data, const uint8_t* Buffer, int32_t Size) {
+  auto* Output = (std::vector<uint8_t>*)Data;
+  Output->insert(Output->end(), Buffer, Buffer + Size);
+  return true;
+}
+
+int32_t compress(const std::vector<uint8_t>& Input,
+                 const void* Flags,
+                 std::vector<uint8_t>& Output) {
+  return compress_buffer(Input.data(), int32_t(Input.size()), Flags,
+                         appendOutput, &Output);
+}
+
+// Compresses Input in NumThreads threads at once, and checks that each
+// thread generates the same output as compressing in a single thread.
+void compressConcurrently(const std::vector<uint8_t>& Input,
+                          const void* Flags) {
+  std::vector<uint8_t> Expected;
+  ASSERT_EQ(COMPRESSOR_SUCCESS, compress(Input, Flags, Expected));
+  ASSERT_FALSE(Expected.empty());
+  std::vector<std::vector<uint8_t>> Outputs(NumThreads);
+  std::vector<int32_t> Results(NumThreads);
+  std::vector<std::thread> Threads;
+  for (size_t i = 0; i < NumThreads; ++i)
+    Threads.emplace_back(
+        [&, i]() { Results[i] = compress(Input, Flags, Outputs[i]); });
+  for (std::thread& Thread : Threads)
+    Thread.join();
+  for (size_t i = 0; i < NumThreads; ++i) {
+    EXPECT_EQ(COMPRESSOR_SUCCESS, Results[i]) << "Thread " << i;
+    EXPECT_EQ(Expected, Outputs[i]) << "Thread " << i;
+  }
+}
+
+class CompressApiTest : public ::testing::Test {
+ protected:
+  CompressApiTest()
+      : Input(readFile(InputFilename)), Flags(create_compression_flags()) {
+    // Use the (default) cutoffs of compress-int.
+    set_compression_cutoffs(Flags, 100, 100);
+  }
+  ~CompressApiTest() { destroy_compression_flags(Flags); }
+
+  std::vector<uint8_t> Input;
+  void* Flags;
+};
+
+TEST_F(CompressApiTest, ConcurrentMatchesSingleThreaded) {
+  ASSERT_FALSE(Input.empty()) << "Can't read " << InputFilename;
+  compressConcurrently(Input, Flags);
+}
+
+TEST_F(CompressApiTest, ConcurrentCismMatchesSingleThreaded) {
+  ASSERT_FALSE(Input.empty()) << "Can't read " << InputFilename;
+  set_compression_cism(Flags, true, false);
+  compressConcurrently(Input, Flags);
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,161 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on resuming and cancelling decompression, using the
+// C API of the decompressor.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "interp/Decompress.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr const char* InputFilename = "test/test-sources/0xD/br_table.wasm-w";
+constexpr int32_t ChunkSize = 1024;
+
+std::vector<uint8_t> readFile(const char* Filename) {
+  std::vector<uint8_t> Bytes;
+  FILE* File = fopen(Filename, "rb");
+  if (File == nullptr)
+    return Bytes;
+  int Ch;
+  while ((Ch = fgetc(File)) != EOF)
+    Bytes.push_back(uint8_t(Ch));
+  fclose(File);
+  return Bytes;
+}
+
+// Decompresses Input (in chunks), appending to Output. Counts the number of
+// calls that stopped at a limit. Returns the final status.
+int32_t decompress(void* Decomp,
+                   const std::vector<uint8_t>& Input,
+                   std::vector<uint8_t>& Output,
+                   size_t& NumPending) {
+  uint8_t* Buffer = get_decompressor_buffer(Decomp, ChunkSize);
+  size_t InputPos = 0;
+  int32_t Status = 0;
+  NumPending = 0;
+  while (Status >= 0) {
+    while (Status > 0) {
+      int32_t Size = std::min(Status, ChunkSize);
+      if (!fetch_decompressor_output(Decomp, Size))
+        return DECOMPRESSOR_ERROR;
+      Output.insert(Output.end(), Buffer, Buffer + Size);
+      Status -= Size;
+    }
+    if (decompression_pending(Decomp)) {
+      ++NumPending;
+      Status = continue_decompression(Decomp);
+      continue;
+    }
+    int32_t Size =
+        int32_t(std::min(Input.size() - InputPos, size_t(ChunkSize)));
+    memcpy(Buffer, Input.data() + InputPos, Size);
+    InputPos += Size;
+    Status = resume_decompression(Decomp, Size);
+  }
+  return Status;
+}
+
+class DecompressApiTest : public ::testing::Test {
+ protected:
+  DecompressApiTest()
+      : Input(readFile(InputFilename)), Decomp(create_decompressor()) {}
+  ~DecompressApiTest() { destroy_decompressor(Decomp); }
+
+  std::vector<uint8_t> Input;
+  void* Decomp;
+};
+
+TEST_F(DecompressApiTest, NoLimits) {
+  ASSERT_FALSE(Input.empty()) << "Can't read " << InputFilename;
+  std::vector<uint8_t> Output;
+  size_t NumPending;
+  EXPECT_EQ(DECOMPRESSOR_SUCCESS,
+            decompress(Decomp, Input, Output, NumPending));
+  EXPECT_EQ(size_t(0), NumPending);
+  EXPECT_TRUE(Input == Output);
+}
+
+TEST_F(DecompressApiTest, ResumeWithStepLimit) {
+  ASSERT_FALSE(Input.empty()) << "Can't read " << InputFilename;
+  set_decompressor_limits(Decomp, 100, 0, 0);
+  std::vector<uint8_t> Output;
+  size_t NumPending;
+  EXPECT_EQ(DECOMPRESSOR_SUCCESS,
+            decompress(Decomp, Input, Output, NumPending));
+  EXPECT_LT(size_t(0), NumPending);
+  EXPECT_TRUE(Input == Output);
+}
+
+TEST_F(DecompressApiTest, ContinueWithoutPendingWork) {
+  EXPECT_FALSE(decompression_pending(Decomp));
+  EXPECT_EQ(0, continue_decompression(Decomp));
+}
+
+TEST_F(DecompressApiTest, CancelWhilePending) {
+  ASSERT_FALSE(Input.empty()) << "Can't read " << InputFilename;
+  set_decompressor_limits(Decomp, 10, 0, 0);
+  int32_t Size = int32_t(Input.size());
+  uint8_t* Buffer = get_decompressor_buffer(Decomp, Size);
+  memcpy(Buffer, Input.data(), Size);
+  int32_t Status = resume_decompression(Decomp, Size);
+  // Note: Input may not be processed until it is closed.
+  for (int i = 0; i < 10 && Status >= 0 && !decompression_pending(Decomp); ++i)
+    Status = resume_decompression(Decomp, 0);
+  ASSERT_TRUE(decompression_pending(Decomp));
+  cancel_decompression(Decomp);
+  EXPECT_EQ(DECOMPRESSOR_ERROR, continue_decompression(Decomp));
+  EXPECT_EQ(DECOMPRESSOR_ERROR, resume_decompression(Decomp, 0));
+}
+
+TEST_F(DecompressApiTest, CancelFromAnotherThread) {
+  ASSERT_FALSE(Input.empty()) << "Can't read " << InputFilename;
+  set_decompressor_limits(Decomp, 100, 0, 0);
+  void* D = Decomp;
+  std::thread Canceller([D]() { cancel_decompression(D); });
+  std::vector<uint8_t> Output;
+  size_t NumPending;
+  int32_t Status = decompress(Decomp, Input, Output, NumPending);
+  Canceller.join();
+  // Note: Decompression may have finished before the cancel.
+  EXPECT_TRUE(Status == DECOMPRESSOR_ERROR || Status == DECOMPRESSOR_SUCCESS);
+  EXPECT_EQ(DECOMPRESSOR_ERROR, resume_decompression(Decomp, 0));
+  EXPECT_EQ(DECOMPRESSOR_ERROR, continue_decompression(Decomp));
+}
+
+TEST_F(DecompressApiTest, CancelBeforeResume) {
+  ASSERT_FALSE(Input.empty()) << "Can't read " << InputFilename;
+  cancel_decompression(Decomp);
+  uint8_t* Buffer = get_decompressor_buffer(Decomp, ChunkSize);
+  memcpy(Buffer, Input.data(), ChunkSize);
+  EXPECT_EQ(DECOMPRESSOR_ERROR, resume_decompression(Decomp, ChunkSize));
+  EXPECT_FALSE(fetch_decompressor_output(Decomp, 1));
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
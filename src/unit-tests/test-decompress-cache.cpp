@@ -0,0 +1,193 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on classes DecompressCache and Sha256.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "interp/DecompressCache.h"
+#include "utils/Sha256.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::interp;
+using namespace wasm::utils;
+
+// Creates a fresh cache directory, removing it (and its entries) when done.
+class TempDirectory {
+  TempDirectory(const TempDirectory&) = delete;
+  TempDirectory& operator=(const TempDirectory&) = delete;
+
+ public:
+  TempDirectory() {
+    char Template[] = "/tmp/test-decompress-cache-XXXXXX";
+    Name = mkdtemp(Template);
+  }
+  ~TempDirectory() {
+    std::string Command = "rm -rf " + Name;
+    if (system(Command.c_str()) != 0)
+      fprintf(stderr, "Unable to remove: %s\n", Name.c_str());
+  }
+  const std::string& getName() const { return Name; }
+
+ private:
+  std::string Name;
+};
+
+std::vector<uint8_t> toBytes(const std::string& Text) {
+  return std::vector<uint8_t>(Text.begin(), Text.end());
+}
+
+std::string getKey(const DecompressCache& Cache, const std::string& Input) {
+  return Cache.getKey(reinterpret_cast<const uint8_t*>(Input.data()),
+                      Input.size());
+}
+
+std::string getEntryFilename(const DecompressCache& Cache,
+                             const std::string& Key) {
+  return Cache.getDirectory() + "/" + Key + ".wcache";
+}
+
+bool exists(const std::string& Filename) {
+  struct stat Info;
+  return stat(Filename.c_str(), &Info) == 0;
+}
+
+std::string sha256(const std::string& Text) {
+  Sha256 Hash;
+  Hash.add(reinterpret_cast<const uint8_t*>(Text.data()), Text.size());
+  return Hash.getHexDigest();
+}
+
+TEST(DecompressCacheTest, Sha256Vectors) {
+  EXPECT_EQ(
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+      sha256(""));
+  EXPECT_EQ(
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+      sha256("abc"));
+  EXPECT_EQ(
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+      sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+  // Adding in pieces must give the same digest.
+  std::string Text(1000, 'a');
+  Sha256 Hash;
+  for (size_t i = 0; i < Text.size(); i += 7) {
+    size_t Size = std::min(size_t(7), Text.size() - i);
+    Hash.add(reinterpret_cast<const uint8_t*>(Text.data()) + i, Size);
+  }
+  EXPECT_EQ(sha256(Text), Hash.getHexDigest());
+}
+
+TEST(DecompressCacheTest, InsertLookup) {
+  TempDirectory Dir;
+  DecompressCache Cache(Dir.getName());
+  ASSERT_TRUE(Cache.isValid());
+  std::string Key = getKey(Cache, "input");
+  std::vector<uint8_t> Output;
+  EXPECT_FALSE(Cache.lookup(Key, Output));
+  EXPECT_TRUE(Cache.insert(Key, toBytes("output")));
+  EXPECT_TRUE(Cache.lookup(Key, Output));
+  EXPECT_EQ(toBytes("output"), Output);
+
+  // Entries persist across caches with the same fingerprint.
+  DecompressCache Reopened(Dir.getName());
+  EXPECT_EQ(Key, getKey(Reopened, "input"));
+  EXPECT_TRUE(Reopened.lookup(Key, Output));
+  EXPECT_EQ(toBytes("output"), Output);
+}
+
+TEST(DecompressCacheTest, KeysDiffer) {
+  TempDirectory Dir;
+  DecompressCache Cache(Dir.getName());
+  DecompressCache WithOption(Dir.getName());
+  WithOption.addOption(1);
+  std::string Key = getKey(Cache, "input");
+  EXPECT_NE(Key, getKey(Cache, "inpuT"));
+  EXPECT_NE(Key, getKey(Cache, "input "));
+  EXPECT_NE(Key, getKey(WithOption, "input"));
+  EXPECT_TRUE(Cache.insert(Key, toBytes("output")));
+  std::vector<uint8_t> Output;
+  EXPECT_FALSE(WithOption.lookup(getKey(WithOption, "input"), Output));
+}
+
+TEST(DecompressCacheTest, RemovesCorruptEntries) {
+  TempDirectory Dir;
+  DecompressCache Cache(Dir.getName());
+  std::string Key = getKey(Cache, "input");
+  EXPECT_TRUE(Cache.insert(Key, toBytes("output")));
+  std::string Filename = getEntryFilename(Cache, Key);
+  ASSERT_TRUE(exists(Filename));
+  // Flip a byte of the output.
+  FILE* File = fopen(Filename.c_str(), "r+b");
+  ASSERT_NE(nullptr, File);
+  fseek(File, -1, SEEK_END);
+  fputc('X', File);
+  fclose(File);
+  std::vector<uint8_t> Output;
+  EXPECT_FALSE(Cache.lookup(Key, Output));
+  EXPECT_TRUE(Output.empty());
+  EXPECT_FALSE(exists(Filename));
+}
+
+TEST(DecompressCacheTest, EvictsLeastRecentlyUsed) {
+  TempDirectory Dir;
+  // Holds three entries (with headers), but not four. Evicting removes
+  // entries until a quarter of the cache is free.
+  const std::vector<uint8_t> Data(100, 'x');
+  DecompressCache Cache(Dir.getName(), 400);
+  std::vector<std::string> Keys;
+  for (size_t i = 0; i < 6; ++i)
+    Keys.push_back(getKey(Cache, std::to_string(i)));
+  for (size_t i = 0; i < 5; ++i) {
+    EXPECT_TRUE(Cache.insert(Keys[i], Data));
+    // Age the entry, so that the order of use is well defined.
+    struct utimbuf Times;
+    Times.actime = Times.modtime = time(nullptr) - 100 + time_t(i);
+    utime(getEntryFilename(Cache, Keys[i]).c_str(), &Times);
+    if (i == 3) {
+      EXPECT_FALSE(exists(getEntryFilename(Cache, Keys[0])));
+      EXPECT_FALSE(exists(getEntryFilename(Cache, Keys[1])));
+      EXPECT_TRUE(exists(getEntryFilename(Cache, Keys[2])));
+      EXPECT_TRUE(exists(getEntryFilename(Cache, Keys[3])));
+    }
+  }
+
+  // Using an entry keeps it over entries used later.
+  std::vector<uint8_t> Output;
+  EXPECT_TRUE(Cache.lookup(Keys[2], Output));
+  EXPECT_TRUE(Cache.insert(Keys[5], Data));
+  EXPECT_TRUE(exists(getEntryFilename(Cache, Keys[2])));
+  EXPECT_FALSE(exists(getEntryFilename(Cache, Keys[3])));
+  EXPECT_FALSE(exists(getEntryFilename(Cache, Keys[4])));
+  EXPECT_TRUE(exists(getEntryFilename(Cache, Keys[5])));
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
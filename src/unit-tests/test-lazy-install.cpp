@@ -0,0 +1,183 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on installing (deferred) defines of lazily installed
+// algorithms.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "casm/CasmReader.h"
+#include "interp/ByteReader.h"
+#include "interp/IntWriter.h"
+#include "interp/Interpreter.h"
+#include "sexp/Ast.h"
+#include "stream/ArrayReader.h"
+#include "stream/ReadBackedQueue.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::decode;
+using namespace wasm::filt;
+using namespace wasm::interp;
+
+// Defines 'file' and (tail recursive) 'run'.
+constexpr const char* AlgorithmFilename = "test/test-sources/TailCalls.cast";
+
+// Calls 'run' of the enclosing scope from its own 'file'.
+constexpr const char* EnclosedAlgorithm =
+    "(header (u32.const 0x6d736163) (u32.const 0x0))\n"
+    "(header.read (u32.const 0x6c696174) (u32.const 0x0))\n"
+    "(define 'file' (loop.unbounded (eval 'run')))\n";
+
+std::shared_ptr<SymbolTable> readLazily(
+    const char* Filename,
+    std::shared_ptr<SymbolTable> EnclosingScope) {
+  CasmReader Reader;
+  Reader.setInstall(false).readText(Filename, EnclosingScope);
+  std::shared_ptr<SymbolTable> Symtab = Reader.getReadSymtab();
+  if (!Symtab)
+    return Symtab;
+  Symtab->setLazyInstall(true);
+  if (!Symtab->install())
+    Symtab.reset();
+  return Symtab;
+}
+
+std::shared_ptr<SymbolTable> readEnclosedLazily(
+    std::shared_ptr<SymbolTable> EnclosingScope) {
+  char Filename[] = "/tmp/test-lazy-install-XXXXXX";
+  int Fd = mkstemp(Filename);
+  if (Fd < 0)
+    return std::shared_ptr<SymbolTable>();
+  FILE* File = fdopen(Fd, "w");
+  fputs(EnclosedAlgorithm, File);
+  fclose(File);
+  std::shared_ptr<SymbolTable> Symtab = readLazily(Filename, EnclosingScope);
+  unlink(Filename);
+  return Symtab;
+}
+
+std::vector<uint8_t> makeInput() {
+  std::vector<uint8_t> Bytes = {'t', 'a', 'i', 'l', 0, 0, 0, 0};
+  for (size_t i = 0; i < 100; ++i) {
+    for (size_t j = 0; j <= i % 7; ++j)
+      Bytes.push_back(uint8_t('a' + j));
+    Bytes.push_back(0);
+  }
+  return Bytes;
+}
+
+// Returns the description of Contents, so that streams can be compared.
+std::string describe(IntStream& Contents) {
+  char* Buffer = nullptr;
+  size_t Size = 0;
+  FILE* Out = open_memstream(&Buffer, &Size);
+  Contents.describe(Out);
+  fclose(Out);
+  std::string Description(Buffer, Size);
+  free(Buffer);
+  return Description;
+}
+
+std::string run(std::shared_ptr<SymbolTable> Symtab,
+                const std::vector<uint8_t>& Bytes) {
+  auto Contents = std::make_shared<IntStream>();
+  auto Input = std::make_shared<ReadBackedQueue>(
+      std::make_shared<ArrayReader>(Bytes.data(), Bytes.size()));
+  Interpreter MyReader(std::make_shared<ByteReader>(Input),
+                       std::make_shared<IntWriter>(Contents),
+                       InterpreterFlags(), Symtab);
+  MyReader.algorithmRead();
+  EXPECT_TRUE(MyReader.isFinished() && MyReader.isSuccessful());
+  return describe(*Contents);
+}
+
+const Define* getDefine(SymbolTable& Symtab, const char* Name) {
+  Symbol* Sym = Symtab.getSymbol(Name);
+  return Sym == nullptr ? nullptr : Sym->getDefineDefinition();
+}
+
+// Returns the (tail) call of 'run' within the body of 'run'.
+const Eval* getRecursiveCall(const Define* Run) {
+  return dyn_cast<Eval>(Run->getBody()->getKid(1));
+}
+
+TEST(LazyInstallTest, InstallsInOwnScope) {
+  std::shared_ptr<SymbolTable> Outer = readLazily(AlgorithmFilename, nullptr);
+  ASSERT_TRUE(bool(Outer)) << "Can't read " << AlgorithmFilename;
+  std::shared_ptr<SymbolTable> Inner = readEnclosedLazily(Outer);
+  ASSERT_TRUE(bool(Inner));
+  const Define* Run = getDefine(*Outer, "run");
+  ASSERT_NE(nullptr, Run);
+  EXPECT_TRUE(Run->needsInstall());
+  const Eval* Call = getRecursiveCall(Run);
+  ASSERT_NE(nullptr, Call);
+  EXPECT_EQ(nullptr, Call->getBoundDefine());
+
+  // Installing 'run' through the inner scope binds it in its own scope.
+  std::vector<uint8_t> Bytes = makeInput();
+  std::string Expected = run(Inner, Bytes);
+  EXPECT_FALSE(Run->needsInstall());
+  EXPECT_EQ(Run, Call->getBoundDefine());
+  EXPECT_TRUE(Call->isTailCall());
+  EXPECT_EQ(Run, Inner->getBoundDefine(Call));
+  EXPECT_EQ(Expected, run(Outer, Bytes));
+  EXPECT_EQ(Expected, run(Inner, Bytes));
+}
+
+TEST(LazyInstallTest, InstallsOnceFromTwoThreads) {
+  std::vector<uint8_t> Bytes = makeInput();
+  std::string Expected;
+  {
+    std::shared_ptr<SymbolTable> Outer =
+        readLazily(AlgorithmFilename, nullptr);
+    ASSERT_TRUE(bool(Outer)) << "Can't read " << AlgorithmFilename;
+    Expected = run(Outer, Bytes);
+  }
+  for (size_t Trial = 0; Trial < 20; ++Trial) {
+    std::shared_ptr<SymbolTable> Outer =
+        readLazily(AlgorithmFilename, nullptr);
+    ASSERT_TRUE(bool(Outer)) << "Can't read " << AlgorithmFilename;
+    std::shared_ptr<SymbolTable> Inner = readEnclosedLazily(Outer);
+    ASSERT_TRUE(bool(Inner));
+    std::string OuterResult;
+    std::string InnerResult;
+    std::thread OuterThread([&]() { OuterResult = run(Outer, Bytes); });
+    std::thread InnerThread([&]() { InnerResult = run(Inner, Bytes); });
+    OuterThread.join();
+    InnerThread.join();
+    EXPECT_EQ(Expected, OuterResult) << "Trial " << Trial;
+    EXPECT_EQ(Expected, InnerResult) << "Trial " << Trial;
+    const Define* Run = getDefine(*Outer, "run");
+    ASSERT_NE(nullptr, Run);
+    EXPECT_FALSE(Run->needsInstall());
+    EXPECT_EQ(Run, getRecursiveCall(Run)->getBoundDefine());
+  }
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,176 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on class MappedFileWriter.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "stream/MappedFileWriter.h"
+#include "stream/Page.h"
+#include "stream/WriteBackedQueue.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::decode;
+
+// Creates a fresh (empty) file, removing it when done.
+class TempFile {
+  TempFile(const TempFile&) = delete;
+  TempFile& operator=(const TempFile&) = delete;
+
+ public:
+  TempFile() {
+    char Template[] = "/tmp/test-mapped-file-writer-XXXXXX";
+    int Fd = mkstemp(Template);
+    if (Fd >= 0)
+      close(Fd);
+    Name = Template;
+  }
+  ~TempFile() { unlink(Name.c_str()); }
+  const char* getName() const { return Name.c_str(); }
+
+ private:
+  std::string Name;
+};
+
+// Limits the size of files written by the process (making fallocate fail
+// with EFBIG past the limit), restoring the limit when done.
+class FileSizeLimit {
+  FileSizeLimit() = delete;
+  FileSizeLimit(const FileSizeLimit&) = delete;
+  FileSizeLimit& operator=(const FileSizeLimit&) = delete;
+
+ public:
+  explicit FileSizeLimit(rlim_t Size) {
+    OldHandler = signal(SIGXFSZ, SIG_IGN);
+    getrlimit(RLIMIT_FSIZE, &OldLimit);
+    struct rlimit Limit = OldLimit;
+    Limit.rlim_cur = Size;
+    Installed = setrlimit(RLIMIT_FSIZE, &Limit) == 0;
+  }
+  ~FileSizeLimit() {
+    setrlimit(RLIMIT_FSIZE, &OldLimit);
+    signal(SIGXFSZ, OldHandler);
+  }
+  bool isInstalled() const { return Installed; }
+
+ private:
+  struct rlimit OldLimit;
+  void (*OldHandler)(int);
+  bool Installed;
+};
+
+std::vector<uint8_t> makeBytes(size_t Size) {
+  std::vector<uint8_t> Bytes(Size);
+  for (size_t i = 0; i < Size; ++i)
+    Bytes[i] = uint8_t((i * 7) ^ (i >> 12));
+  return Bytes;
+}
+
+// Writes Bytes to Filename through a WriteBackedQueue, a block at a time.
+// Returns true if the first page was created in mapped memory.
+bool writeFile(const char* Filename, const std::vector<uint8_t>& Bytes) {
+  auto Writer = std::make_shared<MappedFileWriter>(Filename);
+  EXPECT_TRUE(Writer->isMapping());
+  bool FirstPageMapped = Writer->allocatePage(0)->isMapped();
+  {
+    auto Que = std::make_shared<WriteBackedQueue>(Writer);
+    constexpr size_t BlockSize = 1 << 20;
+    AddressType Address = 0;
+    for (size_t i = 0; i < Bytes.size(); i += BlockSize) {
+      size_t Size = std::min(BlockSize, Bytes.size() - i);
+      EXPECT_TRUE(Que->write(Address, const_cast<uint8_t*>(&Bytes[i]), Size));
+    }
+    Que->freezeEof(Address);
+    EXPECT_TRUE(Que->isGood());
+  }
+  EXPECT_TRUE(Writer->freeze());
+  EXPECT_FALSE(Writer->hasErrors());
+  return FirstPageMapped;
+}
+
+std::vector<uint8_t> readFile(const char* Filename) {
+  std::vector<uint8_t> Bytes;
+  FILE* File = fopen(Filename, "rb");
+  if (File == nullptr)
+    return Bytes;
+  uint8_t Buffer[4096];
+  while (size_t Count = fread(Buffer, 1, sizeof(Buffer), File))
+    Bytes.insert(Bytes.end(), Buffer, Buffer + Count);
+  fclose(File);
+  return Bytes;
+}
+
+void expectSameBytes(const std::vector<uint8_t>& Expected,
+                     const std::vector<uint8_t>& Found) {
+  ASSERT_EQ(Expected.size(), Found.size());
+  auto Mismatch =
+      std::mismatch(Expected.begin(), Expected.end(), Found.begin());
+  EXPECT_TRUE(Mismatch.first == Expected.end())
+      << "at offset " << (Mismatch.first - Expected.begin());
+}
+
+const size_t ChunkSize = MappedFileWriter::ChunkSize;
+
+TEST(MappedFileWriterTest, WritesSeveralChunks) {
+  TempFile File;
+  std::vector<uint8_t> Bytes = makeBytes(ChunkSize + 3 * PageSize + 5);
+  EXPECT_TRUE(writeFile(File.getName(), Bytes));
+  // Preallocated bytes past the end must have been removed.
+  expectSameBytes(Bytes, readFile(File.getName()));
+}
+
+TEST(MappedFileWriterTest, FallsBackWhenUnableToPreallocate) {
+  TempFile File;
+  std::vector<uint8_t> Bytes = makeBytes(5 * PageSize + 5);
+  {
+    // Preallocating the first chunk fails, so all pages are heap pages.
+    FileSizeLimit Limit(ChunkSize / 2);
+    ASSERT_TRUE(Limit.isInstalled());
+    EXPECT_FALSE(writeFile(File.getName(), Bytes));
+  }
+  expectSameBytes(Bytes, readFile(File.getName()));
+}
+
+TEST(MappedFileWriterTest, FallsBackAfterFirstChunk) {
+  TempFile File;
+  std::vector<uint8_t> Bytes = makeBytes(ChunkSize + 3 * PageSize + 5);
+  {
+    // Only preallocating the second chunk fails, so the file is written
+    // using mapped pages followed by heap pages.
+    FileSizeLimit Limit(ChunkSize + ChunkSize / 2);
+    ASSERT_TRUE(Limit.isInstalled());
+    EXPECT_TRUE(writeFile(File.getName(), Bytes));
+  }
+  expectSameBytes(Bytes, readFile(File.getName()));
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
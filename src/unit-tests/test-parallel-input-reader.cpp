@@ -0,0 +1,142 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on class ParallelInputReader.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "algorithms/casm0x0.h"
+#include "algorithms/wasm0xd.h"
+#include "casm/CasmReader.h"
+#include "intcomp/ParallelInputReader.h"
+#include "interp/ByteReader.h"
+#include "interp/IntWriter.h"
+#include "interp/Interpreter.h"
+#include "sexp/Ast.h"
+#include "stream/ArrayReader.h"
+#include "stream/ReadBackedQueue.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::decode;
+using namespace wasm::filt;
+using namespace wasm::intcomp;
+using namespace wasm::interp;
+
+constexpr const char* InputFilename = "test/test-sources/0xD/br_table.wasm";
+constexpr const char* AlgorithmFilename = "src/algorithms/wasm0xd.cast";
+
+std::vector<uint8_t> readFile(const char* Filename) {
+  std::vector<uint8_t> Bytes;
+  FILE* File = fopen(Filename, "rb");
+  if (File == nullptr)
+    return Bytes;
+  int Ch;
+  while ((Ch = fgetc(File)) != EOF)
+    Bytes.push_back(uint8_t(Ch));
+  fclose(File);
+  return Bytes;
+}
+
+// Returns the description of Contents, so that streams can be compared.
+std::string describe(IntStream& Contents) {
+  char* Buffer = nullptr;
+  size_t Size = 0;
+  FILE* Out = open_memstream(&Buffer, &Size);
+  Contents.describe(Out);
+  fclose(Out);
+  std::string Description(Buffer, Size);
+  free(Buffer);
+  return Description;
+}
+
+std::string readSequentially(const std::vector<uint8_t>& Bytes) {
+  auto Contents = std::make_shared<IntStream>();
+  auto Input = std::make_shared<ReadBackedQueue>(
+      std::make_shared<ArrayReader>(Bytes.data(), Bytes.size()));
+  Interpreter MyReader(std::make_shared<ByteReader>(Input),
+                       std::make_shared<IntWriter>(Contents),
+                       InterpreterFlags(), getAlgwasm0xdSymtab());
+  MyReader.algorithmRead();
+  EXPECT_TRUE(MyReader.isFinished() && MyReader.isSuccessful());
+  return describe(*Contents);
+}
+
+TEST(ParallelInputReaderTest, MatchesSequentialRead) {
+  std::vector<uint8_t> Bytes = readFile(InputFilename);
+  ASSERT_FALSE(Bytes.empty()) << "Can't read " << InputFilename;
+  std::string Expected = readSequentially(Bytes);
+  for (size_t NumThreads : {1, 2, 4}) {
+    ParallelInputReader Reader(getAlgwasm0xdSymtab(), InterpreterFlags(),
+                               NumThreads);
+    ASSERT_TRUE(Reader.split(Bytes));
+    EXPECT_LT(0u, Reader.getNumFunctionBodies());
+    auto Contents = std::make_shared<IntStream>();
+    EXPECT_TRUE(Reader.read(Contents));
+    EXPECT_EQ(Expected, describe(*Contents)) << NumThreads << " threads";
+  }
+}
+
+TEST(ParallelInputReaderTest, InstallsDeferredDefines) {
+  std::vector<uint8_t> Bytes = readFile(InputFilename);
+  ASSERT_FALSE(Bytes.empty()) << "Can't read " << InputFilename;
+  std::string Expected = readSequentially(Bytes);
+  CasmReader AlgReader;
+  AlgReader.setInstall(false).readText(AlgorithmFilename);
+  std::shared_ptr<SymbolTable> Symtab = AlgReader.getReadSymtab();
+  ASSERT_TRUE(bool(Symtab)) << "Can't read " << AlgorithmFilename;
+  Symtab->setLazyInstall(true);
+  ASSERT_TRUE(Symtab->install());
+  ParallelInputReader Reader(Symtab, InterpreterFlags(), 4);
+  ASSERT_TRUE(Reader.split(Bytes));
+  for (const Node* Kid : *Symtab->getAlgorithm()) {
+    if (const auto* Def = dyn_cast<Define>(Kid)) {
+      EXPECT_FALSE(Def->needsInstall());
+    }
+  }
+  auto Contents = std::make_shared<IntStream>();
+  EXPECT_TRUE(Reader.read(Contents));
+  EXPECT_EQ(Expected, describe(*Contents));
+}
+
+TEST(ParallelInputReaderTest, RefusesOtherFormats) {
+  std::vector<uint8_t> Bytes = readFile(InputFilename);
+  ASSERT_FALSE(Bytes.empty()) << "Can't read " << InputFilename;
+  // The code section framing is only known for WASM 0xd algorithms.
+  ParallelInputReader CasmReader(getAlgcasm0x0Symtab(), InterpreterFlags(),
+                                 2);
+  EXPECT_FALSE(CasmReader.split(Bytes));
+  // Nor is it known for other versions of the input.
+  ParallelInputReader Reader(getAlgwasm0xdSymtab(), InterpreterFlags(), 2);
+  std::vector<uint8_t> Version1(Bytes);
+  Version1[4] = 1;
+  EXPECT_FALSE(Reader.split(Version1));
+  std::vector<uint8_t> Truncated(Bytes.begin(), Bytes.begin() + 6);
+  EXPECT_FALSE(Reader.split(Truncated));
+  EXPECT_TRUE(Reader.split(Bytes));
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,158 @@
+// -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs some basic tests on the paging of class Queue.
+
+// Note: Requires gtest from https://github.com/google/googletest
+
+#include "gtest/gtest.h"
+#include "stream/Page.h"
+#include "stream/Queue.h"
+#include "stream/ReadCursor.h"
+#include "stream/WriteCursor.h"
+
+#include <vector>
+
+namespace {
+
+using namespace wasm;
+using namespace wasm::decode;
+
+// Queue that counts the pages it creates and dumps, and exposes its page
+// map window.
+class CountingQueue : public Queue {
+  CountingQueue(const CountingQueue&) = delete;
+  CountingQueue& operator=(const CountingQueue&) = delete;
+
+ public:
+  CountingQueue() : NumPages(0), NumDumped(0) {}
+  ~CountingQueue() OVERRIDE {}
+  size_t getNumPages() const { return NumPages; }
+  size_t getNumDumped() const { return NumDumped; }
+  AddressType getPageMapBase() const { return PageMapBase; }
+  AddressType getPageMapSize() const { return PageMap.size(); }
+
+ protected:
+  size_t NumPages;
+  size_t NumDumped;
+
+  std::shared_ptr<Page> createPage(AddressType PageIndex) OVERRIDE {
+    ++NumPages;
+    return Queue::createPage(PageIndex);
+  }
+
+  void dumpFirstPage() OVERRIDE {
+    ++NumDumped;
+    Queue::dumpFirstPage();
+  }
+};
+
+constexpr AddressType NumTestPages = 3;
+
+void writePages(WriteCursor& Writer) {
+  for (AddressType i = 0; i < NumTestPages * PageSize; ++i)
+    Writer.writeByte(uint8_t(i));
+}
+
+TEST(QueueTest, CursorsDontAllocatePages) {
+  auto Que = std::make_shared<CountingQueue>();
+  ReadCursor Reader(Que);
+  WriteCursor Writer(Que);
+  ReadCursor Copy(Reader);
+  EXPECT_EQ(size_t(0), Que->getNumPages());
+  Writer.writeByte(1);
+  EXPECT_LT(size_t(0), Que->getNumPages());
+  EXPECT_EQ(1, Reader.readByte());
+}
+
+TEST(QueueTest, EarlyReaderKeepsFirstPage) {
+  auto Que = std::make_shared<Queue>();
+  ReadCursor Reader(Que);
+  {
+    WriteCursor Writer(Que);
+    writePages(Writer);
+  }
+  EXPECT_EQ(NumTestPages * PageSize, Que->actualSize());
+  for (AddressType i = 0; i < NumTestPages * PageSize; ++i)
+    ASSERT_EQ(uint8_t(i), Reader.readByte()) << "at address " << i;
+  EXPECT_TRUE(Que->isGood());
+}
+
+TEST(QueueTest, PageMapWindowSlides) {
+  auto Que = std::make_shared<CountingQueue>();
+  ReadCursor Reader(Que);
+  WriteCursor Writer(Que);
+  writePages(Writer);
+  // Reader was created before any writes, so keeps the first page.
+  EXPECT_EQ(size_t(0), Que->getNumDumped());
+  EXPECT_EQ(AddressType(0), Que->getPageMapBase());
+  AddressType LastAddress = (NumTestPages - 1) * PageSize;
+  for (AddressType i = 0; i <= LastAddress; ++i)
+    ASSERT_EQ(uint8_t(i), Reader.readByte()) << "at address " << i;
+  EXPECT_EQ(size_t(NumTestPages - 1), Que->getNumDumped());
+  EXPECT_EQ(NumTestPages - 1, Que->getPageMapBase());
+  EXPECT_LE(AddressType(1), Que->getPageMapSize());
+  // Lookups must use the slid window.
+  AddressType Address = LastAddress;
+  uint8_t Byte = 0;
+  EXPECT_EQ(AddressType(1), Que->read(Address, &Byte));
+  EXPECT_EQ(uint8_t(LastAddress), Byte);
+  EXPECT_TRUE(Que->isGood());
+  Address = 0;
+  EXPECT_EQ(AddressType(0), Que->read(Address, &Byte));
+  EXPECT_FALSE(Que->isGood());
+}
+
+TEST(QueueTest, DumpedPagesNotFound) {
+  auto Que = std::make_shared<Queue>();
+  WriteCursor Writer(Que);
+  writePages(Writer);
+  // Only the page being written remains.
+  EXPECT_GE(PageSize, Que->actualSize());
+  AddressType Address = Que->fillSize() - 1;
+  uint8_t Byte = 0;
+  EXPECT_EQ(AddressType(1), Que->read(Address, &Byte));
+  EXPECT_EQ(uint8_t(NumTestPages * PageSize - 1), Byte);
+  EXPECT_TRUE(Que->isGood());
+  Address = 0;
+  EXPECT_EQ(AddressType(0), Que->read(Address, &Byte));
+  EXPECT_FALSE(Que->isGood());
+}
+
+TEST(QueueTest, ReadWriteAcrossPages) {
+  auto Que = std::make_shared<Queue>();
+  // Keeps written pages from being dumped.
+  ReadCursor Reader(Que);
+  std::vector<uint8_t> Input(2 * PageSize + 3);
+  for (size_t i = 0; i < Input.size(); ++i)
+    Input[i] = uint8_t(i * 7);
+  AddressType Address = PageSize - 1;
+  EXPECT_TRUE(Que->write(Address, Input.data(), Input.size()));
+  EXPECT_EQ(PageSize - 1 + Input.size(), Address);
+  std::vector<uint8_t> Output(Input.size());
+  Address = PageSize - 1;
+  EXPECT_EQ(AddressType(Input.size()),
+            Que->read(Address, Output.data(), Output.size()));
+  for (size_t i = 0; i < Input.size(); ++i)
+    ASSERT_EQ(Input[i], Output[i]) << "at index " << i;
+}
+
+}  // end of anonymous namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,87 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements an adaptive Huffman model.
+
+#include "utils/AdaptiveHuffman.h"
+
+#include <algorithm>
+
+namespace wasm {
+
+using namespace decode;
+
+namespace utils {
+
+constexpr size_t AdaptiveHuffman::MaxNumSymbols;
+constexpr uint32_t AdaptiveHuffman::SymbolFlag;
+constexpr size_t AdaptiveHuffman::InitialRebuildInterval;
+constexpr size_t AdaptiveHuffman::MinMaxRebuildInterval;
+
+AdaptiveHuffman::AdaptiveHuffman(size_t NumSymbols)
+    : Weights(NumSymbols, 1),
+      Paths(NumSymbols, 0),
+      NumBits(NumSymbols, 0),
+      Root(SymbolFlag),
+      RebuildInterval(InitialRebuildInterval),
+      // Bound the amortized cost of rebuilding (proportional to the
+      // alphabet size) per symbol coded.
+      MaxRebuildInterval(
+          std::max(MinMaxRebuildInterval, 16 * NumSymbols)),
+      UpdatesLeft(InitialRebuildInterval) {
+  if (NumSymbols == 0 || NumSymbols > MaxNumSymbols)
+    fatal("Adaptive Huffman alphabet size not supported");
+  rebuild();
+}
+
+AdaptiveHuffman::~AdaptiveHuffman() {}
+
+void AdaptiveHuffman::update(size_t Symbol) {
+  ++Weights[Symbol];
+  if (--UpdatesLeft > 0)
+    return;
+  rebuild();
+  RebuildInterval = std::min(2 * RebuildInterval, MaxRebuildInterval);
+  UpdatesLeft = RebuildInterval;
+}
+
+void AdaptiveHuffman::rebuild() {
+  HuffmanEncoder Encoder;
+  for (WeightType Weight : Weights)
+    Encoder.createSymbol(Weight);
+  Decode.clear();
+  Root = install(Encoder.encodeSymbols());
+}
+
+uint32_t AdaptiveHuffman::install(HuffmanEncoder::NodePtr Nd) {
+  if (auto* Sym = dyn_cast<HuffmanEncoder::Symbol>(Nd.get())) {
+    Paths[Sym->getId()] = Sym->getPath();
+    NumBits[Sym->getId()] = Sym->getNumBits();
+    return uint32_t(Sym->getId()) | SymbolFlag;
+  }
+  auto* Sel = cast<HuffmanEncoder::Selector>(Nd.get());
+  size_t Index = Decode.size() / 2;
+  Decode.resize(Decode.size() + 2);
+  uint32_t Kid1 = install(Sel->getKid1());
+  uint32_t Kid2 = install(Sel->getKid2());
+  Decode[2 * Index] = Kid1;
+  Decode[2 * Index + 1] = Kid2;
+  return uint32_t(Index);
+}
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
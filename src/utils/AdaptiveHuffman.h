@@ -0,0 +1,97 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines an adaptive Huffman model for the alphabet [0, NumSymbols).
+//
+// The reader and the writer each own a model, and call update() with every
+// symbol they decode/encode. Since both sides see the same sequence of
+// symbols, they build the same codes, and hence no code table needs to be
+// written to the output.
+//
+// Rather than adjusting the code after every symbol, the code is rebuilt
+// (using HuffmanEncoder) at exponentially growing intervals. This keeps
+// the cost of adapting (amortized) small relative to coding symbols.
+
+#ifndef DECOMPRESSOR_SRC_UTILS_ADAPTIVEHUFFMAN_H
+#define DECOMPRESSOR_SRC_UTILS_ADAPTIVEHUFFMAN_H
+
+#include "utils/HuffmanEncoding.h"
+
+#include <vector>
+
+namespace wasm {
+
+namespace utils {
+
+class AdaptiveHuffman {
+  AdaptiveHuffman() = delete;
+  AdaptiveHuffman(const AdaptiveHuffman&) = delete;
+  AdaptiveHuffman& operator=(const AdaptiveHuffman&) = delete;
+
+ public:
+  typedef HuffmanEncoder::PathType PathType;
+  typedef HuffmanEncoder::WeightType WeightType;
+
+  // Largest alphabet size supported.
+  static constexpr size_t MaxNumSymbols = size_t(1) << 24;
+
+  explicit AdaptiveHuffman(size_t NumSymbols);
+  ~AdaptiveHuffman();
+
+  size_t getNumSymbols() const { return Weights.size(); }
+
+  // Returns the current encoding of Symbol. The first bit of the encoding
+  // is the least significant bit of the path.
+  PathType getPath(size_t Symbol) const { return Paths[Symbol]; }
+  unsigned getNumBits(size_t Symbol) const { return NumBits[Symbol]; }
+
+  // Decodes a symbol, using Source.readBit() to read the bits of the
+  // encoding.
+  template <class BitSource>
+  size_t decode(BitSource& Source) const {
+    uint32_t Entry = Root;
+    while (!(Entry & SymbolFlag))
+      Entry = Decode[2 * Entry + Source.readBit()];
+    return Entry & ~SymbolFlag;
+  }
+
+  // Records that Symbol was coded.
+  void update(size_t Symbol);
+
+ private:
+  static constexpr uint32_t SymbolFlag = uint32_t(1) << 31;
+  static constexpr size_t InitialRebuildInterval = 16;
+  static constexpr size_t MinMaxRebuildInterval = 1024;
+  std::vector<WeightType> Weights;
+  std::vector<PathType> Paths;
+  std::vector<unsigned> NumBits;
+  // Flattened decoding tree. Entries 2*i and 2*i+1 define the kids (for
+  // bit 0 and 1) of selector i. Entries with SymbolFlag set are leaves.
+  std::vector<uint32_t> Decode;
+  uint32_t Root;
+  size_t RebuildInterval;
+  size_t MaxRebuildInterval;
+  size_t UpdatesLeft;
+
+  void rebuild();
+  uint32_t install(HuffmanEncoder::NodePtr Nd);
+};
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_UTILS_ADAPTIVEHUFFMAN_H
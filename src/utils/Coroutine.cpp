@@ -0,0 +1,83 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a (stackful) coroutine.
+
+#include "utils/Coroutine.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace wasm {
+
+using namespace decode;
+
+namespace utils {
+
+constexpr size_t Coroutine::DefaultStackSize;
+
+Coroutine::Coroutine(std::function<void()> Body, size_t StackSize)
+    : Body(std::move(Body)),
+      StackSize(StackSize),
+      Stack(nullptr),
+      Started(false),
+      Done(false) {
+  size_t PageSize = size_t(sysconf(_SC_PAGESIZE));
+  this->StackSize = (StackSize + 2 * PageSize - 1) & ~(PageSize - 1);
+  Stack = mmap(nullptr, this->StackSize, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (Stack == MAP_FAILED)
+    fatal("Unable to allocate coroutine stack");
+  if (mprotect(Stack, PageSize, PROT_NONE) != 0)
+    fatal("Unable to protect coroutine stack");
+}
+
+Coroutine::~Coroutine() {
+  munmap(Stack, StackSize);
+}
+
+void Coroutine::run(uint32_t High, uint32_t Low) {
+  auto* Co = reinterpret_cast<Coroutine*>((uintptr_t(High) << 32) |
+                                          uintptr_t(Low));
+  Co->Body();
+  Co->Done = true;
+  swapcontext(&Co->BodyContext, &Co->CallerContext);
+}
+
+void Coroutine::resume() {
+  if (Done)
+    return;
+  if (!Started) {
+    Started = true;
+    if (getcontext(&BodyContext) != 0)
+      fatal("Unable to create coroutine context");
+    BodyContext.uc_stack.ss_sp = Stack;
+    BodyContext.uc_stack.ss_size = StackSize;
+    BodyContext.uc_link = nullptr;
+    uintptr_t Self = reinterpret_cast<uintptr_t>(this);
+    makecontext(&BodyContext, reinterpret_cast<void (*)()>(run), 2,
+                uint32_t(uint64_t(Self) >> 32), uint32_t(Self));
+  }
+  swapcontext(&CallerContext, &BodyContext);
+}
+
+void Coroutine::yield() {
+  swapcontext(&BodyContext, &CallerContext);
+}
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
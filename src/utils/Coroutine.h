@@ -0,0 +1,75 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a (stackful) coroutine. The body runs on its own stack, and can
+// suspend itself (via yield()) from any call depth. The next call to
+// resume() continues the body where it yielded.
+//
+// Note: The stack is reserved (not committed) memory, so large stacks only
+// cost the pages actually touched. The lowest page is a guard page.
+
+#ifndef DECOMPRESSOR_SRC_UTILS_COROUTINE_H
+#define DECOMPRESSOR_SRC_UTILS_COROUTINE_H
+
+#include "utils/Defs.h"
+
+#include <functional>
+
+#include <ucontext.h>
+
+namespace wasm {
+
+namespace utils {
+
+class Coroutine {
+  Coroutine() = delete;
+  Coroutine(const Coroutine&) = delete;
+  Coroutine& operator=(const Coroutine&) = delete;
+
+ public:
+  static constexpr size_t DefaultStackSize = size_t(8) << 20;
+
+  explicit Coroutine(std::function<void()> Body,
+                     size_t StackSize = DefaultStackSize);
+  ~Coroutine();
+
+  // Runs the body until it either yields or returns. Does nothing if the
+  // body has already returned.
+  void resume();
+
+  // Suspends the body, returning control to the caller of resume(). Must
+  // only be called from within the body.
+  void yield();
+
+  bool isDone() const { return Done; }
+
+ private:
+  std::function<void()> Body;
+  size_t StackSize;
+  void* Stack;
+  ucontext_t CallerContext;
+  ucontext_t BodyContext;
+  bool Started;
+  bool Done;
+
+  static void run(uint32_t High, uint32_t Low);
+};
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_UTILS_COROUTINE_H
@@ -0,0 +1,140 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements CRC32C (Castagnoli) checksums.
+
+#include "utils/Crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_X86 1
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define CRC32C_ARM 1
+#include <arm_acle.h>
+#endif
+
+namespace wasm {
+
+namespace utils {
+
+namespace {
+
+// Reflected polynomial of CRC32C.
+constexpr uint32_t Polynomial = 0x82f63b78;
+
+// Tables for slicing-by-8: Table[k][b] is the checksum of byte b followed
+// by k zero bytes.
+struct Crc32cTables {
+  uint32_t Table[8][256];
+  Crc32cTables() {
+    for (uint32_t b = 0; b < 256; ++b) {
+      uint32_t Crc = b;
+      for (int i = 0; i < 8; ++i)
+        Crc = (Crc >> 1) ^ ((Crc & 1) ? Polynomial : 0);
+      Table[0][b] = Crc;
+    }
+    for (uint32_t b = 0; b < 256; ++b)
+      for (int k = 1; k < 8; ++k)
+        Table[k][b] =
+            (Table[k - 1][b] >> 8) ^ Table[0][Table[k - 1][b] & 0xff];
+  }
+};
+
+uint32_t crc32cPortable(const uint8_t* Buffer, size_t Size, uint32_t Crc) {
+  static const Crc32cTables Tables;
+  const auto& T = Tables.Table;
+  for (; Size >= 8; Buffer += 8, Size -= 8) {
+    // Note: Little endian load of the next 8 bytes, combined with Crc.
+    uint32_t Lo = Crc ^ (uint32_t(Buffer[0]) | (uint32_t(Buffer[1]) << 8) |
+                         (uint32_t(Buffer[2]) << 16) |
+                         (uint32_t(Buffer[3]) << 24));
+    Crc = T[7][Lo & 0xff] ^ T[6][(Lo >> 8) & 0xff] ^ T[5][(Lo >> 16) & 0xff] ^
+          T[4][Lo >> 24] ^ T[3][Buffer[4]] ^ T[2][Buffer[5]] ^
+          T[1][Buffer[6]] ^ T[0][Buffer[7]];
+  }
+  for (; Size > 0; ++Buffer, --Size)
+    Crc = (Crc >> 8) ^ T[0][(Crc ^ *Buffer) & 0xff];
+  return Crc;
+}
+
+#if defined(CRC32C_X86)
+
+__attribute__((target("sse4.2"))) uint32_t
+crc32cHardware(const uint8_t* Buffer, size_t Size, uint32_t Crc) {
+  uint64_t Crc64 = Crc;
+  for (; Size >= 8; Buffer += 8, Size -= 8) {
+    uint64_t Word;
+    memcpy(&Word, Buffer, sizeof(Word));
+    Crc64 = _mm_crc32_u64(Crc64, Word);
+  }
+  uint32_t Crc32 = uint32_t(Crc64);
+  for (; Size > 0; ++Buffer, --Size)
+    Crc32 = _mm_crc32_u8(Crc32, *Buffer);
+  return Crc32;
+}
+
+bool checkHardware() {
+  return __builtin_cpu_supports("sse4.2");
+}
+
+#elif defined(CRC32C_ARM)
+
+uint32_t crc32cHardware(const uint8_t* Buffer, size_t Size, uint32_t Crc) {
+  for (; Size >= 8; Buffer += 8, Size -= 8) {
+    uint64_t Word;
+    memcpy(&Word, Buffer, sizeof(Word));
+    Crc = __crc32cd(Crc, Word);
+  }
+  for (; Size > 0; ++Buffer, --Size)
+    Crc = __crc32cb(Crc, *Buffer);
+  return Crc;
+}
+
+bool checkHardware() {
+  return true;
+}
+
+#else
+
+uint32_t crc32cHardware(const uint8_t* Buffer, size_t Size, uint32_t Crc) {
+  return crc32cPortable(Buffer, Size, Crc);
+}
+
+bool checkHardware() {
+  return false;
+}
+
+#endif
+
+}  // end of anonymous namespace
+
+bool hasHardwareCrc32c() {
+  static const bool HasHardware = checkHardware();
+  return HasHardware;
+}
+
+uint32_t crc32c(const uint8_t* Buffer, size_t Size, uint32_t Crc) {
+  Crc = ~Crc;
+  Crc = hasHardwareCrc32c() ? crc32cHardware(Buffer, Size, Crc)
+                            : crc32cPortable(Buffer, Size, Crc);
+  return ~Crc;
+}
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
@@ -0,0 +1,41 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines CRC32C (Castagnoli) checksums. Uses the CRC instructions of
+// SSE4.2 (checked at runtime) or ARMv8 (when compiled for), and a portable
+// table driven implementation otherwise.
+
+#ifndef DECOMPRESSOR_SRC_UTILS_CRC32C_H
+#define DECOMPRESSOR_SRC_UTILS_CRC32C_H
+
+#include "utils/Defs.h"
+
+namespace wasm {
+
+namespace utils {
+
+// Returns the checksum of the Size bytes in Buffer, continuing the checksum
+// Crc of the bytes preceding Buffer (0 if none).
+uint32_t crc32c(const uint8_t* Buffer, size_t Size, uint32_t Crc = 0);
+
+// Returns true if crc32c() uses hardware instructions.
+bool hasHardwareCrc32c();
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_UTILS_CRC32C_H
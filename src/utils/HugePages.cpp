@@ -0,0 +1,288 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Implements an (opt-in) allocator backed by huge pages.
+
+#include "utils/HugePages.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace wasm {
+
+namespace alloc {
+
+namespace {
+
+// Size classes are multiples of SmallClassSize up to MaxSmallSize. Above
+// that, each power of two is split into NumStepClasses steps, up to
+// MaxArenaSize. Larger allocations are mapped directly.
+//
+// Note: The steps keep objects just above a power of two (such as queue pages)
+// from using twice their size.
+constexpr size_t SmallClassSize = 16;
+constexpr size_t MaxSmallSize = 256;
+constexpr size_t NumSmallClasses = MaxSmallSize / SmallClassSize;
+constexpr size_t MaxArenaSizeLog2 = 18;
+constexpr size_t MaxArenaSize = size_t(1) << MaxArenaSizeLog2;
+constexpr size_t MinLargeSizeLog2 = 9;
+constexpr size_t NumStepClassesLog2 = 3;
+constexpr size_t NumStepClasses = size_t(1) << NumStepClassesLog2;
+constexpr size_t NumClasses =
+    NumSmallClasses +
+    (MaxArenaSizeLog2 - MinLargeSizeLog2 + 1) * NumStepClasses;
+
+size_t getClassIndex(size_t Size) {
+  if (Size <= MaxSmallSize)
+    return Size == 0 ? 0 : (Size - 1) / SmallClassSize;
+  size_t Log2 = MinLargeSizeLog2;
+  while ((size_t(1) << Log2) < Size)
+    ++Log2;
+  size_t Base = size_t(1) << (Log2 - 1);
+  size_t Step = Base >> NumStepClassesLog2;
+  size_t NumSteps = (Size - Base + Step - 1) / Step;
+  return NumSmallClasses + (Log2 - MinLargeSizeLog2) * NumStepClasses +
+         NumSteps - 1;
+}
+
+size_t getClassSize(size_t Index) {
+  if (Index < NumSmallClasses)
+    return (Index + 1) * SmallClassSize;
+  Index -= NumSmallClasses;
+  size_t Base = size_t(1)
+                << (Index / NumStepClasses + MinLargeSizeLog2 - 1);
+  size_t Step = Base >> NumStepClassesLog2;
+  return Base + (Index % NumStepClasses + 1) * Step;
+}
+
+size_t roundToRegions(size_t Size) {
+  return (Size + HugePages::RegionSize - 1) & ~(HugePages::RegionSize - 1);
+}
+
+struct FreeBlock {
+  FreeBlock* Next;
+};
+
+class HugePageState {
+  HugePageState(const HugePageState&) = delete;
+  HugePageState& operator=(const HugePageState&) = delete;
+
+ public:
+  HugePageState()
+      : Enabled(false),
+        HasMappings(false),
+        TryHugeTlb(true),
+        Available(nullptr),
+        End(nullptr),
+        NumRegions(0),
+        NumHugeTlbRegions(0),
+        BytesMapped(0) {
+    for (size_t i = 0; i < NumClasses; ++i)
+      FreeLists[i] = nullptr;
+  }
+
+  std::atomic<bool> Enabled;
+  // True once memory has been mapped (and hence released memory must be
+  // checked for ownership).
+  std::atomic<bool> HasMappings;
+
+  void* allocate(size_t Size);
+  void deallocate(void* Pointer, size_t Size);
+  void describe(FILE* File);
+
+ private:
+  std::mutex Lock;
+  bool TryHugeTlb;
+  FreeBlock* FreeLists[NumClasses];
+  // Remaining space of the current region.
+  uint8_t* Available;
+  uint8_t* End;
+  // Base addresses of regions used for size classes.
+  std::unordered_set<uintptr_t> Regions;
+  // Base addresses (and sizes) of directly mapped allocations.
+  std::unordered_map<uintptr_t, size_t> Mappings;
+  size_t NumRegions;
+  size_t NumHugeTlbRegions;
+  size_t BytesMapped;
+
+  void* map(size_t Size);
+  bool newRegion();
+};
+
+HugePageState& getState() {
+  // Note: Never deleted, since memory may be released during exit.
+  static HugePageState* State = new HugePageState();
+  return *State;
+}
+
+void* HugePageState::map(size_t Size) {
+#if defined(__linux__)
+#if defined(MAP_HUGETLB)
+  if (TryHugeTlb) {
+    void* Base = mmap(nullptr, Size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (Base != MAP_FAILED) {
+      ++NumHugeTlbRegions;
+      BytesMapped += Size;
+      HasMappings = true;
+      return Base;
+    }
+    // No (more) huge pages reserved, so use transparent huge pages.
+    TryHugeTlb = false;
+  }
+#endif
+  // Over-allocate, so that the mapping can be aligned on a huge page.
+  size_t Padded = Size + HugePages::RegionSize;
+  void* Mapped = mmap(nullptr, Padded, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (Mapped == MAP_FAILED)
+    return nullptr;
+  uint8_t* Start = static_cast<uint8_t*>(Mapped);
+  uint8_t* Base = reinterpret_cast<uint8_t*>(roundToRegions(uintptr_t(Start)));
+  if (Base > Start)
+    munmap(Start, Base - Start);
+  if (Base + Size < Start + Padded)
+    munmap(Base + Size, (Start + Padded) - (Base + Size));
+#if defined(MADV_HUGEPAGE)
+  madvise(Base, Size, MADV_HUGEPAGE);
+#endif
+  BytesMapped += Size;
+  HasMappings = true;
+  return Base;
+#else
+  (void)Size;
+  return nullptr;
+#endif
+}
+
+bool HugePageState::newRegion() {
+  void* Base = map(HugePages::RegionSize);
+  if (Base == nullptr)
+    return false;
+  ++NumRegions;
+  Regions.insert(uintptr_t(Base));
+  Available = static_cast<uint8_t*>(Base);
+  End = Available + HugePages::RegionSize;
+  return true;
+}
+
+void* HugePageState::allocate(size_t Size) {
+  if (Size > MaxArenaSize) {
+    size_t MapSize = roundToRegions(Size);
+    std::lock_guard<std::mutex> Guard(Lock);
+    if (void* Base = map(MapSize)) {
+      Mappings[uintptr_t(Base)] = MapSize;
+      return Base;
+    }
+    return ::operator new(Size);
+  }
+  size_t Index = getClassIndex(Size);
+  std::lock_guard<std::mutex> Guard(Lock);
+  if (FreeBlock* Block = FreeLists[Index]) {
+    FreeLists[Index] = Block->Next;
+    return Block;
+  }
+  size_t ClassSize = getClassSize(Index);
+  if (size_t(End - Available) < ClassSize && !newRegion())
+    return ::operator new(Size);
+  void* Block = Available;
+  Available += ClassSize;
+  return Block;
+}
+
+void HugePageState::deallocate(void* Pointer, size_t Size) {
+  uintptr_t Address = uintptr_t(Pointer);
+  std::lock_guard<std::mutex> Guard(Lock);
+  if (Size <= MaxArenaSize) {
+    if (Regions.count(Address & ~(HugePages::RegionSize - 1))) {
+      FreeBlock* Block = static_cast<FreeBlock*>(Pointer);
+      size_t Index = getClassIndex(Size);
+      Block->Next = FreeLists[Index];
+      FreeLists[Index] = Block;
+      return;
+    }
+  } else {
+    auto Iter = Mappings.find(Address);
+    if (Iter != Mappings.end()) {
+#if defined(__linux__)
+      munmap(Pointer, Iter->second);
+#endif
+      BytesMapped -= Iter->second;
+      Mappings.erase(Iter);
+      return;
+    }
+  }
+  ::operator delete(Pointer);
+}
+
+void HugePageState::describe(FILE* File) {
+  std::lock_guard<std::mutex> Guard(Lock);
+  fprintf(File,
+          "Huge pages: %" PRIuMAX " regions (%" PRIuMAX " MAP_HUGETLB), %" PRIuMAX
+          " direct mappings, %" PRIuMAX " bytes mapped\n",
+          uintmax_t(NumRegions), uintmax_t(NumHugeTlbRegions),
+          uintmax_t(Mappings.size()), uintmax_t(BytesMapped));
+}
+
+}  // end of anonymous namespace
+
+constexpr size_t HugePages::RegionSize;
+
+bool HugePages::setEnabled(bool NewValue) {
+#if defined(__linux__)
+  getState().Enabled = NewValue;
+  return true;
+#else
+  return !NewValue;
+#endif
+}
+
+bool HugePages::isEnabled() {
+  return getState().Enabled;
+}
+
+void* HugePages::allocate(size_t Size) {
+  HugePageState& State = getState();
+  if (!State.Enabled)
+    return ::operator new(Size);
+  return State.allocate(Size);
+}
+
+void HugePages::deallocate(void* Pointer, size_t Size) {
+  if (Pointer == nullptr)
+    return;
+  HugePageState& State = getState();
+  if (!State.HasMappings)
+    return ::operator delete(Pointer);
+  State.deallocate(Pointer, Size);
+}
+
+void HugePages::describe(FILE* File) {
+  getState().describe(File);
+}
+
+}  // end of namespace alloc
+
+}  // end of namespace wasm
@@ -0,0 +1,101 @@
+/* -*- C++ -*- */
+/*
+ * Copyright 2016 WebAssembly Community Group participants
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Defines an (opt-in) allocator that backs bulk data structures (queue
+// pages, count tries, integer streams) with huge pages, to cut down on TLB
+// misses.
+//
+// When enabled, small allocations are carved (by size class) out of 2MB
+// regions, and large allocations are mapped directly. Regions are mapped
+// using MAP_HUGETLB if huge pages are reserved, and otherwise aligned and
+// advised (MADV_HUGEPAGE) to use transparent huge pages. When not enabled
+// (or not supported), allocations use operator new.
+//
+// Note: Memory may be released after the allocator is disabled, and hence
+// ownership of released memory is decided by its address.
+
+#ifndef DECOMPRESSOR_SRC_UTILS_HUGEPAGES_H
+#define DECOMPRESSOR_SRC_UTILS_HUGEPAGES_H
+
+#include "utils/Defs.h"
+
+#include <cstdio>
+#include <limits>
+
+namespace wasm {
+
+namespace alloc {
+
+class HugePages {
+  HugePages() = delete;
+  HugePages(const HugePages&) = delete;
+  HugePages& operator=(const HugePages&) = delete;
+
+ public:
+  // Size (and alignment) of regions.
+  static constexpr size_t RegionSize = size_t(1) << 21;
+
+  // Turns on (or off) the use of huge pages for subsequent allocations.
+  // Returns false if huge pages aren't supported on this platform.
+  static bool setEnabled(bool NewValue);
+  static bool isEnabled();
+
+  static void* allocate(size_t Size);
+  static void deallocate(void* Pointer, size_t Size);
+
+  // Describes the memory mapped (so far) to File.
+  static void describe(FILE* File);
+};
+
+// Standard (container) allocator using HugePages.
+template <class T>
+struct HugePageAllocator {
+  typedef T value_type;
+
+  HugePageAllocator() {}
+  template <class U>
+  HugePageAllocator(const HugePageAllocator<U>&) {}
+  T* allocate(std::size_t Size) {
+    return static_cast<T*>(HugePages::allocate(sizeof(T) * Size));
+  }
+  void deallocate(T* Pointer, std::size_t Size) {
+    HugePages::deallocate(Pointer, sizeof(T) * Size);
+  }
+  size_t max_size() const {
+    return std::numeric_limits<size_t>::max() / sizeof(T);
+  }
+  template <typename Other>
+  struct rebind {
+    typedef HugePageAllocator<Other> other;
+  };
+};
+
+template <class T, class U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) {
+  return false;
+}
+
+}  // end of namespace alloc
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_UTILS_HUGEPAGES_H
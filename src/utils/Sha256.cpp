@@ -0,0 +1,160 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements SHA-256 (FIPS 180-4).
+
+#include "utils/Sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wasm {
+
+namespace utils {
+
+namespace {
+
+constexpr uint32_t RoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+constexpr uint32_t InitialState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                      0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                      0x1f83d9ab, 0x5be0cd19};
+
+inline uint32_t rotateRight(uint32_t Value, unsigned Count) {
+  return (Value >> Count) | (Value << (32 - Count));
+}
+
+}  // end of anonymous namespace
+
+constexpr size_t Sha256::DigestSize;
+
+Sha256::Sha256() : Length(0) {
+  memcpy(State, InitialState, sizeof(State));
+}
+
+void Sha256::compress(const uint8_t* Bytes) {
+  uint32_t W[64];
+  for (size_t i = 0; i < 16; ++i)
+    W[i] = (uint32_t(Bytes[4 * i]) << 24) | (uint32_t(Bytes[4 * i + 1]) << 16) |
+           (uint32_t(Bytes[4 * i + 2]) << 8) | uint32_t(Bytes[4 * i + 3]);
+  for (size_t i = 16; i < 64; ++i) {
+    uint32_t S0 = rotateRight(W[i - 15], 7) ^ rotateRight(W[i - 15], 18) ^
+                  (W[i - 15] >> 3);
+    uint32_t S1 = rotateRight(W[i - 2], 17) ^ rotateRight(W[i - 2], 19) ^
+                  (W[i - 2] >> 10);
+    W[i] = W[i - 16] + S0 + W[i - 7] + S1;
+  }
+  uint32_t A = State[0];
+  uint32_t B = State[1];
+  uint32_t C = State[2];
+  uint32_t D = State[3];
+  uint32_t E = State[4];
+  uint32_t F = State[5];
+  uint32_t G = State[6];
+  uint32_t H = State[7];
+  for (size_t i = 0; i < 64; ++i) {
+    uint32_t S1 = rotateRight(E, 6) ^ rotateRight(E, 11) ^ rotateRight(E, 25);
+    uint32_t Choose = (E & F) ^ (~E & G);
+    uint32_t Temp1 = H + S1 + Choose + RoundConstants[i] + W[i];
+    uint32_t S0 = rotateRight(A, 2) ^ rotateRight(A, 13) ^ rotateRight(A, 22);
+    uint32_t Majority = (A & B) ^ (A & C) ^ (B & C);
+    uint32_t Temp2 = S0 + Majority;
+    H = G;
+    G = F;
+    F = E;
+    E = D + Temp1;
+    D = C;
+    C = B;
+    B = A;
+    A = Temp1 + Temp2;
+  }
+  State[0] += A;
+  State[1] += B;
+  State[2] += C;
+  State[3] += D;
+  State[4] += E;
+  State[5] += F;
+  State[6] += G;
+  State[7] += H;
+}
+
+void Sha256::add(const uint8_t* Bytes, size_t Size) {
+  size_t Used = Length % sizeof(Block);
+  Length += Size;
+  if (Used != 0) {
+    size_t Count = std::min(Size, sizeof(Block) - Used);
+    memcpy(Block + Used, Bytes, Count);
+    Bytes += Count;
+    Size -= Count;
+    if (Used + Count < sizeof(Block))
+      return;
+    compress(Block);
+  }
+  for (; Size >= sizeof(Block); Bytes += sizeof(Block), Size -= sizeof(Block))
+    compress(Bytes);
+  memcpy(Block, Bytes, Size);
+}
+
+void Sha256::addValue(uint64_t Value) {
+  uint8_t Bytes[sizeof(Value)];
+  for (size_t i = 0; i < sizeof(Value); ++i) {
+    Bytes[i] = uint8_t(Value);
+    Value >>= 8;
+  }
+  add(Bytes, sizeof(Bytes));
+}
+
+void Sha256::addString(const std::string& Str) {
+  addValue(Str.size());
+  add(reinterpret_cast<const uint8_t*>(Str.data()), Str.size());
+}
+
+std::string Sha256::getHexDigest() const {
+  // Pad a copy, so that more bytes can still be added to this hash.
+  Sha256 Final(*this);
+  uint64_t BitLength = Length * 8;
+  uint8_t Padding[sizeof(Block) + 8];
+  size_t Used = Length % sizeof(Block);
+  size_t PadSize = (Used < 56 ? 56 : 120) - Used;
+  memset(Padding, 0, PadSize);
+  Padding[0] = 0x80;
+  for (size_t i = 0; i < 8; ++i)
+    Padding[PadSize + i] = uint8_t(BitLength >> (56 - 8 * i));
+  Final.add(Padding, PadSize + 8);
+  static constexpr char HexDigits[] = "0123456789abcdef";
+  std::string Digest;
+  Digest.reserve(2 * DigestSize);
+  for (uint32_t Word : Final.State) {
+    for (int Shift = 28; Shift >= 0; Shift -= 4)
+      Digest.push_back(HexDigits[(Word >> Shift) & 0xf]);
+  }
+  return Digest;
+}
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
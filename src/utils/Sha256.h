@@ -0,0 +1,64 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines an incremental SHA-256 hash.
+//
+// Note: Hashes are copyable, so that the hash of a common prefix can be
+// computed once, and then extended for each suffix.
+
+#ifndef DECOMPRESSOR_SRC_UTILS_SHA256_H
+#define DECOMPRESSOR_SRC_UTILS_SHA256_H
+
+#include "utils/Defs.h"
+
+#include <string>
+
+namespace wasm {
+
+namespace utils {
+
+class Sha256 {
+ public:
+  static constexpr size_t DigestSize = 32;
+
+  Sha256();
+
+  // Adds the Size bytes in Bytes to the hashed message.
+  void add(const uint8_t* Bytes, size_t Size);
+
+  // Adds Value (as 8 little endian bytes) to the hashed message.
+  void addValue(uint64_t Value);
+
+  // Adds the size, and then the contents, of Str to the hashed message.
+  void addString(const std::string& Str);
+
+  // Returns the digest of the message added so far, as lower case
+  // hexadecimal. Doesn't change the hash.
+  std::string getHexDigest() const;
+
+ private:
+  uint32_t State[8];
+  uint8_t Block[64];
+  // Number of bytes added so far.
+  uint64_t Length;
+  void compress(const uint8_t* Bytes);
+};
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_UTILS_SHA256_H
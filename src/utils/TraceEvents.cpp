@@ -0,0 +1,189 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Implements a recorder of Chrome trace-event timelines.
+
+#include "utils/TraceEvents.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace wasm {
+
+namespace utils {
+
+namespace {
+
+typedef std::chrono::steady_clock ClockType;
+
+struct Event {
+  char Phase;
+  charstring Category;
+  std::string Name;
+  uint64_t Micros;
+  uint32_t Thread;
+};
+
+struct Recorder {
+  std::mutex Mutex;
+  std::string Filename;
+  ClockType::time_point Start;
+  std::vector<Event> Events;
+  std::map<uint32_t, std::string> ThreadNames;
+  bool RegisteredAtExit = false;
+};
+
+Recorder& getRecorder() {
+  static Recorder* Rec = new Recorder();
+  return *Rec;
+}
+
+std::atomic<uint32_t> NextThread(1);
+thread_local uint32_t MyThread = 0;
+
+uint32_t getThread() {
+  if (MyThread == 0)
+    MyThread = NextThread.fetch_add(1);
+  return MyThread;
+}
+
+void writeString(FILE* Out, const std::string& Value) {
+  fputc('"', Out);
+  for (char Ch : Value) {
+    switch (Ch) {
+      case '"':
+      case '\\':
+        fputc('\\', Out);
+        fputc(Ch, Out);
+        break;
+      default:
+        if (uint8_t(Ch) < 0x20)
+          fprintf(Out, "\\u%04x", unsigned(uint8_t(Ch)));
+        else
+          fputc(Ch, Out);
+        break;
+    }
+  }
+  fputc('"', Out);
+}
+
+void stopAtExit() {
+  TraceEvents::stop();
+}
+
+}  // end of anonymous namespace
+
+std::atomic<bool> TraceEvents::Recording(false);
+
+bool TraceEvents::start(charstring Filename) {
+  Recorder& Rec = getRecorder();
+  std::lock_guard<std::mutex> Lock(Rec.Mutex);
+  if (isRecording())
+    return false;
+  Rec.Filename = Filename;
+  Rec.Start = ClockType::now();
+  Rec.Events.clear();
+  Rec.ThreadNames.clear();
+  Rec.ThreadNames[getThread()] = "main";
+  if (!Rec.RegisteredAtExit) {
+    Rec.RegisteredAtExit = true;
+    atexit(stopAtExit);
+  }
+  Recording = true;
+  return true;
+}
+
+void TraceEvents::setThreadName(charstring Name) {
+  if (!isRecording())
+    return;
+  Recorder& Rec = getRecorder();
+  std::lock_guard<std::mutex> Lock(Rec.Mutex);
+  Rec.ThreadNames[getThread()] = Name;
+}
+
+void TraceEvents::record(char Phase, charstring Category, charstring Name) {
+  Recorder& Rec = getRecorder();
+  ClockType::time_point Now = ClockType::now();
+  uint32_t Thread = getThread();
+  std::lock_guard<std::mutex> Lock(Rec.Mutex);
+  if (!isRecording())
+    return;
+  Rec.Events.emplace_back();
+  Event& E = Rec.Events.back();
+  E.Phase = Phase;
+  E.Category = Category;
+  if (Name != nullptr)
+    E.Name = Name;
+  E.Micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                 Now - Rec.Start).count();
+  E.Thread = Thread;
+}
+
+bool TraceEvents::stop() {
+  Recorder& Rec = getRecorder();
+  std::lock_guard<std::mutex> Lock(Rec.Mutex);
+  if (!isRecording())
+    return false;
+  Recording = false;
+  FILE* Out = fopen(Rec.Filename.c_str(), "w");
+  if (Out == nullptr) {
+    fprintf(stderr, "Unable to open: %s\n", Rec.Filename.c_str());
+    return false;
+  }
+  const unsigned long Pid = getpid();
+  fprintf(Out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  fprintf(Out,
+          "  {\"ph\": \"M\", \"pid\": %lu, \"tid\": 0, \"name\": "
+          "\"process_name\", \"args\": {\"name\": \"wasm-decompressor\"}}",
+          Pid);
+  for (const auto& Pair : Rec.ThreadNames) {
+    fprintf(Out,
+            ",\n  {\"ph\": \"M\", \"pid\": %lu, \"tid\": %u, \"name\": "
+            "\"thread_name\", \"args\": {\"name\": ",
+            Pid, unsigned(Pair.first));
+    writeString(Out, Pair.second);
+    fprintf(Out, "}}");
+  }
+  for (const Event& E : Rec.Events) {
+    fprintf(Out,
+            ",\n  {\"ph\": \"%c\", \"pid\": %lu, \"tid\": %u, \"ts\": %llu, "
+            "\"cat\": ",
+            E.Phase, Pid, unsigned(E.Thread), (unsigned long long)E.Micros);
+    writeString(Out, E.Category);
+    if (E.Phase == 'B') {
+      fprintf(Out, ", \"name\": ");
+      writeString(Out, E.Name);
+    }
+    fputc('}', Out);
+  }
+  fprintf(Out, "\n]}\n");
+  bool Success = !ferror(Out);
+  if (fclose(Out) != 0)
+    Success = false;
+  Rec.Events.clear();
+  Rec.ThreadNames.clear();
+  return Success;
+}
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
@@ -0,0 +1,107 @@
+/* -*- C++ -*- */
+//
+// Copyright 2016 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Defines a (process wide) recorder of timeline events, written out in the
+// Chrome trace-event JSON format. The resulting file can be loaded directly
+// into chrome://tracing or https://ui.perfetto.dev.
+//
+// Unlike TraceClass, which prints a line for each traced action, events are
+// buffered in memory (with microsecond timestamps) and written when
+// recording stops. Spans are recorded as begin/end pairs on the calling
+// thread, so nested spans show up as nested slices in the viewer.
+//
+// When not recording, begin() and end() (and hence TraceEventSpan) only
+// test a flag.
+
+#ifndef DECOMPRESSOR_SRC_UTILS_TRACEEVENTS_H
+#define DECOMPRESSOR_SRC_UTILS_TRACEEVENTS_H
+
+#include "utils/Defs.h"
+
+#include <atomic>
+#include <string>
+
+namespace wasm {
+
+namespace utils {
+
+class TraceEvents {
+  TraceEvents() = delete;
+  TraceEvents(const TraceEvents&) = delete;
+  TraceEvents& operator=(const TraceEvents&) = delete;
+
+ public:
+  // Starts recording events, to be written to Filename when recording
+  // stops (or the process exits). Returns false if already recording.
+  static bool start(charstring Filename);
+
+  // Stops recording and writes the recorded events. Returns false if not
+  // recording, or unable to write the file.
+  static bool stop();
+
+  static bool isRecording() {
+    return Recording.load(std::memory_order_relaxed);
+  }
+
+  // Names the calling thread in the timeline.
+  static void setThreadName(charstring Name);
+
+  // Opens (closes) a span on the calling thread.
+  static void begin(charstring Category, charstring Name) {
+    if (isRecording())
+      record('B', Category, Name);
+  }
+  static void begin(charstring Category, const std::string& Name) {
+    if (isRecording())
+      record('B', Category, Name.c_str());
+  }
+  static void end(charstring Category) {
+    if (isRecording())
+      record('E', Category, nullptr);
+  }
+
+ private:
+  static std::atomic<bool> Recording;
+  static void record(char Phase, charstring Category, charstring Name);
+};
+
+// Records a span covering the lifetime of the object.
+class TraceEventSpan {
+  TraceEventSpan() = delete;
+  TraceEventSpan(const TraceEventSpan&) = delete;
+  TraceEventSpan& operator=(const TraceEventSpan&) = delete;
+
+ public:
+  TraceEventSpan(charstring Category, charstring Name)
+      : Category(Category), IsOpen(TraceEvents::isRecording()) {
+    if (IsOpen)
+      TraceEvents::begin(Category, Name);
+  }
+  ~TraceEventSpan() {
+    if (IsOpen)
+      TraceEvents::end(Category);
+  }
+
+ private:
+  charstring Category;
+  bool IsOpen;
+};
+
+}  // end of namespace utils
+
+}  // end of namespace wasm
+
+#endif  // DECOMPRESSOR_SRC_UTILS_TRACEEVENTS_H